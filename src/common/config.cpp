@@ -197,6 +197,7 @@ static ConfigEntry<bool> pipelineCacheArchive(false);
 // Debug
 static ConfigEntry<bool> isDebugDump(false);
 static ConfigEntry<bool> isShaderDebug(false);
+static ConfigEntry<bool> isCpuDetilerValidation(false);
 static ConfigEntry<bool> isSeparateLogFilesEnabled(false);
 static ConfigEntry<bool> showFpsCounter(false);
 static ConfigEntry<bool> logEnabled(true);
@@ -404,6 +405,10 @@ bool collectShadersForDebug() {
     return isShaderDebug.get();
 }
 
+bool validateCpuDetiler() {
+    return isCpuDetilerValidation.get();
+}
+
 bool showSplash() {
     return isShowSplash.get();
 }
@@ -551,6 +556,10 @@ void setCollectShaderForDebug(bool enable, bool is_game_specific) {
     isShaderDebug.set(enable, is_game_specific);
 }
 
+void setValidateCpuDetiler(bool enable, bool is_game_specific) {
+    isCpuDetilerValidation.set(enable, is_game_specific);
+}
+
 void setShowSplash(bool enable, bool is_game_specific) {
     isShowSplash.set(enable, is_game_specific);
 }
@@ -955,6 +964,7 @@ void load(const std::filesystem::path& path, bool is_game_specific) {
         isDebugDump.setFromToml(debug, "DebugDump", is_game_specific);
         isSeparateLogFilesEnabled.setFromToml(debug, "isSeparateLogFilesEnabled", is_game_specific);
         isShaderDebug.setFromToml(debug, "CollectShader", is_game_specific);
+        isCpuDetilerValidation.setFromToml(debug, "ValidateCpuDetiler", is_game_specific);
         showFpsCounter.setFromToml(debug, "showFpsCounter", is_game_specific);
         logEnabled.setFromToml(debug, "logEnabled", is_game_specific);
         current_version = toml::find_or<std::string>(debug, "ConfigVersion", current_version);
@@ -1119,6 +1129,7 @@ void save(const std::filesystem::path& path, bool is_game_specific) {
 
     isDebugDump.setTomlValue(data, "Debug", "DebugDump", is_game_specific);
     isShaderDebug.setTomlValue(data, "Debug", "CollectShader", is_game_specific);
+    isCpuDetilerValidation.setTomlValue(data, "Debug", "ValidateCpuDetiler", is_game_specific);
     isSeparateLogFilesEnabled.setTomlValue(data, "Debug", "isSeparateLogFilesEnabled",
                                            is_game_specific);
     logEnabled.setTomlValue(data, "Debug", "logEnabled", is_game_specific);
@@ -1252,6 +1263,7 @@ void setDefaultValues(bool is_game_specific) {
     // GS - Debug
     isDebugDump.set(false, is_game_specific);
     isShaderDebug.set(false, is_game_specific);
+    isCpuDetilerValidation.set(false, is_game_specific);
     isSeparateLogFilesEnabled.set(false, is_game_specific);
     logEnabled.set(true, is_game_specific);
 
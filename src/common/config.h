@@ -55,6 +55,8 @@ bool allowHDR();
 void setAllowHDR(bool enable, bool is_game_specific = false);
 bool collectShadersForDebug();
 void setCollectShaderForDebug(bool enable, bool is_game_specific = false);
+bool validateCpuDetiler();
+void setValidateCpuDetiler(bool enable, bool is_game_specific = false);
 bool showSplash();
 void setShowSplash(bool enable, bool is_game_specific = false);
 std::string sideTrophy();
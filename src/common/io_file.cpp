@@ -1,6 +1,7 @@
 // SPDX-FileCopyrightText: Copyright 2021 yuzu Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
 #include <vector>
 
 #include "common/alignment.h"
@@ -290,6 +291,52 @@ std::string IOFile::ReadString(size_t length) const {
     return std::string{string_buffer.data(), string_size};
 }
 
+s64 IOFile::ReadAt(void* data, size_t size, u64 offset) const {
+    if (!IsOpen()) {
+        return -1;
+    }
+
+    auto* bytes = static_cast<u8*>(data);
+    size_t total_read = 0;
+#ifdef _WIN32
+    const auto handle = reinterpret_cast<HANDLE>(_get_osfhandle(_fileno(file)));
+    while (total_read < size) {
+        const u64 position = offset + total_read;
+        OVERLAPPED overlapped{};
+        overlapped.Offset = static_cast<DWORD>(position);
+        overlapped.OffsetHigh = static_cast<DWORD>(position >> 32);
+        const auto chunk_size = static_cast<DWORD>(std::min<size_t>(size - total_read, 1_GB));
+        DWORD bytes_read{};
+        if (!ReadFile(handle, bytes + total_read, chunk_size, &bytes_read, &overlapped)) {
+            if (GetLastError() == ERROR_HANDLE_EOF) {
+                break;
+            }
+            return -1;
+        }
+        if (bytes_read == 0) {
+            break;
+        }
+        total_read += bytes_read;
+    }
+#else
+    while (total_read < size) {
+        const ssize_t bytes_read =
+            pread(fileno(file), bytes + total_read, size - total_read, offset + total_read);
+        if (bytes_read < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        if (bytes_read == 0) {
+            break;
+        }
+        total_read += bytes_read;
+    }
+#endif
+    return static_cast<s64>(total_read);
+}
+
 bool IOFile::Flush() const {
     if (!IsOpen()) {
         return false;
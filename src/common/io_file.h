@@ -215,6 +215,11 @@ public:
 
     std::string ReadString(size_t length) const;
 
+    /// Reads at an offset without going through the stream, returns the bytes read or -1.
+    /// On POSIX hosts the stream position is left alone, so it can run alongside other reads.
+    /// On Windows it moves the position of the handle and callers must restore it with Seek.
+    s64 ReadAt(void* data, size_t size, u64 offset) const;
+
     size_t WriteString(std::span<const char> string) const {
         return WriteSpan(string);
     }
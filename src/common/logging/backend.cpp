@@ -2,9 +2,16 @@
 // SPDX-FileCopyrightText: Copyright 2026 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
 #include <chrono>
+#include <cstring>
 #include <filesystem>
+#include <limits>
+#include <mutex>
+#include <optional>
 #include <thread>
+#include <unordered_map>
+#include <vector>
 
 #include <fmt/format.h>
 
@@ -12,15 +19,18 @@
 #include <windows.h> // For OutputDebugStringW
 #endif
 
+#include "common/alignment.h"
 #include "common/bounded_threadsafe_queue.h"
 #include "common/config.h"
 #include "common/debug.h"
 #include "common/io_file.h"
 #include "common/logging/backend.h"
+#include "common/logging/binary_log.h"
 #include "common/logging/log.h"
 #include "common/logging/log_entry.h"
 #include "common/logging/text_formatter.h"
 #include "common/path_util.h"
+#include "common/polyfill_thread.h"
 #include "common/string_util.h"
 #include "common/thread.h"
 
@@ -53,6 +63,10 @@ public:
         enabled = enabled_;
     }
 
+    bool IsEnabled() const {
+        return enabled.load(std::memory_order_relaxed);
+    }
+
 private:
     std::atomic_bool enabled{true};
 };
@@ -98,6 +112,111 @@ private:
     std::size_t bytes_written = 0;
 };
 
+/**
+ * Backend that writes the records of the log rings to a compact binary file, without formatting
+ * their messages. Strings are written once and referenced by id.
+ */
+class BinaryFileBackend {
+public:
+    explicit BinaryFileBackend(const std::filesystem::path& filename, bool should_append = false)
+        : file{filename, should_append ? FS::FileAccessMode::Append : FS::FileAccessMode::Create} {
+        Append(BinaryLog::Magic.data(), BinaryLog::Magic.size());
+    }
+
+    ~BinaryFileBackend() = default;
+
+    void Write(const RecordHeader& record, const std::string& thread) {
+        if (!enabled) {
+            return;
+        }
+
+        const auto payload = record.Payload();
+        const BinaryLog::RecordChunk chunk{
+            .type = BinaryLog::ChunkType::Record,
+            .log_class = record.log_class,
+            .log_level = record.log_level,
+            .line_num = record.line_num,
+            .timestamp = record.timestamp,
+            .filename_id = GetStringId(record.filename),
+            .function_id = GetStringId(record.function),
+            .format_id = record.format ? GetStringId(record.format) : 0,
+            .thread_id = GetThreadId(thread),
+            .num_args = record.num_args,
+            .payload_size = record.payload_size,
+        };
+        Append(&chunk, sizeof(chunk));
+        Append(payload.data(), payload.size());
+
+        // Prevent logs from exceeding a set maximum size in the event that log entries are spammed.
+        const auto write_limit = 100_MB;
+        const bool write_limit_exceeded = bytes_written > write_limit;
+        if (record.log_level >= Level::Error || write_limit_exceeded) {
+            if (write_limit_exceeded) {
+                enabled = false;
+            }
+            Flush();
+        }
+    }
+
+    void Flush() {
+        if (!buffer.empty()) {
+            file.WriteSpan(std::span<const u8>{buffer});
+            buffer.clear();
+        }
+        file.Flush();
+    }
+
+private:
+    void Append(const void* data, size_t size) {
+        const auto* bytes = static_cast<const u8*>(data);
+        buffer.insert(buffer.end(), bytes, bytes + size);
+        bytes_written += size;
+        if (buffer.size() >= BufferSize) {
+            file.WriteSpan(std::span<const u8>{buffer});
+            buffer.clear();
+        }
+    }
+
+    u32 WriteString(std::string_view str) {
+        const u32 id = next_string_id++;
+        const BinaryLog::StringChunk chunk{
+            .type = BinaryLog::ChunkType::String,
+            .id = id,
+            .size = static_cast<u32>(str.size()),
+        };
+        Append(&chunk, sizeof(chunk));
+        Append(str.data(), str.size());
+        return id;
+    }
+
+    u32 GetStringId(const char* str) {
+        // Format strings, file and function names are literals, so their address identifies them.
+        const auto [it, is_new] = string_ids.try_emplace(str, 0);
+        if (is_new) {
+            it->second = WriteString(str);
+        }
+        return it->second;
+    }
+
+    u32 GetThreadId(const std::string& thread) {
+        const auto [it, is_new] = thread_ids.try_emplace(thread, 0);
+        if (is_new) {
+            it->second = WriteString(thread);
+        }
+        return it->second;
+    }
+
+    static constexpr size_t BufferSize = 64_KB;
+
+    Common::FS::IOFile file;
+    std::vector<u8> buffer;
+    std::unordered_map<const char*, u32> string_ids;
+    std::unordered_map<std::string, u32> thread_ids;
+    u32 next_string_id = 1;
+    bool enabled = true;
+    std::size_t bytes_written = 0;
+};
+
 #ifdef _WIN32
 /**
  * Backend that writes to Visual Studio's output window
@@ -119,6 +238,38 @@ public:
 #endif
 
 bool initialization_in_progress_suppress_logging = true;
+std::atomic_bool binary_logging = false;
+
+/// Log ring of the calling thread. Its name is captured when the thread first logs.
+struct ThreadLogRing {
+    ~ThreadLogRing() {
+        if (ring) {
+            ring->orphaned = true;
+        }
+    }
+
+    std::shared_ptr<LogRing> ring;
+    const void* owner = nullptr;
+};
+
+thread_local ThreadLogRing thread_log_ring;
+
+void PropagateToProfiler(Class log_class, Level log_level, const std::string& message) {
+    const auto& msg_str = fmt::format("[{}] {}", GetLogClassName(log_class), message);
+    switch (log_level) {
+    case Level::Warning:
+        TRACE_WARN(msg_str);
+        break;
+    case Level::Error:
+        TRACE_ERROR(msg_str);
+        break;
+    case Level::Critical:
+        TRACE_CRIT(msg_str);
+        break;
+    default:
+        break;
+    }
+}
 
 /**
  * Static state as a singleton.
@@ -142,6 +293,7 @@ public:
         Filter filter;
         filter.ParseFilterString(Config::getLogFilter());
         const auto& log_file_path = log_file.empty() ? LOG_FILE : log_file;
+        binary_logging = Config::getLogType() == "binary";
         instance = std::unique_ptr<Impl, decltype(&Deleter)>(
             new Impl(log_dir / log_file_path, filter), Deleter);
         initialization_in_progress_suppress_logging = false;
@@ -192,20 +344,13 @@ public:
 
         // Propagate important log messages to the profiler
         if (IsProfilerConnected()) {
-            const auto& msg_str = fmt::format("[{}] {}", GetLogClassName(log_class), message);
-            switch (log_level) {
-            case Level::Warning:
-                TRACE_WARN(msg_str);
-                break;
-            case Level::Error:
-                TRACE_ERROR(msg_str);
-                break;
-            case Level::Critical:
-                TRACE_CRIT(msg_str);
-                break;
-            default:
-                break;
-            }
+            PropagateToProfiler(log_class, log_level, message);
+        }
+
+        if (binary_logging) {
+            // Arguments that can't be packed are formatted here, the message is the payload.
+            PushFormattedRecord(log_class, log_level, filename, line_num, function, message);
+            return;
         }
 
         using std::chrono::duration_cast;
@@ -230,15 +375,192 @@ public:
         }
     }
 
+    u8* ReserveRecord(Class log_class, Level log_level, const char* filename,
+                      unsigned int line_num, const char* function, const char* format,
+                      u32 num_args, size_t payload_size) {
+        if (!filter.CheckMessage(log_class, log_level) || !Config::getLoggingEnabled()) {
+            return nullptr;
+        }
+        const size_t size = AlignUp(sizeof(RecordHeader) + payload_size, alignof(RecordHeader));
+        if (size > LogRing::MaxRecordSize) {
+            const auto notice = fmt::format("<dropped message with {} bytes of arguments: {}>",
+                                            payload_size, format);
+            PushFormattedRecord(log_class, log_level, filename, line_num, function, notice);
+            return nullptr;
+        }
+        RecordHeader* record = ReserveInRing(size);
+        if (record == nullptr) {
+            return nullptr;
+        }
+        *record = RecordHeader{
+            .size = static_cast<u32>(size),
+            .line_num = line_num,
+            .timestamp = GetTimestamp(),
+            .filename = filename,
+            .function = function,
+            .format = format,
+            .log_class = log_class,
+            .log_level = log_level,
+            .num_args = static_cast<u16>(num_args),
+            .payload_size = static_cast<u32>(payload_size),
+        };
+        return reinterpret_cast<u8*>(record + 1);
+    }
+
+    void CommitRecord() {
+        thread_log_ring.ring->Commit();
+    }
+
 private:
     Impl(const std::filesystem::path& file_backend_filename, const Filter& filter_)
-        : filter{filter_}, file_backend{file_backend_filename, should_append} {}
+        : filter{filter_} {
+        if (binary_logging) {
+            auto binary_filename = file_backend_filename;
+            binary_file_backend.emplace(binary_filename.replace_extension(".bin"), should_append);
+        } else {
+            file_backend.emplace(file_backend_filename, should_append);
+        }
+    }
 
     ~Impl() = default;
 
+    u64 GetTimestamp() const {
+        using std::chrono::duration_cast;
+        using std::chrono::microseconds;
+        using std::chrono::steady_clock;
+        return duration_cast<microseconds>(steady_clock::now() - time_origin).count();
+    }
+
+    LogRing& GetThreadRing() {
+        if (thread_log_ring.owner != this) {
+            if (thread_log_ring.ring) {
+                thread_log_ring.ring->orphaned = true;
+            }
+            thread_log_ring.ring = std::make_shared<LogRing>(Common::GetCurrentThreadName());
+            thread_log_ring.owner = this;
+            std::scoped_lock lock{rings_mutex};
+            rings.push_back(thread_log_ring.ring);
+        }
+        return *thread_log_ring.ring;
+    }
+
+    RecordHeader* ReserveInRing(size_t size) {
+        LogRing& ring = GetThreadRing();
+        RecordHeader* record;
+        while ((record = ring.Reserve(size)) == nullptr) {
+            // The ring is full, wait for the backend to catch up unless it isn't running.
+            if (!backend_running) {
+                return nullptr;
+            }
+            std::this_thread::yield();
+        }
+        return record;
+    }
+
+    void PushFormattedRecord(Class log_class, Level log_level, const char* filename,
+                             unsigned int line_num, const char* function,
+                             std::string_view message) {
+        const size_t max_size = LogRing::MaxRecordSize - sizeof(RecordHeader);
+        message = message.substr(0, max_size);
+        const size_t size = AlignUp(sizeof(RecordHeader) + message.size(), alignof(RecordHeader));
+        RecordHeader* record = ReserveInRing(size);
+        if (record == nullptr) {
+            return;
+        }
+        *record = RecordHeader{
+            .size = static_cast<u32>(size),
+            .line_num = line_num,
+            .timestamp = GetTimestamp(),
+            .filename = filename,
+            .function = function,
+            .format = nullptr,
+            .log_class = log_class,
+            .log_level = log_level,
+            .num_args = 0,
+            .payload_size = static_cast<u32>(message.size()),
+        };
+        std::memcpy(record + 1, message.data(), message.size());
+        CommitRecord();
+    }
+
+    /// Writes out the records of all threads in timestamp order, returns the number written.
+    size_t DrainRings(size_t max_records) {
+        {
+            std::scoped_lock lock{rings_mutex};
+            // Release the rings of exited threads once everything they logged was written.
+            std::erase_if(rings, [](const std::shared_ptr<LogRing>& ring) {
+                return ring->orphaned && ring->Front() == nullptr;
+            });
+            drain_rings.assign(rings.begin(), rings.end());
+        }
+        size_t count = 0;
+        while (count < max_records) {
+            LogRing* next_ring = nullptr;
+            const RecordHeader* next_record = nullptr;
+            for (const auto& ring : drain_rings) {
+                const RecordHeader* record = ring->Front();
+                if (record && (!next_record || record->timestamp < next_record->timestamp)) {
+                    next_record = record;
+                    next_ring = ring.get();
+                }
+            }
+            if (next_record == nullptr) {
+                break;
+            }
+            WriteRecord(*next_record, next_ring->ThreadName());
+            next_ring->Pop();
+            ++count;
+        }
+        drain_rings.clear();
+        return count;
+    }
+
+    void WriteRecord(const RecordHeader& record, const std::string& thread) {
+        binary_file_backend->Write(record, thread);
+
+        // Messages are only formatted if something displays them.
+        const bool propagate = record.format != nullptr && record.log_level >= Level::Warning &&
+                               IsProfilerConnected();
+#ifndef _WIN32
+        if (!color_console_backend.IsEnabled() && !propagate) {
+            return;
+        }
+#endif
+        const Entry entry = {
+            .timestamp = std::chrono::microseconds{record.timestamp},
+            .log_class = record.log_class,
+            .log_level = record.log_level,
+            .filename = record.filename,
+            .line_num = record.line_num,
+            .function = record.function,
+            .message = FormatRecordMessage(record),
+            .thread = thread,
+        };
+        if (propagate) {
+            PropagateToProfiler(entry.log_class, entry.log_level, entry.message);
+        }
+        ForEachBackend([&entry](auto& backend) { backend.Write(entry); });
+    }
+
+    void RunBinaryBackend(std::stop_token stop_token) {
+        while (!stop_token.stop_requested()) {
+            if (DrainRings(std::numeric_limits<size_t>::max()) == 0) {
+                Common::StoppableTimedWait(stop_token, std::chrono::milliseconds{1});
+            }
+        }
+        // Drain the rings. Only writes out up to MAX_LOGS_TO_WRITE unless debugging, in case a
+        // system is repeatedly spamming logs even on close.
+        DrainRings(filter.IsDebug() ? std::numeric_limits<size_t>::max() : 100);
+    }
+
     void StartBackendThread() {
+        backend_running = true;
         backend_thread = std::jthread([this](std::stop_token stop_token) {
             Common::SetCurrentThreadName("shadPS4:Log");
+            if (binary_logging) {
+                RunBinaryBackend(stop_token);
+                return;
+            }
             Entry entry;
             const auto write_logs = [this, &entry]() {
                 ForEachBackend([&entry](auto& backend) { backend.Write(entry); });
@@ -259,12 +581,16 @@ private:
     }
 
     void StopBackendThread() {
+        backend_running = false;
         backend_thread.request_stop();
         if (backend_thread.joinable()) {
             backend_thread.join();
         }
 
         ForEachBackend([](auto& backend) { backend.Flush(); });
+        if (binary_file_backend) {
+            binary_file_backend->Flush();
+        }
     }
 
     void ForEachBackend(auto lambda) {
@@ -272,7 +598,9 @@ private:
         lambda(debugger_backend);
 #endif
         lambda(color_console_backend);
-        lambda(file_backend);
+        if (file_backend) {
+            lambda(*file_backend);
+        }
     }
 
     static void Deleter(Impl* ptr) {
@@ -287,9 +615,14 @@ private:
     DebuggerBackend debugger_backend{};
 #endif
     ColorConsoleBackend color_console_backend{};
-    FileBackend file_backend;
+    std::optional<FileBackend> file_backend;
+    std::optional<BinaryFileBackend> binary_file_backend;
 
     MPSCQueue<Entry> message_queue{};
+    std::mutex rings_mutex;
+    std::vector<std::shared_ptr<LogRing>> rings;
+    std::vector<std::shared_ptr<LogRing>> drain_rings;
+    std::atomic_bool backend_running{};
     std::chrono::steady_clock::time_point time_origin{std::chrono::steady_clock::now()};
     std::jthread backend_thread;
 };
@@ -328,6 +661,24 @@ void SetAppend() {
     Impl::SetAppend();
 }
 
+bool IsBinaryLogging() {
+    return binary_logging.load(std::memory_order_relaxed);
+}
+
+u8* ReserveLogRecord(Class log_class, Level log_level, const char* filename,
+                     unsigned int line_num, const char* function, const char* format,
+                     u32 num_args, size_t payload_size) {
+    if (initialization_in_progress_suppress_logging) [[unlikely]] {
+        return nullptr;
+    }
+    return Impl::Instance().ReserveRecord(log_class, log_level, filename, line_num, function,
+                                          format, num_args, payload_size);
+}
+
+void CommitLogRecord() {
+    Impl::Instance().CommitRecord();
+}
+
 void FmtLogMessageImpl(Class log_class, Level log_level, const char* filename,
                        unsigned int line_num, const char* function, const char* format,
                        const fmt::format_args& args) {
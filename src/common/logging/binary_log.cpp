@@ -0,0 +1,255 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+#include <fmt/args.h>
+#include <fmt/format.h>
+
+#include "common/assert.h"
+#include "common/io_file.h"
+#include "common/logging/binary_log.h"
+#include "common/logging/log_args.h"
+
+namespace Common::Log {
+
+LogRing::LogRing(std::string thread_name_)
+    : buffer{std::make_unique<u8[]>(Capacity)}, thread_name{std::move(thread_name_)} {}
+
+LogRing::~LogRing() = default;
+
+RecordHeader* LogRing::Reserve(size_t size) {
+    ASSERT(size % alignof(RecordHeader) == 0 && size <= MaxRecordSize);
+    const size_t pos = write_pos.load(std::memory_order::relaxed);
+    const size_t offset = pos % Capacity;
+    // Records are contiguous, skip the end of the buffer if the record doesn't fit in it.
+    const size_t padding = Capacity - offset < size ? Capacity - offset : 0;
+    if (pos + padding + size - read_pos.load(std::memory_order::acquire) > Capacity) {
+        return nullptr;
+    }
+    if (padding != 0) {
+        auto* pad = reinterpret_cast<RecordHeader*>(buffer.get() + offset);
+        pad->size = static_cast<u32>(padding) | RecordHeader::PaddingFlag;
+    }
+    reserved_pos = pos + padding;
+    reserved_size = size;
+    return reinterpret_cast<RecordHeader*>(buffer.get() + reserved_pos % Capacity);
+}
+
+void LogRing::Commit() {
+    write_pos.store(reserved_pos + reserved_size, std::memory_order::release);
+}
+
+const RecordHeader* LogRing::Front() {
+    const size_t end = write_pos.load(std::memory_order::acquire);
+    size_t pos = read_pos.load(std::memory_order::relaxed);
+    while (pos != end) {
+        const auto* record = reinterpret_cast<const RecordHeader*>(buffer.get() + pos % Capacity);
+        if ((record->size & RecordHeader::PaddingFlag) == 0) {
+            return record;
+        }
+        pos += record->size & ~RecordHeader::PaddingFlag;
+        read_pos.store(pos, std::memory_order::release);
+    }
+    return nullptr;
+}
+
+void LogRing::Pop() {
+    const size_t pos = read_pos.load(std::memory_order::relaxed);
+    const auto* record = reinterpret_cast<const RecordHeader*>(buffer.get() + pos % Capacity);
+    read_pos.store(pos + record->size, std::memory_order::release);
+}
+
+namespace {
+
+/// Reads the arguments of a record, the payload comes from the log file and may be truncated.
+class PayloadReader {
+public:
+    explicit PayloadReader(std::span<const u8> payload)
+        : data{payload.data()}, end{payload.data() + payload.size()} {}
+
+    /// Returns false once a read ran past the end of the payload.
+    [[nodiscard]] bool IsValid() const {
+        return valid;
+    }
+
+    template <typename T>
+    T Read() {
+        T value{};
+        if (Remaining() < sizeof(T)) {
+            valid = false;
+            return value;
+        }
+        std::memcpy(&value, data, sizeof(T));
+        data += sizeof(T);
+        return value;
+    }
+
+    std::string_view ReadString(u32 size) {
+        if (Remaining() < size) {
+            valid = false;
+            return {};
+        }
+        const std::string_view value{reinterpret_cast<const char*>(data), size};
+        data += size;
+        return value;
+    }
+
+private:
+    [[nodiscard]] size_t Remaining() const {
+        return valid ? static_cast<size_t>(end - data) : 0;
+    }
+
+    const u8* data;
+    const u8* end;
+    bool valid{true};
+};
+
+std::string FormatMessage(const char* format, u32 num_args, std::span<const u8> payload) {
+    fmt::dynamic_format_arg_store<fmt::format_context> store;
+    store.reserve(num_args, 0);
+    PayloadReader reader{payload};
+    for (u32 i = 0; i < num_args; ++i) {
+        switch (reader.Read<ArgType>()) {
+        case ArgType::Int:
+            store.push_back(reader.Read<s32>());
+            break;
+        case ArgType::UInt:
+            store.push_back(reader.Read<u32>());
+            break;
+        case ArgType::LongLong:
+            store.push_back(static_cast<long long>(reader.Read<s64>()));
+            break;
+        case ArgType::ULongLong:
+            store.push_back(static_cast<unsigned long long>(reader.Read<u64>()));
+            break;
+        case ArgType::Bool:
+            store.push_back(reader.Read<u8>() != 0);
+            break;
+        case ArgType::Char:
+            store.push_back(reader.Read<char>());
+            break;
+        case ArgType::Float:
+            store.push_back(reader.Read<float>());
+            break;
+        case ArgType::Double:
+            store.push_back(reader.Read<double>());
+            break;
+        case ArgType::Pointer:
+            store.push_back(reinterpret_cast<const void*>(reader.Read<u64>()));
+            break;
+        case ArgType::String:
+            store.push_back(reader.ReadString(reader.Read<u32>()));
+            break;
+        default:
+            return fmt::format("<malformed log record: {}>", format);
+        }
+        if (!reader.IsValid()) {
+            return fmt::format("<malformed log record: {}>", format);
+        }
+    }
+    try {
+        return fmt::vformat(format, store);
+    } catch (const fmt::format_error& e) {
+        return fmt::format("<failed to format \"{}\": {}>", format, e.what());
+    }
+}
+
+} // Anonymous namespace
+
+std::string FormatRecordMessage(const RecordHeader& record) {
+    const auto payload = record.Payload();
+    if (record.format == nullptr) {
+        return std::string{reinterpret_cast<const char*>(payload.data()), payload.size()};
+    }
+    return FormatMessage(record.format, record.num_args, payload);
+}
+
+namespace BinaryLog {
+
+bool Decode(const std::filesystem::path& path, const std::function<void(const Entry&)>& func) {
+    const FS::IOFile file{path, FS::FileAccessMode::Read};
+    if (!file.IsOpen()) {
+        return false;
+    }
+    std::vector<u8> data(file.GetSize());
+    if (file.ReadSpan(std::span{data}) != data.size()) {
+        return false;
+    }
+
+    std::unordered_map<u32, std::string> strings;
+    const auto get_string = [&strings](u32 id) -> const std::string& {
+        static const std::string unknown{"<unknown>"};
+        const auto it = strings.find(id);
+        return it != strings.end() ? it->second : unknown;
+    };
+
+    size_t pos = 0;
+    const auto remaining = [&] { return data.size() - pos; };
+    while (pos < data.size()) {
+        if (remaining() >= Magic.size() &&
+            std::memcmp(&data[pos], Magic.data(), Magic.size()) == 0) {
+            // Start of a new session, string ids are not shared between them.
+            strings.clear();
+            pos += Magic.size();
+            continue;
+        }
+        switch (static_cast<ChunkType>(data[pos])) {
+        case ChunkType::String: {
+            StringChunk chunk;
+            if (remaining() < sizeof(chunk)) {
+                return false;
+            }
+            std::memcpy(&chunk, &data[pos], sizeof(chunk));
+            pos += sizeof(chunk);
+            if (remaining() < chunk.size) {
+                return false;
+            }
+            strings[chunk.id].assign(reinterpret_cast<const char*>(&data[pos]), chunk.size);
+            pos += chunk.size;
+            break;
+        }
+        case ChunkType::Record: {
+            RecordChunk chunk;
+            if (remaining() < sizeof(chunk)) {
+                return false;
+            }
+            std::memcpy(&chunk, &data[pos], sizeof(chunk));
+            pos += sizeof(chunk);
+            if (remaining() < chunk.payload_size) {
+                return false;
+            }
+            const std::span<const u8> payload{&data[pos], chunk.payload_size};
+            pos += chunk.payload_size;
+
+            const std::string& filename = get_string(chunk.filename_id);
+            std::string message;
+            if (chunk.format_id == 0) {
+                message.assign(reinterpret_cast<const char*>(payload.data()), payload.size());
+            } else {
+                message = FormatMessage(get_string(chunk.format_id).c_str(), chunk.num_args,
+                                        payload);
+            }
+            func(Entry{
+                .timestamp = std::chrono::microseconds{chunk.timestamp},
+                .log_class = chunk.log_class,
+                .log_level = chunk.log_level,
+                .filename = filename.c_str(),
+                .line_num = chunk.line_num,
+                .function = get_string(chunk.function_id),
+                .message = std::move(message),
+                .thread = get_string(chunk.thread_id),
+            });
+            break;
+        }
+        default:
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace BinaryLog
+
+} // namespace Common::Log
@@ -0,0 +1,124 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <span>
+#include <string>
+
+#include "common/logging/log_entry.h"
+#include "common/logging/types.h"
+
+namespace Common::Log {
+
+/// Header of a record in the log ring of a thread, followed by the payload.
+struct RecordHeader {
+    static constexpr u32 PaddingFlag = 1U << 31;
+
+    u32 size;     ///< Size of the record including the header, PaddingFlag for ring padding
+    u32 line_num; ///< Line of the log statement
+    u64 timestamp;
+    const char* filename;
+    const char* function;
+    const char* format; ///< nullptr when the payload holds the formatted message
+    Class log_class;
+    Level log_level;
+    u16 num_args;
+    u32 payload_size;
+
+    [[nodiscard]] std::span<const u8> Payload() const {
+        return {reinterpret_cast<const u8*>(this + 1), payload_size};
+    }
+};
+
+/**
+ * Single producer single consumer ring of variable sized log records.
+ * Every thread that logs in binary mode owns one and writes its records in place, the backend
+ * thread is the only consumer. Records never wrap around, the tail of the buffer is skipped with
+ * a padding record instead.
+ */
+class LogRing {
+public:
+    static constexpr size_t Capacity = 256 * 1024;
+    static constexpr size_t MaxRecordSize = Capacity / 4;
+
+    explicit LogRing(std::string thread_name);
+    ~LogRing();
+
+    /// Reserves a record of the given size, returns nullptr if the ring is full. Producer only.
+    RecordHeader* Reserve(size_t size);
+
+    /// Publishes the reserved record. Producer only.
+    void Commit();
+
+    /// Returns the oldest published record or nullptr. Consumer only.
+    const RecordHeader* Front();
+
+    /// Removes the record returned by Front. Consumer only.
+    void Pop();
+
+    [[nodiscard]] const std::string& ThreadName() const {
+        return thread_name;
+    }
+
+    /// Set when the owning thread exits, the ring is released once it has been drained.
+    std::atomic_bool orphaned{};
+
+private:
+    std::unique_ptr<u8[]> buffer;
+    alignas(64) std::atomic<size_t> write_pos{};
+    alignas(64) std::atomic<size_t> read_pos{};
+    size_t reserved_pos{};
+    size_t reserved_size{};
+    std::string thread_name;
+};
+
+/// Formats the message of a record by unpacking its arguments.
+[[nodiscard]] std::string FormatRecordMessage(const RecordHeader& record);
+
+/**
+ * On-disk format of binary logs. The file is a sequence of chunks after the magic. Strings such
+ * as format strings and file names are written once in a string chunk and referenced by id in
+ * the record chunks, the record payload is copied verbatim from the log ring. Appending to an
+ * existing log writes the magic again, which resets the string table.
+ */
+namespace BinaryLog {
+
+constexpr std::array<char, 8> Magic = {'S', 'H', 'A', 'D', 'L', 'O', 'G', '1'};
+
+enum class ChunkType : u8 {
+    String = 1,
+    Record = 2,
+};
+
+struct StringChunk {
+    ChunkType type;
+    u32 id;
+    u32 size;
+};
+
+struct RecordChunk {
+    ChunkType type;
+    Class log_class;
+    Level log_level;
+    u32 line_num;
+    u64 timestamp;
+    u32 filename_id;
+    u32 function_id;
+    u32 format_id; ///< Zero when the payload holds the formatted message
+    u32 thread_id;
+    u32 num_args;
+    u32 payload_size;
+};
+
+/// Decodes a binary log, calling func for every entry. Returns false if the file is malformed.
+bool Decode(const std::filesystem::path& path, const std::function<void(const Entry&)>& func);
+
+} // namespace BinaryLog
+
+} // namespace Common::Log
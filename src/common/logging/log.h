@@ -8,6 +8,7 @@
 #include <string_view>
 
 #include "common/logging/formatter.h"
+#include "common/logging/log_args.h"
 #include "common/logging/types.h"
 
 namespace Common::Log {
@@ -25,9 +26,34 @@ void FmtLogMessageImpl(Class log_class, Level log_level, const char* filename,
                        unsigned int line_num, const char* function, const char* format,
                        const fmt::format_args& args);
 
+/// Returns true if messages are written as binary records with deferred formatting
+bool IsBinaryLogging();
+
+/// Reserves a binary record for a message with packed arguments in the log ring of the calling
+/// thread. Returns the payload to pack the arguments into, or nullptr if the message is filtered.
+u8* ReserveLogRecord(Class log_class, Level log_level, const char* filename,
+                     unsigned int line_num, const char* function, const char* format,
+                     u32 num_args, size_t payload_size);
+
+/// Publishes the record returned by ReserveLogRecord to the backend
+void CommitLogRecord();
+
 template <typename... Args>
 void FmtLogMessage(Class log_class, Level log_level, const char* filename, unsigned int line_num,
                    const char* function, const char* format, const Args&... args) {
+    if constexpr ((PackableArg<Args> && ...)) {
+        if (IsBinaryLogging()) {
+            // Only capture the arguments, formatting happens on the backend thread.
+            const size_t payload_size = (size_t{0} + ... + Detail::PackedSize(args));
+            u8* payload = ReserveLogRecord(log_class, log_level, filename, line_num, function,
+                                           format, sizeof...(Args), payload_size);
+            if (payload != nullptr) {
+                ((payload = Detail::PackArg(payload, args)), ...);
+                CommitLogRecord();
+            }
+            return;
+        }
+    }
     FmtLogMessageImpl(log_class, log_level, filename, line_num, function, format,
                       fmt::make_format_args(args...));
 }
@@ -0,0 +1,140 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "common/types.h"
+
+namespace Common::Log {
+
+/// Type of an argument packed into a binary log record. Mirrors the fmt argument types, so the
+/// backend formats the unpacked values exactly like the caller would have.
+enum class ArgType : u8 {
+    Int,
+    UInt,
+    LongLong,
+    ULongLong,
+    Bool,
+    Char,
+    Float,
+    Double,
+    Pointer,
+    String,
+};
+
+namespace Detail {
+
+template <typename T>
+constexpr bool IsPackedString =
+    std::is_same_v<T, const char*> || std::is_same_v<T, char*> || std::is_same_v<T, std::string> ||
+    std::is_same_v<T, std::string_view>;
+
+template <typename T>
+constexpr bool IsPackedScalar =
+    std::is_same_v<T, bool> || std::is_same_v<T, char> || std::is_same_v<T, float> ||
+    std::is_same_v<T, double> || std::is_same_v<T, const void*> || std::is_same_v<T, void*> ||
+    (std::is_integral_v<T> && !std::is_same_v<T, wchar_t> && !std::is_same_v<T, char8_t> &&
+     !std::is_same_v<T, char16_t> && !std::is_same_v<T, char32_t> && sizeof(T) <= sizeof(u64));
+
+template <typename T>
+constexpr ArgType GetArgType() {
+    if constexpr (IsPackedString<T>) {
+        return ArgType::String;
+    } else if constexpr (std::is_same_v<T, bool>) {
+        return ArgType::Bool;
+    } else if constexpr (std::is_same_v<T, char>) {
+        return ArgType::Char;
+    } else if constexpr (std::is_same_v<T, float>) {
+        return ArgType::Float;
+    } else if constexpr (std::is_same_v<T, double>) {
+        return ArgType::Double;
+    } else if constexpr (std::is_pointer_v<T>) {
+        return ArgType::Pointer;
+    } else if constexpr (std::is_signed_v<T>) {
+        return sizeof(T) <= sizeof(s32) ? ArgType::Int : ArgType::LongLong;
+    } else {
+        return sizeof(T) <= sizeof(u32) ? ArgType::UInt : ArgType::ULongLong;
+    }
+}
+
+constexpr size_t GetScalarSize(ArgType type) {
+    switch (type) {
+    case ArgType::Bool:
+    case ArgType::Char:
+        return 1;
+    case ArgType::Int:
+    case ArgType::UInt:
+    case ArgType::Float:
+        return 4;
+    default:
+        return 8;
+    }
+}
+
+inline std::string_view ToStringView(const char* str) {
+    return str ? std::string_view{str} : std::string_view{"(null)"};
+}
+
+inline std::string_view ToStringView(std::string_view str) {
+    return str;
+}
+
+template <typename T>
+size_t PackedSize(const T& arg) {
+    using Type = std::decay_t<T>;
+    if constexpr (IsPackedString<Type>) {
+        return 1 + sizeof(u32) + ToStringView(arg).size();
+    } else {
+        return 1 + GetScalarSize(GetArgType<Type>());
+    }
+}
+
+template <typename T>
+u8* PackArg(u8* out, const T& arg) {
+    using Type = std::decay_t<T>;
+    constexpr ArgType type = GetArgType<Type>();
+    *out++ = static_cast<u8>(type);
+    if constexpr (IsPackedString<Type>) {
+        const std::string_view str = ToStringView(arg);
+        const u32 size = static_cast<u32>(str.size());
+        std::memcpy(out, &size, sizeof(size));
+        std::memcpy(out + sizeof(size), str.data(), size);
+        return out + sizeof(size) + size;
+    } else {
+        // Integers are widened to the size of their fmt argument type.
+        if constexpr (type == ArgType::Int) {
+            const s32 value = arg;
+            std::memcpy(out, &value, sizeof(value));
+        } else if constexpr (type == ArgType::UInt) {
+            const u32 value = arg;
+            std::memcpy(out, &value, sizeof(value));
+        } else if constexpr (type == ArgType::LongLong) {
+            const s64 value = arg;
+            std::memcpy(out, &value, sizeof(value));
+        } else if constexpr (type == ArgType::ULongLong) {
+            const u64 value = arg;
+            std::memcpy(out, &value, sizeof(value));
+        } else if constexpr (type == ArgType::Pointer) {
+            const u64 value = reinterpret_cast<uintptr_t>(arg);
+            std::memcpy(out, &value, sizeof(value));
+        } else {
+            std::memcpy(out, &arg, sizeof(arg));
+        }
+        return out + GetScalarSize(type);
+    }
+}
+
+} // namespace Detail
+
+/// Arguments that can be packed into a binary log record and formatted later by the backend.
+/// Messages with any other argument type are formatted on the calling thread.
+template <typename T>
+concept PackableArg =
+    Detail::IsPackedString<std::decay_t<T>> || Detail::IsPackedScalar<std::decay_t<T>>;
+
+} // namespace Common::Log
@@ -4,6 +4,7 @@
 #include <algorithm>
 #include <codecvt>
 #include <fstream>
+#include <mutex>
 #include <sstream>
 #include <string>
 #include <nlohmann/json.hpp>
@@ -12,6 +13,7 @@
 #include "common/elf_info.h"
 #include "common/logging/log.h"
 #include "common/path_util.h"
+#include "common/pattern_scanner.h"
 #include "core/emulator_state.h"
 #include "core/file_format/psf.h"
 #include "memory_patcher.h"
@@ -25,6 +27,15 @@ std::string patch_file;
 bool patches_applied = false;
 std::vector<patchInfo> pending_patches;
 
+// Mask patches are resolved by scanning the eboot first, then the modules in load order.
+Common::PatternScanner scanner;
+std::vector<std::pair<uintptr_t, u64>> module_images;
+// Mask patches whose pattern wasn't found yet, retried when a module is loaded.
+std::vector<patchInfo> deferred_patches;
+// Guards the patcher state, patches arrive from the IPC thread while the loader maps modules.
+// Recursive because applying a patch goes back through PatchMemory and PatternScan.
+std::recursive_mutex patch_mutex;
+
 std::string toHex(u64 value, size_t byteSize) {
     std::stringstream ss;
     ss << std::hex << std::setfill('0') << std::setw(byteSize * 2) << value;
@@ -113,9 +124,7 @@ std::string convertValueToHex(const std::string type, const std::string valueStr
     return result;
 }
 
-void ApplyPendingPatches();
-
-void ApplyPatchesFromXML(std::filesystem::path path) {
+void ApplyPatchesFromXML(std::filesystem::path path, std::vector<patchInfo>& patches) {
     pugi::xml_document doc;
     pugi::xml_parse_result result = doc.load_file(path.c_str());
 
@@ -171,9 +180,18 @@ void ApplyPatchesFromXML(std::filesystem::path path) {
                             maskOffsetValue = std::stoi(maskOffsetStr, 0, 10);
                         }
 
-                        MemoryPatcher::PatchMemory(currentPatchName, address, patchValue, targetStr,
-                                                   sizeStr, false, littleEndian, patchMask,
-                                                   maskOffsetValue);
+                        patches.push_back(patchInfo{
+                            .gameSerial = g_game_serial,
+                            .modNameStr = currentPatchName,
+                            .offsetStr = address,
+                            .valueStr = patchValue,
+                            .targetStr = targetStr,
+                            .sizeStr = sizeStr,
+                            .isOffset = false,
+                            .littleEndian = littleEndian,
+                            .patchMask = patchMask,
+                            .maskOffset = maskOffsetValue,
+                        });
                     }
                 }
             }
@@ -183,15 +201,53 @@ void ApplyPatchesFromXML(std::filesystem::path path) {
     }
 }
 
+void ScanImages() {
+    scanner.Scan({reinterpret_cast<const u8*>(g_eboot_address), g_eboot_image_size});
+    for (const auto& [address, size] : module_images) {
+        scanner.Scan({reinterpret_cast<const u8*>(address), size});
+    }
+}
+
+void ApplyPatch(const patchInfo& patch) {
+    PatchMemory(patch.modNameStr, patch.offsetStr, patch.valueStr, patch.targetStr, patch.sizeStr,
+                patch.isOffset, patch.littleEndian, patch.patchMask, patch.maskOffset);
+}
+
+bool IsResolved(const patchInfo& patch) {
+    switch (patch.patchMask) {
+    case PatchMask::Mask:
+        return PatternScan(patch.offsetStr) != 0;
+    case PatchMask::Mask_Jump32:
+        return PatternScan(patch.offsetStr) != 0 && PatternScan(patch.targetStr) != 0;
+    default:
+        return true;
+    }
+}
+
+void ApplyPatches(const std::vector<patchInfo>& patches) {
+    for (const patchInfo& patch : patches) {
+        if (!IsResolved(patch)) {
+            // The pattern may be in a module that isn't loaded yet.
+            LOG_INFO(Loader, "Deferring patch {}, pattern not found: {}", patch.modNameStr,
+                     patch.offsetStr);
+            deferred_patches.push_back(patch);
+            continue;
+        }
+        ApplyPatch(patch);
+    }
+}
+
 void OnGameLoaded() {
+    std::scoped_lock lock{patch_mutex};
+    std::vector<patchInfo> patches;
     std::filesystem::path patch_dir = Common::FS::GetUserPath(Common::FS::PathType::PatchesDir);
     if (!patch_file.empty()) {
 
         auto file_path = (patch_dir / patch_file).native();
         if (std::filesystem::exists(patch_file)) {
-            ApplyPatchesFromXML(patch_file);
+            ApplyPatchesFromXML(patch_file, patches);
         } else {
-            ApplyPatchesFromXML(file_path);
+            ApplyPatchesFromXML(file_path, patches);
         }
     } else if (EmulatorState::GetInstance()->IsAutoPatchesLoadEnabled()) {
         for (auto const& repo : std::filesystem::directory_iterator(patch_dir)) {
@@ -208,14 +264,47 @@ void OnGameLoaded() {
                 }
             }
             if (std::filesystem::exists(game_patch_file)) {
-                ApplyPatchesFromXML(game_patch_file);
+                ApplyPatchesFromXML(game_patch_file, patches);
             }
         }
     }
-    ApplyPendingPatches();
+
+    for (const patchInfo& patch : pending_patches) {
+        if (patch.gameSerial == "*" || patch.gameSerial == g_game_serial) {
+            patches.push_back(patch);
+        }
+    }
+    pending_patches.clear();
+    patches_applied = true;
+
+    // Resolve the signatures of every mask patch with a single pass over the images. Patches are
+    // still applied in order, PatternScan rescans if an earlier patch overwrote a match.
+    for (const patchInfo& patch : patches) {
+        if (patch.patchMask != PatchMask::None) {
+            scanner.AddPattern(patch.offsetStr);
+        }
+        if (patch.patchMask == PatchMask::Mask_Jump32) {
+            scanner.AddPattern(patch.targetStr);
+        }
+    }
+    ScanImages();
+    ApplyPatches(patches);
+}
+
+void OnModuleLoaded(uintptr_t base_address, u64 image_size) {
+    std::scoped_lock lock{patch_mutex};
+    module_images.emplace_back(base_address, image_size);
+    if (!patches_applied || deferred_patches.empty()) {
+        return;
+    }
+    scanner.Scan({reinterpret_cast<const u8*>(base_address), image_size});
+    std::vector<patchInfo> patches = std::move(deferred_patches);
+    deferred_patches.clear();
+    ApplyPatches(patches);
 }
 
 void AddPatchToQueue(patchInfo patchToAdd) {
+    std::scoped_lock lock{patch_mutex};
     if (patches_applied) {
         PatchMemory(patchToAdd.modNameStr, patchToAdd.offsetStr, patchToAdd.valueStr,
                     patchToAdd.targetStr, patchToAdd.sizeStr, patchToAdd.isOffset,
@@ -225,25 +314,10 @@ void AddPatchToQueue(patchInfo patchToAdd) {
     pending_patches.push_back(patchToAdd);
 }
 
-void ApplyPendingPatches() {
-    patches_applied = true;
-    for (size_t i = 0; i < pending_patches.size(); ++i) {
-        const patchInfo& currentPatch = pending_patches[i];
-
-        if (currentPatch.gameSerial != "*" && currentPatch.gameSerial != g_game_serial)
-            continue;
-
-        PatchMemory(currentPatch.modNameStr, currentPatch.offsetStr, currentPatch.valueStr,
-                    currentPatch.targetStr, currentPatch.sizeStr, currentPatch.isOffset,
-                    currentPatch.littleEndian, currentPatch.patchMask, currentPatch.maskOffset);
-    }
-
-    pending_patches.clear();
-}
-
 void PatchMemory(std::string modNameStr, std::string offsetStr, std::string valueStr,
                  std::string targetStr, std::string sizeStr, bool isOffset, bool littleEndian,
                  PatchMask patchMask, int maskOffset) {
+    std::scoped_lock lock{patch_mutex};
     // Send a request to modify the process memory.
     void* cheatAddress = nullptr;
 
@@ -257,7 +331,12 @@ void PatchMemory(std::string modNameStr, std::string offsetStr, std::string valu
     }
 
     if (patchMask == PatchMask::Mask) {
-        cheatAddress = reinterpret_cast<void*>(PatternScan(offsetStr) + maskOffset);
+        const uintptr_t baseAddress = PatternScan(offsetStr);
+        if (baseAddress == 0) {
+            LOG_ERROR(Loader, "PatternScan failed for mask with pattern: {}", offsetStr);
+            return;
+        }
+        cheatAddress = reinterpret_cast<void*>(baseAddress + maskOffset);
     }
 
     if (patchMask == PatchMask::Mask_Jump32) {
@@ -362,49 +441,21 @@ void PatchMemory(std::string modNameStr, std::string offsetStr, std::string valu
              (uintptr_t)cheatAddress, valueStr);
 }
 
-static std::vector<int32_t> PatternToByte(const std::string& pattern) {
-    std::vector<int32_t> bytes;
-    const char* start = pattern.data();
-    const char* end = start + pattern.size();
-
-    for (const char* current = start; current < end; ++current) {
-        if (*current == '?') {
-            ++current;
-            if (*current == '?')
-                ++current;
-            bytes.push_back(-1);
-        } else {
-            bytes.push_back(strtoul(current, const_cast<char**>(&current), 16));
-        }
-    }
-
-    return bytes;
-}
-
 uintptr_t PatternScan(const std::string& signature) {
-    std::vector<int32_t> patternBytes = PatternToByte(signature);
-    const auto scanBytes = static_cast<uint8_t*>((void*)g_eboot_address);
-
-    const int32_t* sigPtr = patternBytes.data();
-    const size_t sigSize = patternBytes.size();
-
-    uint32_t foundResults = 0;
-    for (uint32_t i = 0; i < g_eboot_image_size - sigSize; ++i) {
-        bool found = true;
-        for (uint32_t j = 0; j < sigSize; ++j) {
-            if (scanBytes[i + j] != sigPtr[j] && sigPtr[j] != -1) {
-                found = false;
-                break;
-            }
-        }
-
-        if (found) {
-            foundResults++;
-            return reinterpret_cast<uintptr_t>(&scanBytes[i]);
-        }
+    std::scoped_lock lock{patch_mutex};
+    const size_t num_patterns = scanner.NumPatterns();
+    const size_t index = scanner.AddPattern(signature);
+    bool needs_scan = index >= num_patterns;
+    const uintptr_t result = scanner.GetResult(index);
+    if (result != 0 && !scanner.Matches(index, result)) {
+        // A previous patch overwrote the match, look for the next one.
+        scanner.Reset(index);
+        needs_scan = true;
     }
-
-    return 0;
+    if (needs_scan) {
+        ScanImages();
+    }
+    return scanner.GetResult(index);
 }
 
 } // namespace MemoryPatcher
@@ -41,13 +41,13 @@ struct patchInfo {
 std::string convertValueToHex(const std::string type, const std::string valueStr);
 
 void OnGameLoaded();
+void OnModuleLoaded(uintptr_t base_address, uint64_t image_size);
 void AddPatchToQueue(patchInfo patchToAdd);
 
 void PatchMemory(std::string modNameStr, std::string offsetStr, std::string valueStr,
                  std::string targetStr, std::string sizeStr, bool isOffset, bool littleEndian,
                  PatchMask patchMask = PatchMask::None, int maskOffset = 0);
 
-static std::vector<int32_t> PatternToByte(const std::string& pattern);
 uintptr_t PatternScan(const std::string& signature);
 
 } // namespace MemoryPatcher
\ No newline at end of file
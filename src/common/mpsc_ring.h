@@ -0,0 +1,100 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <utility>
+
+namespace Common {
+
+/**
+ * Bounded lock-free multi-producer single-consumer ring.
+ * Producers claim slots with a CAS on the write index and publish them through a per-slot
+ * sequence number. The single consumer may peek the oldest element and pop it later, which
+ * allows keeping an element in the queue while it is being processed.
+ */
+template <typename T, std::size_t Capacity>
+class MPSCRing {
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two.");
+    static constexpr std::size_t Mask = Capacity - 1;
+
+public:
+    MPSCRing() {
+        for (std::size_t i = 0; i < Capacity; ++i) {
+            m_slots[i].sequence.store(i, std::memory_order::relaxed);
+        }
+    }
+
+    /// Attempts to push an element, returns false if the ring is full. Thread-safe.
+    template <typename... Args>
+    bool TryEmplace(Args&&... args) {
+        std::size_t pos = m_write_index.load(std::memory_order::relaxed);
+        while (true) {
+            Slot& slot = m_slots[pos & Mask];
+            const std::size_t sequence = slot.sequence.load(std::memory_order::acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(sequence - pos);
+            if (diff == 0) {
+                if (m_write_index.compare_exchange_weak(pos, pos + 1,
+                                                        std::memory_order::relaxed)) {
+                    slot.value = T{std::forward<Args>(args)...};
+                    slot.sequence.store(pos + 1, std::memory_order::release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = m_write_index.load(std::memory_order::relaxed);
+            }
+        }
+    }
+
+    /// Pushes an element, yielding while the ring is full. Thread-safe.
+    template <typename... Args>
+    void EmplaceWait(Args&&... args) {
+        while (!TryEmplace(args...)) {
+            std::this_thread::yield();
+        }
+    }
+
+    /// Returns the oldest published element or nullptr. Consumer thread only.
+    T* Front() {
+        Slot& slot = m_slots[m_read_index & Mask];
+        if (slot.sequence.load(std::memory_order::acquire) != m_read_index + 1) {
+            return nullptr;
+        }
+        return &slot.value;
+    }
+
+    /// Removes the element returned by Front. Consumer thread only.
+    void Pop() {
+        Slot& slot = m_slots[m_read_index & Mask];
+        slot.value = T{};
+        slot.sequence.store(m_read_index + Capacity, std::memory_order::release);
+        ++m_read_index;
+    }
+
+    /// Number of claimed elements, including ones still being published. Consumer thread only.
+    [[nodiscard]] std::size_t Size() const {
+        return m_write_index.load(std::memory_order::acquire) - m_read_index;
+    }
+
+    [[nodiscard]] bool Empty() {
+        return Front() == nullptr;
+    }
+
+private:
+    struct Slot {
+        std::atomic<std::size_t> sequence;
+        T value{};
+    };
+
+    alignas(128) std::atomic<std::size_t> m_write_index{0};
+    alignas(128) std::size_t m_read_index{0};
+    alignas(128) std::array<Slot, Capacity> m_slots;
+};
+
+} // namespace Common
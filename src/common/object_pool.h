@@ -16,6 +16,7 @@ class ObjectPool {
 public:
     explicit ObjectPool(size_t chunk_size = 8192) : new_chunk_size{chunk_size} {
         node = &chunks.emplace_back(new_chunk_size);
+        ++num_chunk_allocations;
     }
 
     template <typename... Args>
@@ -24,6 +25,20 @@ public:
         return std::construct_at(Memory(), std::forward<Args>(args)...);
     }
 
+    /// Returns the number of objects created since the last release.
+    [[nodiscard]] size_t NumAllocated() const {
+        size_t count{};
+        for (const Chunk& chunk : chunks) {
+            count += chunk.used_objects;
+        }
+        return count;
+    }
+
+    /// Returns the number of chunks allocated from the heap over the lifetime of the pool.
+    [[nodiscard]] size_t NumChunkAllocations() const {
+        return num_chunk_allocations;
+    }
+
     void ReleaseContents() {
         if (chunks.empty()) {
             return;
@@ -34,6 +49,7 @@ public:
             const size_t total_objects{root.num_objects + new_chunk_size * (chunks.size() - 1)};
             chunks.clear();
             chunks.emplace_back(total_objects);
+            ++num_chunk_allocations;
         } else {
             root.Release();
             chunks.resize(1);
@@ -96,12 +112,14 @@ private:
             return node;
         }
         node = &chunks.emplace_back(new_chunk_size);
+        ++num_chunk_allocations;
         return node;
     }
 
     Chunk* node{};
     std::vector<Chunk> chunks;
     size_t new_chunk_size{};
+    size_t num_chunk_allocations{};
 };
 
 } // namespace Common
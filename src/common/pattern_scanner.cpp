@@ -0,0 +1,266 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <array>
+#include <bit>
+#include <cctype>
+#include <cstdlib>
+#include <limits>
+#include <memory>
+#include <optional>
+
+#include "common/pattern_scanner.h"
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+namespace Common {
+
+namespace {
+
+constexpr u32 NoAnchor = std::numeric_limits<u32>::max();
+
+/// Stride of the byte frequency sampling, prime so that it doesn't follow structure alignment.
+constexpr size_t HistogramStride = 61;
+
+using Histogram = std::array<u64, 256>;
+
+/// Picks the fixed byte with the lowest expected number of candidate positions, preferring
+/// bytes followed by another fixed byte as the pair filter then rejects most of them.
+u32 ChooseAnchor(const std::vector<u8>& mask, const std::vector<u8>& bytes,
+                 const Histogram& histogram, u64 total) {
+    u32 anchor = NoAnchor;
+    u64 best_score = std::numeric_limits<u64>::max();
+    for (u32 i = 0; i < bytes.size(); ++i) {
+        if (mask[i] == 0) {
+            continue;
+        }
+        const bool has_pair = i + 1 < bytes.size() && mask[i + 1] != 0;
+        const u64 second = has_pair ? histogram[bytes[i + 1]] + 1 : total + 1;
+        const u64 score = (histogram[bytes[i]] + 1) * second;
+        if (score < best_score) {
+            best_score = score;
+            anchor = i;
+        }
+    }
+    return anchor;
+}
+
+/**
+ * Candidate filter built from the anchors of the patterns being searched.
+ * The nibble tables implement a shufti byte class test: a byte c of the class sets bucket
+ * (c >> 4) & 7 in both the entry of its low and high nibble. A byte passes if the entries of its
+ * nibbles share a bucket, which only admits bytes differing from the class in the top bit. The
+ * second byte tables use the bucket of the first byte, so adjacent bytes are tested as a pair.
+ */
+struct AnchorFilter {
+    alignas(16) std::array<u8, 16> lo_nibbles{};
+    alignas(16) std::array<u8, 16> hi_nibbles{};
+    alignas(16) std::array<u8, 16> second_lo_nibbles{};
+    alignas(16) std::array<u8, 16> second_hi_nibbles{};
+    std::array<u64, 65536 / 64> pairs{};
+    std::array<std::vector<u32>, 256> patterns;
+
+    void Add(u32 index, u8 first, std::optional<u8> second) {
+        const u8 bucket = 1U << ((first >> 4) & 7);
+        lo_nibbles[first & 0xF] |= bucket;
+        hi_nibbles[first >> 4] |= bucket;
+        if (second) {
+            second_lo_nibbles[*second & 0xF] |= bucket;
+            second_hi_nibbles[*second >> 4] |= bucket;
+            SetPair(first | (*second << 8));
+        } else {
+            for (u32 i = 0; i < 256; ++i) {
+                SetPair(first | (i << 8));
+            }
+            for (u32 i = 0; i < 16; ++i) {
+                second_lo_nibbles[i] |= bucket;
+                second_hi_nibbles[i] |= bucket;
+            }
+        }
+        patterns[first].push_back(index);
+    }
+
+    void SetPair(u32 pair) {
+        pairs[pair / 64] |= 1ULL << (pair % 64);
+    }
+
+    [[nodiscard]] bool HasPair(u32 pair) const {
+        return (pairs[pair / 64] >> (pair % 64)) & 1;
+    }
+};
+
+std::optional<u8> ParseByte(const char*& current, const char* end) {
+    if (*current == '?') {
+        while (current < end && *current == '?') {
+            ++current;
+        }
+        return std::nullopt;
+    }
+    char* next;
+    const auto value = std::strtoul(current, &next, 16);
+    current = next;
+    return static_cast<u8>(value);
+}
+
+} // Anonymous namespace
+
+size_t PatternScanner::AddPattern(std::string_view signature) {
+    const auto [it, inserted] = indices.try_emplace(std::string{signature}, patterns.size());
+    if (!inserted) {
+        return it->second;
+    }
+
+    Pattern& pattern = patterns.emplace_back();
+    const char* current = signature.data();
+    const char* const end = current + signature.size();
+    while (current < end) {
+        if (std::isspace(static_cast<unsigned char>(*current))) {
+            ++current;
+            continue;
+        }
+        if (*current != '?' && !std::isxdigit(static_cast<unsigned char>(*current))) {
+            break;
+        }
+        const auto byte = ParseByte(current, end);
+        pattern.bytes.push_back(byte.value_or(0));
+        pattern.mask.push_back(byte ? 0xFF : 0);
+    }
+    return it->second;
+}
+
+bool PatternScanner::Pattern::Compare(const u8* data) const {
+    for (size_t i = 0; i < bytes.size(); ++i) {
+        if ((data[i] & mask[i]) != bytes[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool PatternScanner::Matches(size_t index, uintptr_t address) const {
+    return address != 0 && patterns[index].Compare(reinterpret_cast<const u8*>(address));
+}
+
+void PatternScanner::Scan(std::span<const u8> image) {
+    const u8* const data = image.data();
+    const size_t size = image.size();
+
+    std::vector<u32> pending;
+    for (u32 i = 0; i < patterns.size(); ++i) {
+        if (patterns[i].result == 0 && !patterns[i].bytes.empty() &&
+            patterns[i].bytes.size() <= size) {
+            pending.push_back(i);
+        }
+    }
+    if (pending.empty()) {
+        return;
+    }
+
+    // Anchor the patterns on bytes that are rare in this image.
+    Histogram histogram{};
+    u64 total{};
+    for (size_t i = 0; i < size; i += HistogramStride) {
+        ++histogram[data[i]];
+        ++total;
+    }
+
+    auto filter = std::make_unique<AnchorFilter>();
+    size_t remaining{};
+    for (const u32 index : pending) {
+        Pattern& pattern = patterns[index];
+        pattern.anchor = ChooseAnchor(pattern.mask, pattern.bytes, histogram, total);
+        if (pattern.anchor == NoAnchor) {
+            // Only wildcards, matches at the start of the image.
+            pattern.result = reinterpret_cast<uintptr_t>(data);
+            continue;
+        }
+        const u32 next = pattern.anchor + 1;
+        const bool has_pair = next < pattern.bytes.size() && pattern.mask[next] != 0;
+        filter->Add(index, pattern.bytes[pattern.anchor],
+                    has_pair ? std::optional<u8>{pattern.bytes[next]} : std::nullopt);
+        ++remaining;
+    }
+
+    const auto has_pair = [&](size_t pos) {
+        const u32 second = pos + 1 < size ? data[pos + 1] : 0;
+        return filter->HasPair(data[pos] | (second << 8));
+    };
+
+    // Checks the patterns anchored at the position, returns true once every pattern is found.
+    const auto check = [&](size_t pos) {
+        auto& candidates = filter->patterns[data[pos]];
+        for (size_t i = 0; i < candidates.size();) {
+            Pattern& pattern = patterns[candidates[i]];
+            if (pos < pattern.anchor || pos - pattern.anchor + pattern.bytes.size() > size ||
+                !pattern.Compare(data + pos - pattern.anchor)) {
+                ++i;
+                continue;
+            }
+            // Positions are visited in order, so this is the first match of the pattern.
+            pattern.result = reinterpret_cast<uintptr_t>(data + pos - pattern.anchor);
+            candidates[i] = candidates.back();
+            candidates.pop_back();
+            if (--remaining == 0) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    if (remaining == 0) {
+        return;
+    }
+
+    size_t pos = 0;
+#ifdef __AVX2__
+    const auto load_table = [](const std::array<u8, 16>& table) {
+        return _mm256_broadcastsi128_si256(
+            _mm_load_si128(reinterpret_cast<const __m128i*>(table.data())));
+    };
+    const __m256i lo_table = load_table(filter->lo_nibbles);
+    const __m256i hi_table = load_table(filter->hi_nibbles);
+    const __m256i second_lo_table = load_table(filter->second_lo_nibbles);
+    const __m256i second_hi_table = load_table(filter->second_hi_nibbles);
+    const __m256i nibble_mask = _mm256_set1_epi8(0xF);
+    const __m256i zero = _mm256_setzero_si256();
+    const auto classify = [&](const u8* src, __m256i lo_lut, __m256i hi_lut) {
+        const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+        const __m256i lo = _mm256_and_si256(bytes, nibble_mask);
+        const __m256i hi = _mm256_and_si256(_mm256_srli_epi16(bytes, 4), nibble_mask);
+        return _mm256_and_si256(_mm256_shuffle_epi8(lo_lut, lo), _mm256_shuffle_epi8(hi_lut, hi));
+    };
+    // The class test only helps while it rejects most positions. That holds for a few dozen
+    // patterns (about half the scalar time), with hundreds of patterns the eight classes cover
+    // nearly every byte and the pair bitmap alone is as fast. See shadps4-pattern-bench.
+    u64 passing{};
+    for (u32 byte = 0; byte < 256; ++byte) {
+        if ((filter->lo_nibbles[byte & 0xF] & filter->hi_nibbles[byte >> 4]) != 0) {
+            passing += histogram[byte];
+        }
+    }
+    const size_t simd_end = passing * 2 < total && size >= 33 ? size - 32 : 0;
+    // The second byte is loaded one position later, so keep a byte of slack at the end.
+    for (; pos < simd_end; pos += 32) {
+        const __m256i buckets =
+            _mm256_and_si256(classify(data + pos, lo_table, hi_table),
+                             classify(data + pos + 1, second_lo_table, second_hi_table));
+        u32 candidates = ~static_cast<u32>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(buckets, zero)));
+        while (candidates != 0) {
+            const size_t candidate = pos + std::countr_zero(candidates);
+            if (has_pair(candidate) && check(candidate)) {
+                return;
+            }
+            candidates &= candidates - 1;
+        }
+    }
+#endif
+    for (; pos < size; ++pos) {
+        if (has_pair(pos) && check(pos)) {
+            return;
+        }
+    }
+}
+
+} // namespace Common
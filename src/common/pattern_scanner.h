@@ -0,0 +1,64 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "common/types.h"
+
+namespace Common {
+
+/**
+ * Finds the first match of many byte signatures with a single pass over a memory image.
+ * Signatures are hex bytes separated by spaces, with ? or ?? for wildcard bytes.
+ * Every pattern is anchored on its rarest pair of adjacent fixed bytes. Positions are filtered on
+ * the anchor byte classes, 32 at a time with AVX2, then on the exact anchor pair before the full
+ * compare. The class test only pays off for small pattern sets: with a few hundred patterns the
+ * eight classes cover most byte values, the test would admit most of the image and is skipped,
+ * so large sets scan at the speed of the scalar pair lookup.
+ */
+class PatternScanner {
+public:
+    /// Adds a signature to search for and returns its index. Identical signatures share an index.
+    size_t AddPattern(std::string_view signature);
+
+    /// Searches the image for every pattern that doesn't have a match yet.
+    void Scan(std::span<const u8> image);
+
+    /// Returns the address of the first match of the pattern, or 0 if it hasn't been found.
+    [[nodiscard]] uintptr_t GetResult(size_t index) const {
+        return patterns[index].result;
+    }
+
+    /// Forgets the match of the pattern, so the next scan searches for it again.
+    void Reset(size_t index) {
+        patterns[index].result = 0;
+    }
+
+    /// Returns true if the memory at the address still holds the pattern.
+    [[nodiscard]] bool Matches(size_t index, uintptr_t address) const;
+
+    [[nodiscard]] size_t NumPatterns() const {
+        return patterns.size();
+    }
+
+private:
+    struct Pattern {
+        std::vector<u8> bytes; ///< Wildcard bytes are zero
+        std::vector<u8> mask;  ///< 0xFF for fixed bytes, zero for wildcards
+        u32 anchor{};
+        uintptr_t result{};
+
+        [[nodiscard]] bool Compare(const u8* data) const;
+    };
+
+    std::vector<Pattern> patterns;
+    std::unordered_map<std::string, size_t> indices;
+};
+
+} // namespace Common
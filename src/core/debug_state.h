@@ -146,6 +146,7 @@ class DebugStateImpl {
     std::atomic_int32_t gnm_frame_count = 0;
 
     s32 gnm_frame_dump_request_count = -1;
+    std::atomic_int32_t gnm_frame_capture_request_count = 0;
     std::unordered_map<size_t, FrameDump*> waiting_reg_dumps;
     std::unordered_map<size_t, std::string> waiting_reg_dumps_dbg;
     bool waiting_submit_pause = false;
@@ -215,6 +216,16 @@ public:
 
     void RequestFrameDump(s32 count = 1);
 
+    /// Requests a capture file of the next frames submitted to the GPU.
+    void RequestFrameCapture(s32 count = 1) {
+        gnm_frame_capture_request_count = count;
+    }
+
+    /// Returns the number of frames requested to be captured and clears the request.
+    s32 TakeFrameCaptureRequest() {
+        return gnm_frame_capture_request_count.exchange(0);
+    }
+
     FrameDump& GetFrameDump() {
         return frame_dump_list[frame_dump_list.size() - gnm_frame_dump_request_count];
     }
@@ -80,6 +80,9 @@ void L::DrawMenuBar() {
                 if (MenuItem("Dump", "Ctrl+Alt+F9", nullptr, !DebugState.DumpingCurrentFrame())) {
                     DebugState.RequestFrameDump(dump_frame_count);
                 }
+                if (MenuItem("Capture to file")) {
+                    DebugState.RequestFrameCapture(dump_frame_count);
+                }
                 ImGui::EndMenu();
             }
             open_popup_options = MenuItem("Options");
@@ -69,7 +69,7 @@ void MemoryMapViewer::Draw() {
     }
 
     auto mem = Memory::Instance();
-    std::scoped_lock lck{mem->mutex};
+    std::shared_lock lck{mem->mutex};
 
     {
         bool next_showing_vma = showing_vma;
@@ -14,6 +14,7 @@
 #include "core/debug_state.h"
 #include "core/devtools/options.h"
 #include "imgui/imgui_std.h"
+#include "shader_recompiler/pass_stats.h"
 #include "sdl_window.h"
 #include "video_core/renderer_vulkan/vk_presenter.h"
 #include "video_core/renderer_vulkan/vk_rasterizer.h"
@@ -227,6 +228,67 @@ bool ShaderList::Selection::DrawShader(DebugStateType::ShaderDump& value) {
     return open;
 }
 
+void ShaderList::DrawPassStatistics() {
+    if (!CollapsingHeader("Recompiler pass statistics")) {
+        return;
+    }
+
+    auto& stats = Shader::PassStatistics::Instance();
+    bool enabled = stats.IsEnabled();
+    if (Checkbox("Collect", &enabled)) {
+        stats.SetEnabled(enabled);
+    }
+    SameLine();
+    if (Button("Reset")) {
+        stats.Reset();
+    }
+    SameLine();
+    if (Button("Dump")) {
+        const auto path = Common::FS::GetUserPath(Common::FS::PathType::ShaderDir) /
+                          "pass_stats.json";
+        std::ofstream{path} << stats.ToJson();
+    }
+
+    const auto passes = stats.Snapshot();
+    if (passes.empty()) {
+        TextUnformatted("No shaders translated while collecting");
+        return;
+    }
+
+    constexpr ImGuiTableFlags flags =
+        ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingStretchProp;
+    if (!BeginTable("pass_stats", 7, flags)) {
+        return;
+    }
+    TableSetupColumn("Pass");
+    TableSetupColumn("Runs");
+    TableSetupColumn("Total ms");
+    TableSetupColumn("Avg us");
+    TableSetupColumn("Insts removed");
+    TableSetupColumn("Allocations");
+    TableSetupColumn("Heap allocations");
+    TableHeadersRow();
+    for (const auto& pass : passes) {
+        TableNextRow();
+        TableNextColumn();
+        TextUnformatted(pass.name.data(), pass.name.data() + pass.name.size());
+        TableNextColumn();
+        Text("%llu", static_cast<unsigned long long>(pass.runs));
+        TableNextColumn();
+        Text("%.3f", pass.time_ns / 1e6);
+        TableNextColumn();
+        Text("%.2f", pass.time_ns / 1e3 / pass.runs);
+        TableNextColumn();
+        Text("%lld", static_cast<long long>(pass.insts_before) -
+                         static_cast<long long>(pass.insts_after));
+        TableNextColumn();
+        Text("%llu", static_cast<unsigned long long>(pass.allocations));
+        TableNextColumn();
+        Text("%llu", static_cast<unsigned long long>(pass.heap_allocations));
+    }
+    EndTable();
+}
+
 void ShaderList::Draw() {
     for (auto it = open_shaders.begin(); it != open_shaders.end();) {
         auto& selection = *it;
@@ -244,6 +306,8 @@ void ShaderList::Draw() {
         return;
     }
 
+    DrawPassStatistics();
+
     if (!Config::collectShadersForDebug()) {
         DrawCenteredText("Enable 'CollectShader' in config to see shaders");
         End();
@@ -36,6 +36,8 @@ class ShaderList {
 
     char search_box[128]{};
 
+    void DrawPassStatistics();
+
 public:
     bool open = false;
 
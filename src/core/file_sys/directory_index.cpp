@@ -0,0 +1,100 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <mutex>
+#include <vector>
+
+#include "common/string_util.h"
+#include "core/file_sys/directory_index.h"
+
+namespace Core::FileSys {
+
+DirectoryIndex::DirectoryIndex(std::filesystem::path base_root_,
+                               std::filesystem::path patch_root_)
+    : base_root{std::move(base_root_)} {
+    if (std::filesystem::is_directory(patch_root_)) {
+        patch_root = std::move(patch_root_);
+    }
+}
+
+std::optional<std::filesystem::path> DirectoryIndex::Find(std::string_view rel_path,
+                                                          bool use_patch) {
+    std::vector<std::string> parts;
+    for (size_t begin = 0; begin < rel_path.size();) {
+        const size_t end = std::min(rel_path.find('/', begin), rel_path.size());
+        if (end > begin) {
+            parts.emplace_back(rel_path.substr(begin, end - begin));
+        }
+        begin = end + 1;
+    }
+
+    while (true) {
+        std::optional<std::filesystem::path> base_dir = base_root;
+        std::optional<std::filesystem::path> patch_dir = patch_root;
+        std::string key;
+        bool listed = true;
+        {
+            std::shared_lock lk{mutex};
+            for (const auto& part : parts) {
+                const auto dir_it = directories.find(key);
+                if (dir_it == directories.end()) {
+                    listed = false;
+                    break;
+                }
+                const auto folded = Common::ToLower(part);
+                const auto entry_it = dir_it->second.find(folded);
+                if (entry_it == dir_it->second.end()) {
+                    return std::nullopt;
+                }
+                const Entry& entry = entry_it->second;
+                base_dir = entry.base_name.empty() ? std::nullopt
+                                                   : std::optional{*base_dir / entry.base_name};
+                patch_dir = entry.patch_name.empty()
+                                ? std::nullopt
+                                : std::optional{*patch_dir / entry.patch_name};
+                key += '/';
+                key += folded;
+            }
+        }
+        if (listed) {
+            if (use_patch && patch_dir) {
+                return patch_dir;
+            }
+            return base_dir;
+        }
+
+        // List the directory without holding the lock, then retry the lookup.
+        auto directory = List(base_dir, patch_dir);
+        std::unique_lock lk{mutex};
+        if (num_entries + directory.size() > MaxEntries) {
+            directories.clear();
+            num_entries = 0;
+        }
+        const size_t size = directory.size();
+        if (directories.try_emplace(std::move(key), std::move(directory)).second) {
+            num_entries += size;
+        }
+    }
+}
+
+DirectoryIndex::Directory DirectoryIndex::List(
+    const std::optional<std::filesystem::path>& base_dir,
+    const std::optional<std::filesystem::path>& patch_dir) {
+    Directory directory;
+    const auto add_layer = [&](const std::filesystem::path& dir, std::string Entry::* name) {
+        std::error_code ec;
+        for (const auto& item : std::filesystem::directory_iterator(dir, ec)) {
+            auto host_name = item.path().filename().string();
+            directory[Common::ToLower(host_name)].*name = std::move(host_name);
+        }
+    };
+    if (base_dir) {
+        add_layer(*base_dir, &Entry::base_name);
+    }
+    if (patch_dir) {
+        add_layer(*patch_dir, &Entry::patch_name);
+    }
+    return directory;
+}
+
+} // namespace Core::FileSys
@@ -0,0 +1,51 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <filesystem>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <tsl/robin_map.h>
+
+namespace Core::FileSys {
+
+/**
+ * Case-insensitive index of the files of a mount whose contents never change, with the base
+ * folder and its update overlay merged into one listing per directory. Directories are listed
+ * the first time a path goes through them, later lookups are hash probes under a shared lock.
+ * Names that aren't in a listing are not remembered, the caller falls back to the filesystem.
+ */
+class DirectoryIndex {
+public:
+    explicit DirectoryIndex(std::filesystem::path base_root, std::filesystem::path patch_root);
+
+    /// Returns the host path of a path relative to the mount, or nullopt if it isn't indexed.
+    /// The overlay is preferred over the base folder when use_patch is set.
+    std::optional<std::filesystem::path> Find(std::string_view rel_path, bool use_patch);
+
+private:
+    /// Host names of an entry in each layer, empty if the layer doesn't have it.
+    struct Entry {
+        std::string base_name;
+        std::string patch_name;
+    };
+    /// Entries of a directory indexed by case-folded name.
+    using Directory = tsl::robin_map<std::string, Entry>;
+
+    /// Upper bound of indexed entries, the index starts over when it would grow past it.
+    static constexpr size_t MaxEntries = 1 << 20;
+
+    static Directory List(const std::optional<std::filesystem::path>& base_dir,
+                          const std::optional<std::filesystem::path>& patch_dir);
+
+    std::filesystem::path base_root;
+    std::optional<std::filesystem::path> patch_root;
+    std::shared_mutex mutex;
+    tsl::robin_map<std::string, Directory> directories; ///< Indexed by case-folded relative path
+    size_t num_entries{};
+};
+
+} // namespace Core::FileSys
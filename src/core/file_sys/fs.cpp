@@ -23,9 +23,25 @@ std::string RemoveTrailingSlashes(const std::string& path) {
 
 void MntPoints::Mount(const std::filesystem::path& host_folder, const std::string& guest_folder,
                       bool read_only) {
-    std::scoped_lock lock{m_mutex};
+    // Probe the overlay directory once here instead of on every path lookup.
+    std::filesystem::path patch_path = host_folder;
+    patch_path += "-UPDATE";
+    if (!std::filesystem::exists(patch_path)) {
+        patch_path = host_folder;
+        patch_path += "-patch";
+    }
+
+    // Game folders never change while mounted, index them instead of probing the filesystem.
     const auto guest_folder_sanitized = RemoveTrailingSlashes(guest_folder);
-    m_mnt_pairs.emplace_back(host_folder, guest_folder_sanitized, read_only);
+    std::shared_ptr<DirectoryIndex> index;
+    if (read_only && (guest_folder_sanitized == "/app0" || guest_folder_sanitized == "/hostapp")) {
+        index = std::make_shared<DirectoryIndex>(host_folder, patch_path);
+    }
+
+    std::scoped_lock lock{m_mutex};
+    m_mnt_pairs.emplace_back(host_folder, guest_folder_sanitized, read_only, patch_path,
+                             std::move(index));
+    InvalidateCaches();
 }
 
 void MntPoints::Unmount(const std::filesystem::path& host_folder, const std::string& guest_folder) {
@@ -35,11 +51,18 @@ void MntPoints::Unmount(const std::filesystem::path& host_folder, const std::str
         return pair.mount == guest_folder_sanitized;
     });
     m_mnt_pairs.erase(it, m_mnt_pairs.end());
+    InvalidateCaches();
 }
 
 void MntPoints::UnmountAll() {
     std::scoped_lock lock{m_mutex};
     m_mnt_pairs.clear();
+    InvalidateCaches();
+}
+
+void MntPoints::InvalidateCaches() {
+    std::scoped_lock lk{m_cache_mutex};
+    path_cache.clear();
 }
 
 std::filesystem::path MntPoints::GetHostPath(std::string_view path, bool* is_read_only,
@@ -72,17 +95,26 @@ std::filesystem::path MntPoints::GetHostPath(std::string_view path, bool* is_rea
 
     // Remove device (e.g /app0) from path to retrieve relative path.
     const auto rel_path = std::string_view{corrected_path}.substr(mount->mount.size() + 1);
-    std::filesystem::path host_path = mount->host_path / rel_path;
-    std::filesystem::path patch_path = mount->host_path;
-    patch_path += "-UPDATE";
-    if (!std::filesystem::exists(patch_path)) {
-        patch_path = mount->host_path;
-        patch_path += "-patch";
+    const bool is_app_path =
+        corrected_path.starts_with("/app0") || corrected_path.starts_with("/hostapp");
+
+    // Names missing from the index are resolved through the filesystem every time.
+    if (mount->index) {
+        const bool use_patch = is_app_path && !force_base_path && !ignore_game_patches;
+        if (auto host_path = mount->index->Find(rel_path, use_patch)) {
+            return *std::move(host_path);
+        }
     }
-    patch_path /= rel_path;
+    return ResolveHostPath(mount, rel_path, is_app_path, force_base_path);
+}
+
+std::filesystem::path MntPoints::ResolveHostPath(const MntPair* mount, std::string_view rel_path,
+                                                 bool is_app_path, bool force_base_path) {
+    std::filesystem::path host_path = mount->host_path / rel_path;
+    const std::filesystem::path patch_path = mount->patch_path / rel_path;
 
-    if ((corrected_path.starts_with("/app0") || corrected_path.starts_with("/hostapp")) &&
-        !force_base_path && !ignore_game_patches && std::filesystem::exists(patch_path)) {
+    if (is_app_path && !force_base_path && !ignore_game_patches &&
+        std::filesystem::exists(patch_path)) {
         return patch_path;
     }
 
@@ -93,7 +125,7 @@ std::filesystem::path MntPoints::GetHostPath(std::string_view path, bool* is_rea
     const auto search = [&](const auto host_path) {
         // If the path does not exist attempt to verify this.
         // Retrieve parent path until we find one that exists.
-        std::scoped_lock lk{m_mutex};
+        std::scoped_lock lk{m_cache_mutex};
         path_parts.clear();
         auto current_path = host_path;
         while (!std::filesystem::exists(current_path)) {
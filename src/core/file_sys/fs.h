@@ -4,12 +4,14 @@
 #pragma once
 
 #include <atomic>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <vector>
 #include <tsl/robin_map.h>
 #include "common/io_file.h"
 #include "common/logging/formatter.h"
+#include "core/file_sys/directory_index.h"
 #include "core/file_sys/devices/base_device.h"
 #include "core/file_sys/directories/base_directory.h"
 
@@ -33,6 +35,8 @@ public:
         std::filesystem::path host_path;
         std::string mount; // e.g /app0
         bool read_only;
+        std::filesystem::path patch_path{}; // Overlay root, e.g <host_path>-UPDATE
+        std::shared_ptr<DirectoryIndex> index{}; // Only for the immutable game folder mounts
     };
 
     explicit MntPoints() = default;
@@ -69,10 +73,15 @@ public:
     }
 
 private:
+    std::filesystem::path ResolveHostPath(const MntPair* mount, std::string_view rel_path,
+                                          bool is_app_path, bool force_base_path);
+    void InvalidateCaches();
+
     std::vector<MntPair> m_mnt_pairs;
     std::vector<std::filesystem::path> path_parts;
     tsl::robin_map<std::filesystem::path, std::filesystem::path> path_cache;
     std::mutex m_mutex;
+    std::mutex m_cache_mutex;
 };
 
 enum class FileType {
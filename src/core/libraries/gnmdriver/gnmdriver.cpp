@@ -9,6 +9,7 @@
 #include "common/debug.h"
 #include "common/elf_info.h"
 #include "common/logging/log.h"
+#include "common/path_util.h"
 #include "common/slot_vector.h"
 #include "core/address_space.h"
 #include "core/debug_state.h"
@@ -2287,6 +2288,12 @@ int PS4_SYSV_ABI sceGnmSubmitDone() {
     send_init_packet = true;
     ++frames_submitted;
     DebugState.IncGnmFrameNum();
+    if (const s32 num_frames = DebugState.TakeFrameCaptureRequest(); num_frames > 0) {
+        const auto& captures_dir = Common::FS::GetUserPath(Common::FS::PathType::CapturesDir);
+        const auto serial = Common::ElfInfo::Instance().GameSerial();
+        const auto filename = fmt::format("{}_{}.pm4cap", serial, frames_submitted);
+        liverpool->StartCapture(num_frames, captures_dir / filename);
+    }
     return ORBIS_OK;
 }
 
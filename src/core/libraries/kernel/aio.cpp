@@ -1,12 +1,21 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <span>
 #include <thread>
+#include <vector>
 
 #include "aio.h"
 #include "common/assert.h"
 #include "common/debug.h"
 #include "common/logging/log.h"
+#include "common/polyfill_thread.h"
+#include "common/thread.h"
 #include "core/libraries/kernel/equeue.h"
 #include "core/libraries/kernel/orbis_error.h"
 #include "core/libraries/libs.h"
@@ -16,8 +25,165 @@ namespace Libraries::Kernel {
 
 #define MAX_QUEUE 512
 
-static s32* id_state;
-static s32 id_index;
+static constexpr u32 NumAioWorkers = 4;
+
+/// A group of requests sharing one submit id.
+struct AioBatch {
+    OrbisKernelAioSubmitId id;
+    std::atomic<s32> remaining;
+    std::atomic<bool> failed;
+    bool report_errors; ///< Whether a failed request aborts the whole id.
+};
+
+/// A single read or write executed by one of the workers.
+struct AioWork {
+    OrbisKernelAioRWRequest request;
+    std::shared_ptr<AioBatch> batch;
+    s32 prio;
+    u64 sequence;
+    bool is_write;
+};
+
+struct AioWorkCompare {
+    bool operator()(const AioWork& lhs, const AioWork& rhs) const {
+        // Higher priority first, then in submission order.
+        if (lhs.prio != rhs.prio) {
+            return lhs.prio < rhs.prio;
+        }
+        return lhs.sequence > rhs.sequence;
+    }
+};
+
+static std::array<std::atomic<s32>, MAX_QUEUE> id_state;
+static std::array<bool, MAX_QUEUE> id_busy; ///< Ids whose requests haven't all finished
+static s32 id_index = 1;
+static u64 work_sequence;
+static std::vector<AioWork> work_queue;
+static std::mutex aio_mutex;
+static std::condition_variable_any work_cv;
+static std::condition_variable complete_cv;
+static std::array<std::jthread, NumAioWorkers> aio_workers;
+
+/// Returns an id that no request in flight uses, waiting for one to finish if all are taken.
+static OrbisKernelAioSubmitId AllocateId(std::unique_lock<std::mutex>& lk) {
+    while (true) {
+        for (s32 i = 1; i < MAX_QUEUE; i++) {
+            const OrbisKernelAioSubmitId id = id_index;
+            id_index = (id_index + 1) % MAX_QUEUE;
+            // skip id_index equals 0 , because sceKernelAioCancelRequest will submit id
+            // equal to 0
+            if (!id_index) {
+                id_index++;
+            }
+            if (!id_busy[id]) {
+                id_busy[id] = true;
+                id_state[id] = ORBIS_KERNEL_AIO_STATE_PROCESSING;
+                return id;
+            }
+        }
+        // Requests queued by this call may hold the ids, make sure the workers see them.
+        work_cv.notify_all();
+        complete_cv.wait(lk);
+    }
+}
+
+static void CompleteWork(const AioWork& work) {
+    auto& batch = *work.batch;
+    if (batch.remaining.fetch_sub(1) != 1) {
+        return;
+    }
+    const s32 state = batch.report_errors && batch.failed ? ORBIS_KERNEL_AIO_STATE_ABORTED
+                                                          : ORBIS_KERNEL_AIO_STATE_COMPLETED;
+    std::scoped_lock lk{aio_mutex};
+    // Requests cancelled while in flight keep their aborted state.
+    s32 expected = ORBIS_KERNEL_AIO_STATE_PROCESSING;
+    id_state[batch.id].compare_exchange_strong(expected, state);
+    id_busy[batch.id] = false;
+    complete_cv.notify_all();
+}
+
+static void ExecuteWork(const AioWork& work) {
+    const auto& req = work.request;
+    if (id_state[work.batch->id] == ORBIS_KERNEL_AIO_STATE_ABORTED) {
+        req.result->state = ORBIS_KERNEL_AIO_STATE_ABORTED;
+        CompleteWork(work);
+        return;
+    }
+
+    req.result->state = ORBIS_KERNEL_AIO_STATE_PROCESSING;
+    // Reads don't share the seek position, so requests against one file run on all workers.
+    const s64 ret = work.is_write ? sceKernelPwrite(req.fd, req.buf, req.nbyte, req.offset)
+                                  : ReadFileAt(req.fd, req.buf, req.nbyte, req.offset);
+    req.result->returnValue = ret;
+    if (ret < 0) {
+        req.result->state = ORBIS_KERNEL_AIO_STATE_ABORTED;
+        work.batch->failed = true;
+    } else {
+        req.result->state = ORBIS_KERNEL_AIO_STATE_COMPLETED;
+    }
+    CompleteWork(work);
+}
+
+static void AioWorkerThread(std::stop_token stoken) {
+    Common::SetCurrentThreadName("shadPS4:AioWorker");
+
+    while (!stoken.stop_requested()) {
+        AioWork work;
+        {
+            std::unique_lock lk{aio_mutex};
+            Common::CondvarWait(work_cv, lk, stoken, [] { return !work_queue.empty(); });
+            if (stoken.stop_requested()) {
+                break;
+            }
+            std::ranges::pop_heap(work_queue, AioWorkCompare{});
+            work = std::move(work_queue.back());
+            work_queue.pop_back();
+        }
+        ExecuteWork(work);
+    }
+}
+
+static void SubmitCommands(OrbisKernelAioRWRequest req[], s32 size, s32 prio,
+                           OrbisKernelAioSubmitId id[], bool multiple, bool is_write) {
+    std::unique_lock lk{aio_mutex};
+    const auto enqueue = [&](const OrbisKernelAioRWRequest& request,
+                             const std::shared_ptr<AioBatch>& batch) {
+        request.result->state = ORBIS_KERNEL_AIO_STATE_SUBMITTED;
+        // The request array may live on the guest stack, so keep a copy of it.
+        work_queue.emplace_back(request, batch, prio, work_sequence++, is_write);
+        std::ranges::push_heap(work_queue, AioWorkCompare{});
+    };
+
+    if (multiple) {
+        for (s32 i = 0; i < size; i++) {
+            id[i] = AllocateId(lk);
+            auto batch = std::make_shared<AioBatch>(id[i], 1, false, true);
+            enqueue(req[i], batch);
+        }
+    } else {
+        *id = AllocateId(lk);
+        if (size <= 0) {
+            id_state[*id] = ORBIS_KERNEL_AIO_STATE_COMPLETED;
+            id_busy[*id] = false;
+            return;
+        }
+        auto batch = std::make_shared<AioBatch>(*id, size, false, false);
+        for (s32 i = 0; i < size; i++) {
+            enqueue(req[i], batch);
+        }
+    }
+    lk.unlock();
+    work_cv.notify_all();
+}
+
+static bool WaitForRequests(const u32* usec, auto&& pred) {
+    std::unique_lock lk{aio_mutex};
+    if (usec == nullptr || *usec == 0) {
+        complete_cv.wait(lk, pred);
+        return true;
+    }
+    return complete_cv.wait_for(lk, std::chrono::microseconds(*usec), pred);
+}
 
 s32 PS4_SYSV_ABI sceKernelAioInitializeImpl(void* p, s32 size) {
 
@@ -96,25 +262,13 @@ s32 PS4_SYSV_ABI sceKernelAioWaitRequest(OrbisKernelAioSubmitId id, s32* state,
     if (state == nullptr) {
         return ORBIS_KERNEL_ERROR_EFAULT;
     }
-    u32 timer = 0;
-
-    s32 timeout = 0;
 
-    while (id_state[id] == ORBIS_KERNEL_AIO_STATE_PROCESSING) {
-        sceKernelUsleep(10);
-
-        timer += 10;
-        if (*usec) {
-            if (timer > *usec) {
-                timeout = 1;
-                break;
-            }
-        }
-    }
+    const bool done = WaitForRequests(
+        usec, [&] { return id_state[id] != ORBIS_KERNEL_AIO_STATE_PROCESSING; });
 
     *state = id_state[id];
 
-    if (timeout)
+    if (!done)
         return ORBIS_KERNEL_ERROR_ETIMEDOUT;
     return 0;
 }
@@ -124,34 +278,21 @@ s32 PS4_SYSV_ABI sceKernelAioWaitRequests(OrbisKernelAioSubmitId id[], s32 num,
     if (state == nullptr) {
         return ORBIS_KERNEL_ERROR_EFAULT;
     }
-    u32 timer = 0;
-    s32 timeout = 0;
-    s32 completion = 0;
 
-    for (s32 i = 0; i < num; i++) {
-        if (!completion && !timeout) {
-            while (id_state[id[i]] == ORBIS_KERNEL_AIO_STATE_PROCESSING) {
-                sceKernelUsleep(10);
-                timer += 10;
-
-                if (*usec) {
-                    if (timer > *usec) {
-                        timeout = 1;
-                        break;
-                    }
-                }
-            }
-        }
-
-        if (mode == 0x02) {
-            if (id_state[id[i]] == ORBIS_KERNEL_AIO_STATE_COMPLETED)
-                completion = 1;
-        }
+    const std::span ids{id, static_cast<size_t>(num)};
+    const auto is_done = [](OrbisKernelAioSubmitId i) {
+        return id_state[i] != ORBIS_KERNEL_AIO_STATE_PROCESSING;
+    };
+    const bool done = WaitForRequests(usec, [&] {
+        // Mode 0x02 returns as soon as any request finished, otherwise wait for all of them.
+        return mode == 0x02 ? std::ranges::any_of(ids, is_done) : std::ranges::all_of(ids, is_done);
+    });
 
+    for (s32 i = 0; i < num; i++) {
         state[i] = id_state[id[i]];
     }
 
-    if (timeout)
+    if (!done)
         return ORBIS_KERNEL_ERROR_ETIMEDOUT;
 
     return 0;
@@ -165,31 +306,7 @@ s32 PS4_SYSV_ABI sceKernelAioSubmitReadCommands(OrbisKernelAioRWRequest req[], s
     if (id == nullptr) {
         return ORBIS_KERNEL_ERROR_EFAULT;
     }
-    id_state[id_index] = ORBIS_KERNEL_AIO_STATE_PROCESSING;
-
-    for (s32 i = 0; i < size; i++) {
-
-        s64 ret = sceKernelPread(req[i].fd, req[i].buf, req[i].nbyte, req[i].offset);
-
-        if (ret < 0) {
-            req[i].result->state = ORBIS_KERNEL_AIO_STATE_ABORTED;
-            req[i].result->returnValue = ret;
-
-        } else {
-            req[i].result->state = ORBIS_KERNEL_AIO_STATE_COMPLETED;
-            req[i].result->returnValue = ret;
-        }
-    }
-
-    id_state[id_index] = ORBIS_KERNEL_AIO_STATE_COMPLETED;
-
-    *id = id_index;
-
-    id_index = (id_index + 1) % MAX_QUEUE;
-
-    if (!id_index)
-        id_index++;
-
+    SubmitCommands(req, size, prio, id, false, false);
     return 0;
 }
 
@@ -201,32 +318,7 @@ s32 PS4_SYSV_ABI sceKernelAioSubmitReadCommandsMultiple(OrbisKernelAioRWRequest
     if (id == nullptr) {
         return ORBIS_KERNEL_ERROR_EFAULT;
     }
-    for (s32 i = 0; i < size; i++) {
-        id_state[id_index] = ORBIS_KERNEL_AIO_STATE_PROCESSING;
-
-        s64 ret = sceKernelPread(req[i].fd, req[i].buf, req[i].nbyte, req[i].offset);
-
-        if (ret < 0) {
-            req[i].result->state = ORBIS_KERNEL_AIO_STATE_ABORTED;
-            req[i].result->returnValue = ret;
-
-            id_state[id_index] = ORBIS_KERNEL_AIO_STATE_ABORTED;
-
-        } else {
-            req[i].result->state = ORBIS_KERNEL_AIO_STATE_COMPLETED;
-            req[i].result->returnValue = ret;
-
-            id_state[id_index] = ORBIS_KERNEL_AIO_STATE_COMPLETED;
-        }
-
-        id[i] = id_index;
-
-        id_index = (id_index + 1) % MAX_QUEUE;
-
-        if (!id_index)
-            id_index++;
-    }
-
+    SubmitCommands(req, size, prio, id, true, false);
     return 0;
 }
 
@@ -238,34 +330,7 @@ s32 PS4_SYSV_ABI sceKernelAioSubmitWriteCommands(OrbisKernelAioRWRequest req[],
     if (id == nullptr) {
         return ORBIS_KERNEL_ERROR_EFAULT;
     }
-    for (s32 i = 0; i < size; i++) {
-        id_state[id_index] = ORBIS_KERNEL_AIO_STATE_PROCESSING;
-
-        s64 ret = sceKernelPwrite(req[i].fd, req[i].buf, req[i].nbyte, req[i].offset);
-
-        if (ret < 0) {
-            req[i].result->state = ORBIS_KERNEL_AIO_STATE_ABORTED;
-            req[i].result->returnValue = ret;
-
-            id_state[id_index] = ORBIS_KERNEL_AIO_STATE_ABORTED;
-
-        } else {
-            req[i].result->state = ORBIS_KERNEL_AIO_STATE_COMPLETED;
-            req[i].result->returnValue = ret;
-
-            id_state[id_index] = ORBIS_KERNEL_AIO_STATE_COMPLETED;
-        }
-    }
-
-    *id = id_index;
-
-    id_index = (id_index + 1) % MAX_QUEUE;
-
-    // skip id_index equals 0 , because sceKernelAioCancelRequest will submit id
-    // equal to 0
-    if (!id_index)
-        id_index++;
-
+    SubmitCommands(req, size, prio, id, false, true);
     return 0;
 }
 
@@ -277,28 +342,7 @@ s32 PS4_SYSV_ABI sceKernelAioSubmitWriteCommandsMultiple(OrbisKernelAioRWRequest
     if (id == nullptr) {
         return ORBIS_KERNEL_ERROR_EFAULT;
     }
-    for (s32 i = 0; i < size; i++) {
-        id_state[id_index] = ORBIS_KERNEL_AIO_STATE_PROCESSING;
-        s64 ret = sceKernelPwrite(req[i].fd, req[i].buf, req[i].nbyte, req[i].offset);
-
-        if (ret < 0) {
-            req[i].result->state = ORBIS_KERNEL_AIO_STATE_ABORTED;
-            req[i].result->returnValue = ret;
-
-            id_state[id_index] = ORBIS_KERNEL_AIO_STATE_ABORTED;
-
-        } else {
-            req[i].result->state = ORBIS_KERNEL_AIO_STATE_COMPLETED;
-            req[i].result->returnValue = ret;
-            id_state[id_index] = ORBIS_KERNEL_AIO_STATE_COMPLETED;
-        }
-
-        id[i] = id_index;
-        id_index = (id_index + 1) % MAX_QUEUE;
-
-        if (!id_index)
-            id_index++;
-    }
+    SubmitCommands(req, size, prio, id, true, true);
     return 0;
 }
 
@@ -313,9 +357,11 @@ s32 PS4_SYSV_ABI sceKernelAioInitializeParam() {
 }
 
 void RegisterAio(Core::Loader::SymbolsResolver* sym) {
-    id_index = 1;
-    id_state = (int*)malloc(sizeof(int) * MAX_QUEUE);
-    memset(id_state, 0, sizeof(sizeof(int) * MAX_QUEUE));
+    for (auto& worker : aio_workers) {
+        if (!worker.joinable()) {
+            worker = std::jthread{AioWorkerThread};
+        }
+    }
 
     LIB_FUNCTION("fR521KIGgb8", "libkernel", 1, "libkernel", sceKernelAioCancelRequest);
     LIB_FUNCTION("3Lca1XBrQdY", "libkernel", 1, "libkernel", sceKernelAioCancelRequests);
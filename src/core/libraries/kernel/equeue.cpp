@@ -1,6 +1,7 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
 #include <thread>
 
 #include "common/assert.h"
@@ -8,15 +9,35 @@
 #include "common/logging/log.h"
 #include "core/libraries/kernel/equeue.h"
 #include "core/libraries/kernel/orbis_error.h"
+#include "core/libraries/kernel/timer_wheel.h"
 #include "core/libraries/libs.h"
 
 namespace Libraries::Kernel {
 
-extern boost::asio::io_context io_context;
-extern void KernelSignalRequest();
-
 static constexpr auto HrTimerSpinlockThresholdUs = 1200u;
 
+// Small timers sleep on the queue condition variable and only spin for the final stretch.
+static constexpr auto SmallTimerSpinThreshold = std::chrono::microseconds{200};
+
+static TimerWheel& GetTimerWheel() {
+    static TimerWheel timer_wheel;
+    return timer_wheel;
+}
+
+EqueueInternal::~EqueueInternal() {
+    // Make sure no timer callback referencing this queue runs after it is gone. Callbacks that
+    // are running stop rescheduling once the queue is closed, pending timers are dropped and
+    // callbacks of timers that already expired, including removed ones, are waited for.
+    {
+        std::scoped_lock lock{m_mutex};
+        m_closing = true;
+        for (auto& [key, event] : m_events) {
+            CancelTimer(event);
+        }
+    }
+    GetTimerWheel().WaitForCallbacks();
+}
+
 // Events are uniquely identified by id and filter.
 
 bool EqueueInternal::AddEvent(EqueueEvent& event) {
@@ -32,12 +53,12 @@ bool EqueueInternal::AddEvent(EqueueEvent& event) {
         event.timer_interval = std::chrono::microseconds(event.event.data - offset);
     }
 
-    const auto& it = std::ranges::find(m_events, event);
-    if (it != m_events.cend()) {
-        *it = std::move(event);
-    } else {
-        m_events.emplace_back(std::move(event));
+    const EventKey key{event.event.ident, event.event.filter};
+    if (const auto it = m_events.find(key); it != m_events.end()) {
+        CancelTimer(it->second);
+        m_events.erase(it);
     }
+    m_events.emplace(key, std::move(event));
 
     return true;
 }
@@ -45,62 +66,58 @@ bool EqueueInternal::AddEvent(EqueueEvent& event) {
 bool EqueueInternal::ScheduleEvent(u64 id, s16 filter,
                                    void (*callback)(SceKernelEqueue, const SceKernelEvent&)) {
     std::scoped_lock lock{m_mutex};
+    if (m_closing) {
+        return false;
+    }
 
-    const auto& it = std::ranges::find_if(m_events, [id, filter](auto& ev) {
-        return ev.event.ident == id && ev.event.filter == filter;
-    });
-    if (it == m_events.cend()) {
+    const auto it = m_events.find({id, filter});
+    if (it == m_events.end()) {
         return false;
     }
 
-    const auto& event = *it;
+    auto& event = it->second;
     ASSERT(event.event.filter == SceKernelEvent::Filter::Timer ||
            event.event.filter == SceKernelEvent::Filter::HrTimer);
 
-    if (!it->timer) {
-        it->timer = std::make_unique<boost::asio::steady_timer>(io_context, event.timer_interval);
+    if (event.timer_handle == 0) {
+        event.timer_expiry = std::chrono::steady_clock::now() + event.timer_interval;
     } else {
         // If the timer already exists we are scheduling a reoccurrence after the next period.
         // Set the expiration time to the previous occurrence plus the period.
-        it->timer->expires_at(it->timer->expiry() + event.timer_interval);
-    }
-
-    it->timer->async_wait(
-        [this, event_data = event.event, callback](const boost::system::error_code& ec) {
-            if (ec) {
-                if (ec != boost::system::errc::operation_canceled) {
-                    LOG_ERROR(Kernel_Event, "Timer callback error: {}", ec.message());
-                } else {
-                    // Timer was cancelled (removed) before it triggered
-                    LOG_DEBUG(Kernel_Event, "Timer cancelled");
-                }
-                return;
-            }
-            callback(this, event_data);
-        });
-    KernelSignalRequest();
+        event.timer_expiry += event.timer_interval;
+    }
+
+    event.timer_handle = GetTimerWheel().Schedule(
+        event.timer_expiry,
+        [this, event_data = event.event, callback] { callback(this, event_data); });
 
     return true;
 }
 
 bool EqueueInternal::RemoveEvent(u64 id, s16 filter) {
-    bool has_found = false;
     std::scoped_lock lock{m_mutex};
 
-    const auto& it = std::ranges::find_if(m_events, [id, filter](auto& ev) {
-        return ev.event.ident == id && ev.event.filter == filter;
-    });
-    if (it != m_events.cend()) {
-        m_events.erase(it);
-        has_found = true;
+    const auto it = m_events.find({id, filter});
+    if (it == m_events.end()) {
+        return false;
+    }
+    CancelTimer(it->second);
+    m_events.erase(it);
+    return true;
+}
+
+void EqueueInternal::CancelTimer(EqueueEvent& event) {
+    if (event.timer_handle != 0) {
+        GetTimerWheel().Cancel(event.timer_handle);
+        event.timer_handle = 0;
     }
-    return has_found;
 }
 
 int EqueueInternal::WaitForEvents(SceKernelEvent* ev, int num, const SceKernelUseconds* timo) {
     if (timo != nullptr && *timo == 0) {
         // Effectively acts as a poll; only events that have already
         // arrived at the time of this function call can be received
+        std::scoped_lock lock{m_mutex};
         return GetTriggeredEvents(ev, num);
     }
     const auto micros = timo ? *timo : 0u;
@@ -117,6 +134,7 @@ int EqueueInternal::WaitForEvents(SceKernelEvent* ev, int num, const SceKernelUs
         return count > 0;
     };
 
+    const auto wait_start = std::chrono::steady_clock::now();
     if (micros == 0) {
         // Wait indefinitely for events
         std::unique_lock lock{m_mutex};
@@ -130,7 +148,7 @@ int EqueueInternal::WaitForEvents(SceKernelEvent* ev, int num, const SceKernelUs
     if (HasSmallTimer()) {
         if (count > 0) {
             const auto time_waited = std::chrono::duration_cast<std::chrono::microseconds>(
-                                         std::chrono::steady_clock::now() - m_events[0].time_added)
+                                         std::chrono::steady_clock::now() - wait_start)
                                          .count();
             count = WaitForSmallTimer(ev, num, std::max(0l, long(micros - time_waited)));
         }
@@ -140,49 +158,45 @@ int EqueueInternal::WaitForEvents(SceKernelEvent* ev, int num, const SceKernelUs
 }
 
 bool EqueueInternal::TriggerEvent(u64 ident, s16 filter, void* trigger_data) {
-    bool has_found = false;
     {
         std::scoped_lock lock{m_mutex};
-        for (auto& event : m_events) {
-            if (event.event.ident == ident && event.event.filter == filter) {
-                if (filter == SceKernelEvent::Filter::VideoOut) {
-                    event.TriggerDisplay(trigger_data);
-                } else if (filter == SceKernelEvent::Filter::User) {
-                    event.TriggerUser(trigger_data);
-                } else {
-                    event.Trigger(trigger_data);
-                }
-                has_found = true;
-            }
+        const auto it = m_events.find({ident, filter});
+        if (it == m_events.end()) {
+            return false;
+        }
+        auto& event = it->second;
+        if (filter == SceKernelEvent::Filter::VideoOut) {
+            event.TriggerDisplay(trigger_data);
+        } else if (filter == SceKernelEvent::Filter::User) {
+            event.TriggerUser(trigger_data);
+        } else {
+            event.Trigger(trigger_data);
+        }
+        if (!event.is_linked()) {
+            m_ready.push_back(event);
         }
     }
-    m_cond.notify_one();
-    return has_found;
+    // Small timer waits sleep on the same condition variable, wake every waiter.
+    m_cond.notify_all();
+    return true;
 }
 
 int EqueueInternal::GetTriggeredEvents(SceKernelEvent* ev, int num) {
     int count = 0;
-    for (auto it = m_events.begin(); it != m_events.end();) {
-        if (it->IsTriggered()) {
-            ev[count++] = it->event;
-
-            // Event should not trigger again
-            it->ResetTriggerState();
+    while (!m_ready.empty() && count < num) {
+        auto& event = m_ready.front();
+        m_ready.pop_front();
+        ev[count++] = event.event;
 
-            if (it->event.flags & SceKernelEvent::Flags::Clear) {
-                it->Clear();
-            }
-            if (it->event.flags & SceKernelEvent::Flags::OneShot) {
-                it = m_events.erase(it);
-            } else {
-                ++it;
-            }
+        // Event should not trigger again
+        event.ResetTriggerState();
 
-            if (count == num) {
-                break;
-            }
-        } else {
-            ++it;
+        if (event.event.flags & SceKernelEvent::Flags::Clear) {
+            event.Clear();
+        }
+        if (event.event.flags & SceKernelEvent::Flags::OneShot) {
+            CancelTimer(event);
+            m_events.erase({event.event.ident, event.event.filter});
         }
     }
 
@@ -198,48 +212,59 @@ bool EqueueInternal::AddSmallTimer(EqueueEvent& ev) {
         std::scoped_lock lock{m_mutex};
         m_small_timers[st.event.ident] = std::move(st);
     }
+    m_cond.notify_all();
     return true;
 }
 
 int EqueueInternal::WaitForSmallTimer(SceKernelEvent* ev, int num, u32 micros) {
     ASSERT(num >= 1);
 
-    auto curr_clock = std::chrono::steady_clock::now();
-    const auto wait_end_us = (micros == 0) ? std::chrono::steady_clock::time_point::max()
-                                           : curr_clock + std::chrono::microseconds{micros};
-    int count = 0;
-    do {
-        curr_clock = std::chrono::steady_clock::now();
-        {
-            std::scoped_lock lock{m_mutex};
-            for (auto it = m_small_timers.begin(); it != m_small_timers.end() && count < num;) {
-                const SmallTimer& st = it->second;
-
-                if (curr_clock - st.added >= st.interval) {
-                    ev[count++] = st.event;
-                    it = m_small_timers.erase(it);
-                } else {
-                    ++it;
-                }
+    using Clock = std::chrono::steady_clock;
+    const auto wait_end = (micros == 0) ? Clock::time_point::max()
+                                        : Clock::now() + std::chrono::microseconds{micros};
+
+    std::unique_lock lock{m_mutex};
+    while (true) {
+        const auto curr_clock = Clock::now();
+        auto next_expiry = Clock::time_point::max();
+        int count = 0;
+        for (auto it = m_small_timers.begin(); it != m_small_timers.end() && count < num;) {
+            const SmallTimer& st = it->second;
+            const auto expiry = st.added + st.interval;
+            if (curr_clock >= expiry) {
+                ev[count++] = st.event;
+                it = m_small_timers.erase(it);
+            } else {
+                next_expiry = std::min(next_expiry, expiry);
+                ++it;
             }
+        }
 
-            if (count > 0)
-                return count;
+        if (count > 0) {
+            return count;
+        }
+        if (curr_clock >= wait_end) {
+            return 0;
         }
-        std::this_thread::yield();
-    } while (curr_clock < wait_end_us);
 
-    return 0;
+        // Sleep until shortly before the next timer expires, the sleep is woken up early if the
+        // small timers change. Only the remainder is spun on, to keep the timers precise.
+        const auto wake_time = std::min(next_expiry, wait_end);
+        if (wake_time == Clock::time_point::max()) {
+            m_cond.wait(lock);
+        } else if (wake_time - curr_clock > SmallTimerSpinThreshold) {
+            m_cond.wait_until(lock, wake_time - SmallTimerSpinThreshold);
+        } else {
+            lock.unlock();
+            std::this_thread::yield();
+            lock.lock();
+        }
+    }
 }
 
 bool EqueueInternal::EventExists(u64 id, s16 filter) {
     std::scoped_lock lock{m_mutex};
-
-    const auto& it = std::ranges::find_if(m_events, [id, filter](auto& ev) {
-        return ev.event.ident == id && ev.event.filter == filter;
-    });
-
-    return it != m_events.cend();
+    return m_events.contains({id, filter});
 }
 
 int PS4_SYSV_ABI sceKernelCreateEqueue(SceKernelEqueue* eq, const char* name) {
@@ -333,7 +358,7 @@ s32 PS4_SYSV_ABI sceKernelAddHRTimerEvent(SceKernelEqueue eq, int id, timespec*
     // slowness of the notification mechanism. For instance, a 100us timer will lose its precision
     // as the trigger time drifts by +50-700%, depending on the host PC and workload. To address
     // this issue, we use a spinlock for small waits (which can be adjusted using
-    // `HrTimerSpinlockThresholdUs`) and fall back to boost asio timers if the time to tick is
+    // `HrTimerSpinlockThresholdUs`) and fall back to the timer wheel if the time to tick is
     // large. Even for large delays, we truncate a small portion to complete the wait
     // using the spinlock, prioritizing precision.
 
@@ -3,13 +3,13 @@
 
 #pragma once
 
+#include <chrono>
 #include <condition_variable>
 #include <mutex>
 #include <string>
-#include <vector>
-#include <boost/asio/steady_timer.hpp>
-
 #include <unordered_map>
+#include <boost/intrusive/list.hpp>
+
 #include "common/rdtsc.h"
 #include "common/types.h"
 
@@ -77,12 +77,16 @@ struct OrbisVideoOutEventData {
     u64 flip_arg : 48;
 };
 
-struct EqueueEvent {
+using ReadyListHook =
+    boost::intrusive::list_base_hook<boost::intrusive::link_mode<boost::intrusive::auto_unlink>>;
+
+struct EqueueEvent : ReadyListHook {
     SceKernelEvent event;
     void* data = nullptr;
     std::chrono::steady_clock::time_point time_added;
     std::chrono::microseconds timer_interval;
-    std::unique_ptr<boost::asio::steady_timer> timer;
+    std::chrono::steady_clock::time_point timer_expiry;
+    u64 timer_handle = 0;
 
     void ResetTriggerState() {
         is_triggered = false;
@@ -142,8 +146,28 @@ class EqueueInternal {
         std::chrono::microseconds interval;
     };
 
+    struct EventKey {
+        u64 ident;
+        s16 filter;
+
+        bool operator==(const EventKey&) const = default;
+    };
+
+    struct EventKeyHash {
+        size_t operator()(const EventKey& key) const {
+            return std::hash<u64>{}(key.ident * 0x9E3779B97F4A7C15ULL ^ u16(key.filter));
+        }
+    };
+
+    /// Triggered events in the order they were triggered. An event is linked while it is
+    /// triggered and unlinks itself when it is removed from the queue.
+    using ReadyList =
+        boost::intrusive::list<EqueueEvent, boost::intrusive::base_hook<ReadyListHook>,
+                               boost::intrusive::constant_time_size<false>>;
+
 public:
     explicit EqueueInternal(std::string_view name) : m_name(name) {}
+    ~EqueueInternal();
 
     std::string_view GetName() const {
         return m_name;
@@ -165,7 +189,10 @@ public:
     bool RemoveSmallTimer(u64 id) {
         if (HasSmallTimer()) {
             std::scoped_lock lock{m_mutex};
-            return m_small_timers.erase(id) > 0;
+            if (m_small_timers.erase(id) > 0) {
+                m_cond.notify_all();
+                return true;
+            }
         }
         return false;
     }
@@ -174,12 +201,17 @@ public:
 
     bool EventExists(u64 id, s16 filter);
 
+private:
+    void CancelTimer(EqueueEvent& event);
+
 private:
     std::string m_name;
     std::mutex m_mutex;
-    std::vector<EqueueEvent> m_events;
+    std::unordered_map<EventKey, EqueueEvent, EventKeyHash> m_events;
+    ReadyList m_ready;
     std::condition_variable m_cond;
     std::unordered_map<u64, SmallTimer> m_small_timers;
+    bool m_closing{};
 };
 
 u64 PS4_SYSV_ABI sceKernelGetEventData(const SceKernelEvent* ev);
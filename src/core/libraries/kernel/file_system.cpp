@@ -964,6 +964,43 @@ s64 PS4_SYSV_ABI sceKernelPread(s32 fd, void* buf, u64 nbytes, s64 offset) {
     return sceKernelPreadv(fd, &iovec, 1, offset);
 }
 
+s64 ReadFileAt(s32 fd, void* buf, u64 nbytes, s64 offset) {
+    auto* h = Common::Singleton<Core::FileSys::HandleTable>::Instance();
+    auto* file = h->GetFile(fd);
+    if (file == nullptr || file->type != Core::FileSys::FileType::Regular) {
+        // Devices and directories keep their own position, they go through the locked path.
+        return sceKernelPread(fd, buf, nbytes, offset);
+    }
+    if (file->f.IsWriteOnly()) {
+        return ORBIS_KERNEL_ERROR_EBADF;
+    }
+    if (offset < 0) {
+        return ORBIS_KERNEL_ERROR_EINVAL;
+    }
+
+    // Invalidate up to the actual number of bytes that could be read.
+    std::error_code ec;
+    const u64 file_size = fs::file_size(file->m_host_name, ec);
+    const u64 remaining = ec || file_size < static_cast<u64>(offset) ? 0 : file_size - offset;
+    Core::Memory::Instance()->InvalidateMemory(reinterpret_cast<VAddr>(buf),
+                                               std::min<u64>(nbytes, remaining));
+
+#ifdef _WIN32
+    // Reading at an offset moves the handle position on Windows, so keep the seek lock there.
+    std::scoped_lock lk{file->m_mutex};
+    const s64 pos = file->f.Tell();
+    SCOPE_EXIT {
+        file->f.Seek(pos);
+    };
+#endif
+    const s64 result = file->f.ReadAt(buf, nbytes, offset);
+    if (result < 0) {
+        LOG_ERROR(Kernel_Fs, "Failed to read {} bytes at {:#x} from {}", nbytes, offset, fd);
+        return ORBIS_KERNEL_ERROR_EIO;
+    }
+    return result;
+}
+
 s32 PS4_SYSV_ABI posix_fsync(s32 fd) {
     auto* h = Common::Singleton<Core::FileSys::HandleTable>::Instance();
     auto* file = h->GetFile(fd);
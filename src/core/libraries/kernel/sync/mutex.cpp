@@ -5,8 +5,30 @@
 
 #include "common/assert.h"
 
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
 namespace Libraries::Kernel {
 
+#ifdef __linux__
+static constexpr u32 Unlocked = 0;
+static constexpr u32 Locked = 1;
+static constexpr u32 Contended = 2;
+
+static void FutexWait(std::atomic<u32>& word, u32 expected, const timespec* timeout) {
+    syscall(SYS_futex, reinterpret_cast<u32*>(&word), FUTEX_WAIT_PRIVATE, expected, timeout,
+            nullptr, 0);
+}
+
+static void FutexWake(std::atomic<u32>& word, s32 count) {
+    syscall(SYS_futex, reinterpret_cast<u32*>(&word), FUTEX_WAKE_PRIVATE, count, nullptr, nullptr,
+            0);
+}
+#endif
+
 TimedMutex::TimedMutex() {
 #ifdef _WIN64
     mtx = CreateMutex(nullptr, false, nullptr);
@@ -28,6 +50,20 @@ void TimedMutex::lock() {
             return;
         }
     }
+#elif defined(__linux__)
+    u32 c = Unlocked;
+    if (state.compare_exchange_strong(c, Locked, std::memory_order::acquire,
+                                      std::memory_order::relaxed)) {
+        return;
+    }
+    // Mark the mutex as contended so that the owner wakes us up when unlocking.
+    if (c != Contended) {
+        c = state.exchange(Contended, std::memory_order::acquire);
+    }
+    while (c != Unlocked) {
+        FutexWait(state, Contended, nullptr);
+        c = state.exchange(Contended, std::memory_order::acquire);
+    }
 #else
     mtx.lock();
 #endif
@@ -36,6 +72,10 @@ void TimedMutex::lock() {
 bool TimedMutex::try_lock() {
 #ifdef _WIN64
     return WaitForSingleObjectEx(mtx, 0, true) == WAIT_OBJECT_0;
+#elif defined(__linux__)
+    u32 c = Unlocked;
+    return state.compare_exchange_strong(c, Locked, std::memory_order::acquire,
+                                         std::memory_order::relaxed);
 #else
     return mtx.try_lock();
 #endif
@@ -44,9 +84,38 @@ bool TimedMutex::try_lock() {
 void TimedMutex::unlock() {
 #ifdef _WIN64
     ReleaseMutex(mtx);
+#elif defined(__linux__)
+    if (state.exchange(Unlocked, std::memory_order::release) == Contended) {
+        FutexWake(state, 1);
+    }
 #else
     mtx.unlock();
 #endif
 }
 
+#ifdef __linux__
+bool TimedMutex::try_lock_for_ns(std::chrono::nanoseconds rel_time) {
+    if (try_lock()) {
+        return true;
+    }
+    const auto end_time = std::chrono::steady_clock::now() + rel_time;
+    u32 c = state.exchange(Contended, std::memory_order::acquire);
+    while (c != Unlocked) {
+        const auto now = std::chrono::steady_clock::now();
+        if (now >= end_time) {
+            return false;
+        }
+        const auto remaining = end_time - now;
+        const auto secs = std::chrono::duration_cast<std::chrono::seconds>(remaining);
+        const timespec timeout{
+            .tv_sec = static_cast<time_t>(secs.count()),
+            .tv_nsec = static_cast<long>((remaining - secs).count()),
+        };
+        FutexWait(state, Contended, &timeout);
+        c = state.exchange(Contended, std::memory_order::acquire);
+    }
+    return true;
+}
+#endif
+
 } // namespace Libraries::Kernel
\ No newline at end of file
@@ -9,6 +9,8 @@
 
 #ifdef _WIN64
 #include <windows.h>
+#elif defined(__linux__)
+#include <atomic>
 #else
 #include <mutex>
 #endif
@@ -42,6 +44,8 @@ public:
         }
 
         return try_lock_until(abs_time);
+#elif defined(__linux__)
+        return try_lock_for_ns(std::chrono::ceil<std::chrono::nanoseconds>(rel_time));
 #else
         return mtx.try_lock_for(rel_time);
 #endif
@@ -64,6 +68,12 @@ public:
                 return false;
             }
         }
+#elif defined(__linux__)
+        const auto now = Clock::now();
+        if (abs_time <= now) {
+            return try_lock();
+        }
+        return try_lock_for_ns(std::chrono::ceil<std::chrono::nanoseconds>(abs_time - now));
 #else
         return mtx.try_lock_until(abs_time);
 #endif
@@ -72,6 +82,11 @@ public:
 private:
 #ifdef _WIN64
     HANDLE mtx;
+#elif defined(__linux__)
+    bool try_lock_for_ns(std::chrono::nanoseconds rel_time);
+
+    /// Futex word, 0 when unlocked, 1 when locked and 2 when locked with possible waiters.
+    std::atomic<u32> state{0};
 #else
     std::timed_mutex mtx;
 #endif
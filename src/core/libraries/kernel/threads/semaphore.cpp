@@ -2,9 +2,9 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 
 #include <condition_variable>
-#include <list>
 #include <mutex>
 #include <semaphore>
+#include <boost/intrusive/list.hpp>
 
 #include "core/libraries/kernel/sync/semaphore.h"
 
@@ -49,14 +49,15 @@ public:
             return ORBIS_KERNEL_ERROR_ETIMEDOUT;
         }
 
-        // Create waiting thread object and add it into the list of waiters.
+        // Create waiting thread object and add it into the list of waiters. The waiter lives on
+        // the stack of the waiting thread and is linked intrusively, so waiting never allocates.
         WaitingThread waiter{need_count, is_fifo};
-        const auto it = AddWaiter(&waiter);
+        AddWaiter(waiter);
 
         // Perform the wait.
         const s32 result = waiter.Wait(lk, timeout);
         if (result == ORBIS_KERNEL_ERROR_ETIMEDOUT) {
-            wait_list.erase(it);
+            wait_list.erase(wait_list.iterator_to(waiter));
         }
         return result;
     }
@@ -70,15 +71,15 @@ public:
 
         // Wake up threads in order of priority.
         for (auto it = wait_list.begin(); it != wait_list.end();) {
-            auto* waiter = *it;
-            if (waiter->need_count > token_count) {
+            auto& waiter = *it;
+            if (waiter.need_count > token_count) {
                 ++it;
                 continue;
             }
             it = wait_list.erase(it);
-            token_count -= waiter->need_count;
-            waiter->was_signaled = true;
-            waiter->sem.release();
+            token_count -= waiter.need_count;
+            waiter.was_signaled = true;
+            waiter.sem.release();
         }
 
         return true;
@@ -89,30 +90,28 @@ public:
         if (num_waiters) {
             *num_waiters = static_cast<s32>(wait_list.size());
         }
-        for (auto* waiter : wait_list) {
+        wait_list.clear_and_dispose([](WaitingThread* waiter) {
             waiter->was_canceled = true;
             waiter->sem.release();
-        }
-        wait_list.clear();
+        });
         token_count = set_count < 0 ? init_count : set_count;
         return ORBIS_OK;
     }
 
     void Delete() {
         std::scoped_lock lk{mutex};
-        for (auto* waiter : wait_list) {
+        wait_list.clear_and_dispose([](WaitingThread* waiter) {
             waiter->was_deleted = true;
             waiter->sem.release();
-        }
-        wait_list.clear();
+        });
     }
 
 public:
-    struct WaitingThread {
+    struct WaitingThread : public boost::intrusive::list_base_hook<> {
         BinarySemaphore sem;
         u32 priority;
         s32 need_count;
-        std::string thr_name;
+        std::string_view thr_name;
         bool was_signaled{};
         bool was_deleted{};
         bool was_canceled{};
@@ -164,20 +163,20 @@ public:
         }
     };
 
-    using WaitList = std::list<WaitingThread*>;
+    using WaitList = boost::intrusive::list<WaitingThread>;
 
-    WaitList::iterator AddWaiter(WaitingThread* waiter) {
+    void AddWaiter(WaitingThread& waiter) {
         // Insert at the end of the list for FIFO order.
         if (is_fifo) {
             wait_list.push_back(waiter);
-            return --wait_list.end();
+            return;
         }
         // Find the first with lower priority (greater number) than us and insert right before it.
         auto it = wait_list.begin();
-        while (it != wait_list.end() && (*it)->priority <= waiter->priority) {
+        while (it != wait_list.end() && it->priority <= waiter.priority) {
             ++it;
         }
-        return wait_list.insert(it, waiter);
+        wait_list.insert(it, waiter);
     }
 
     WaitList wait_list;
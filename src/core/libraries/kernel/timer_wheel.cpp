@@ -0,0 +1,175 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <bit>
+
+#include "common/thread.h"
+#include "core/libraries/kernel/timer_wheel.h"
+
+namespace Libraries::Kernel {
+
+TimerWheel::TimerWheel() : epoch{Clock::now()} {
+    thread = std::thread([this] { TimerThread(); });
+}
+
+TimerWheel::~TimerWheel() {
+    {
+        std::scoped_lock lk{mutex};
+        stop = true;
+    }
+    cv.notify_one();
+    thread.join();
+}
+
+u64 TimerWheel::Schedule(Clock::time_point expiry, Callback&& callback) {
+    u64 handle;
+    {
+        std::scoped_lock lk{mutex};
+        handle = next_handle++;
+        pending.insert(handle);
+        Insert(Timer{
+            .handle = handle,
+            .expiry_tick = ToTick(expiry),
+            .callback = std::move(callback),
+        });
+    }
+    cv.notify_one();
+    return handle;
+}
+
+void TimerWheel::Cancel(u64 handle) {
+    // The timer is left in its slot and dropped when the wheel reaches it.
+    std::scoped_lock lk{mutex};
+    pending.erase(handle);
+}
+
+void TimerWheel::WaitForCallbacks() {
+    // Expired timers are collected and dispatched under the same hold of the dispatch lock.
+    std::scoped_lock lk{dispatch_mutex};
+}
+
+u64 TimerWheel::ToTick(Clock::time_point time) const {
+    if (time <= epoch) {
+        return 0;
+    }
+    // Round up so that timers never fire early.
+    const auto elapsed = time - epoch;
+    return static_cast<u64>((elapsed + TickDuration - Clock::duration{1}) / TickDuration);
+}
+
+TimerWheel::Clock::time_point TimerWheel::ToTime(u64 tick) const {
+    return epoch + tick * TickDuration;
+}
+
+void TimerWheel::Insert(Timer&& timer) {
+    // Timers that expire beyond the range of the wheel are parked in the last level and
+    // reinserted with their real expiry once their slot is cascaded.
+    const u64 tick = std::max(timer.expiry_tick, current_tick);
+    const u64 delta = std::min(tick - current_tick, MaxDelta);
+    u32 level = 0;
+    while (delta >> (SlotBits * (level + 1)) != 0) {
+        ++level;
+    }
+    const u32 slot = ((current_tick + delta) >> (SlotBits * level)) & SlotMask;
+    slots[level][slot].emplace_back(std::move(timer));
+    occupied[level] |= 1ULL << slot;
+}
+
+void TimerWheel::Cascade(u32 level) {
+    const u32 slot = (current_tick >> (SlotBits * level)) & SlotMask;
+    auto timers = std::move(slots[level][slot]);
+    slots[level][slot].clear();
+    occupied[level] &= ~(1ULL << slot);
+    for (auto& timer : timers) {
+        if (pending.contains(timer.handle)) {
+            Insert(std::move(timer));
+        }
+    }
+}
+
+std::optional<u64> TimerWheel::NextTick() const {
+    const u32 slot = current_tick & SlotMask;
+    const bool has_upper = std::ranges::any_of(occupied.begin() + 1, occupied.end(),
+                                               [](u64 mask) { return mask != 0; });
+    // The upper levels must be cascaded before any tick of a new revolution is processed.
+    if (slot == 0 && has_upper) {
+        return current_tick;
+    }
+    // Look for the next occupied slot in the current revolution of the first level.
+    const u64 ahead = occupied[0] >> slot;
+    if (ahead != 0) {
+        return current_tick + std::countr_zero(ahead);
+    }
+    // Otherwise wake up at the start of the next revolution if there is anything left.
+    if (has_upper || occupied[0] != 0) {
+        return (current_tick | SlotMask) + 1;
+    }
+    return std::nullopt;
+}
+
+void TimerWheel::CollectExpired(u64 now_tick, std::vector<Timer>& expired) {
+    while (true) {
+        const auto next_tick = NextTick();
+        if (!next_tick || *next_tick > now_tick) {
+            return;
+        }
+        // Skipped ticks have empty slots in the first level and no cascade boundary.
+        current_tick = *next_tick;
+        if ((current_tick & SlotMask) == 0) {
+            for (u32 level = 1; level < NumLevels; ++level) {
+                Cascade(level);
+                if (((current_tick >> (SlotBits * level)) & SlotMask) != 0) {
+                    break;
+                }
+            }
+        }
+        const u32 slot = current_tick & SlotMask;
+        for (auto& timer : slots[0][slot]) {
+            if (pending.erase(timer.handle) != 0) {
+                expired.emplace_back(std::move(timer));
+            }
+        }
+        slots[0][slot].clear();
+        occupied[0] &= ~(1ULL << slot);
+        ++current_tick;
+    }
+}
+
+void TimerWheel::TimerThread() {
+    Common::SetCurrentThreadName("shadPS4:TimerWheel");
+
+    std::vector<Timer> expired;
+    while (true) {
+        {
+            std::unique_lock lk{mutex};
+            if (stop) {
+                return;
+            }
+            const auto next_tick = NextTick();
+            if (!next_tick) {
+                cv.wait(lk);
+                continue;
+            }
+            const auto deadline = ToTime(*next_tick);
+            if (Clock::now() < deadline) {
+                cv.wait_until(lk, deadline);
+                continue;
+            }
+        }
+
+        // Callbacks run with the dispatch lock held, which lets WaitForCallbacks wait for them.
+        std::scoped_lock dispatch_lk{dispatch_mutex};
+        {
+            std::scoped_lock lk{mutex};
+            const u64 now_tick = static_cast<u64>((Clock::now() - epoch) / TickDuration);
+            CollectExpired(now_tick, expired);
+        }
+        for (auto& timer : expired) {
+            timer.callback();
+        }
+        expired.clear();
+    }
+}
+
+} // namespace Libraries::Kernel
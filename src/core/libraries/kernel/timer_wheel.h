@@ -0,0 +1,86 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include "common/types.h"
+
+namespace Libraries::Kernel {
+
+/**
+ * Hierarchical timing wheel serviced by a single thread.
+ * Timers are bucketed by their expiry tick into levels of 64 slots, each level covering 64 times
+ * the range of the one below it. Slots of the upper levels are cascaded down as the wheel turns,
+ * so scheduling and cancelling are constant time and the thread only wakes up for ticks that have
+ * timers in them.
+ */
+class TimerWheel {
+public:
+    using Clock = std::chrono::steady_clock;
+    using Callback = std::function<void()>;
+
+    static constexpr auto TickDuration = std::chrono::microseconds{100};
+
+    TimerWheel();
+    ~TimerWheel();
+
+    /// Schedules a callback to run on the timer thread once expiry is reached.
+    /// Returns a handle that can be used to cancel the timer.
+    u64 Schedule(Clock::time_point expiry, Callback&& callback);
+
+    /// Cancels a pending timer. Does nothing if the timer has already fired.
+    void Cancel(u64 handle);
+
+    /// Waits for the callbacks that were already collected by the timer thread to return,
+    /// including those of timers that were cancelled after they expired.
+    /// Must not be called from a timer callback.
+    void WaitForCallbacks();
+
+private:
+    static constexpr u32 SlotBits = 6;
+    static constexpr u32 NumSlots = 1u << SlotBits;
+    static constexpr u32 SlotMask = NumSlots - 1;
+    static constexpr u32 NumLevels = 4;
+    static constexpr u64 MaxDelta = (1ULL << (SlotBits * NumLevels)) - 1;
+
+    struct Timer {
+        u64 handle;
+        u64 expiry_tick;
+        Callback callback;
+    };
+
+    u64 ToTick(Clock::time_point time) const;
+    Clock::time_point ToTime(u64 tick) const;
+
+    void Insert(Timer&& timer);
+    void Cascade(u32 level);
+    std::optional<u64> NextTick() const;
+    void CollectExpired(u64 now_tick, std::vector<Timer>& expired);
+
+    void TimerThread();
+
+private:
+    Clock::time_point epoch;
+    std::mutex mutex;
+    std::mutex dispatch_mutex;
+    std::condition_variable cv;
+    std::array<std::array<std::vector<Timer>, NumSlots>, NumLevels> slots;
+    std::array<u64, NumLevels> occupied{};
+    std::unordered_set<u64> pending;
+    u64 current_tick{};
+    u64 next_handle{1};
+    bool stop{};
+    std::thread thread;
+};
+
+} // namespace Libraries::Kernel
@@ -3,6 +3,7 @@
 
 #include "save_memory.h"
 
+#include <algorithm>
 #include <condition_variable>
 #include <filesystem>
 #include <mutex>
@@ -10,10 +11,12 @@
 #include <utility>
 #include <fmt/format.h>
 
+#include <boost/icl/interval_set.hpp>
 #include "boost/icl/concept/interval.hpp"
 #include "common/elf_info.h"
 #include "common/logging/log.h"
 #include "common/path_util.h"
+#include "common/polyfill_thread.h"
 #include "common/singleton.h"
 #include "common/thread.h"
 #include "core/file_sys/fs.h"
@@ -33,6 +36,9 @@ namespace Libraries::SaveData::SaveMemory {
 
 static Core::FileSys::MntPoints* g_mnt = Common::Singleton<Core::FileSys::MntPoints>::Instance();
 
+// Writes are collected for this long before they are flushed, to coalesce bursts of writes.
+static constexpr auto FlushDelay = std::chrono::milliseconds{100};
+
 struct SlotData {
     OrbisUserServiceUserId user_id{};
     std::string game_serial;
@@ -40,44 +46,185 @@ struct SlotData {
     PSF sfo;
     std::vector<u8> memory_cache;
     size_t memory_cache_size{};
+    boost::icl::interval_set<u64> dirty_ranges;
+    bool flush_failed{};     ///< The flusher leaves the slot alone until the next write or sync
+    bool failure_reported{}; ///< The user was told, cleared once a write succeeds again
 };
 
 static std::mutex g_slot_mtx;
 static std::unordered_map<u32, SlotData> g_attached_slots;
 
-void PersistMemory(u32 slot_id, bool lock) {
-    std::unique_lock lck{g_slot_mtx, std::defer_lock};
-    if (lock) {
-        lck.lock();
+// Serializes writes to the memory files between the flusher thread and explicit syncs.
+static std::mutex g_flush_mtx;
+static std::condition_variable_any g_flush_cv;
+static std::jthread g_flush_thread;
+
+static void LoadMemory(SlotData& data) {
+    auto& memory = data.memory_cache;
+    if (!memory.empty()) {
+        return;
     }
-    auto& data = g_attached_slots[slot_id];
-    auto memoryPath = data.folder_path / FilenameSaveDataMemory;
-    fs::create_directories(memoryPath.parent_path());
-
-    int n = 0;
-    std::string errMsg;
-    while (n++ < 10) {
-        try {
-            IOFile f;
-            int r = f.Open(memoryPath, Common::FS::FileAccessMode::Create);
-            if (f.IsOpen()) {
-                f.WriteRaw<u8>(data.memory_cache.data(), data.memory_cache.size());
-                f.Close();
-                return;
+    memory.resize(data.memory_cache_size);
+    IOFile f{data.folder_path / FilenameSaveDataMemory, Common::FS::FileAccessMode::Read};
+    if (f.IsOpen()) {
+        f.Seek(0);
+        f.ReadSpan(std::span{memory});
+    }
+}
+
+struct PendingWrite {
+    u64 offset;
+    std::vector<u8> data;
+};
+
+/// Writes the pending ranges to the memory file. Makes a single attempt, failed writes are
+/// retried by the next write or sync of the slot.
+static bool WriteMemoryFile(const fs::path& memory_path, u64 memory_size,
+                            const std::vector<PendingWrite>& writes, std::string& error) {
+    try {
+        fs::create_directories(memory_path.parent_path());
+        // Only the modified ranges are written when the file already exists.
+        IOFile f;
+        int r = fs::exists(memory_path) ? f.Open(memory_path, Common::FS::FileAccessMode::Write)
+                                        : f.Open(memory_path, Common::FS::FileAccessMode::Create);
+        if (f.IsOpen()) {
+            for (const auto& write : writes) {
+                f.Seek(write.offset);
+                f.WriteRaw<u8>(write.data.data(), write.data.size());
+            }
+            if (f.GetSize() < memory_size) {
+                f.SetSize(memory_size);
+            }
+            f.Close();
+            return true;
+        }
+        const auto err = std::error_code{r, std::iostream_category()};
+        throw std::filesystem::filesystem_error{err.message(), err};
+    } catch (const std::filesystem::filesystem_error& e) {
+        error = e.what();
+        return false;
+    }
+}
+
+// Must be called with g_flush_mtx held.
+static void FlushSlot(u32 slot_id) {
+    std::vector<PendingWrite> writes;
+    fs::path memory_path;
+    u64 memory_size;
+    OrbisUserServiceUserId user_id;
+    std::string game_serial;
+    {
+        std::scoped_lock lk{g_slot_mtx};
+        const auto it = g_attached_slots.find(slot_id);
+        if (it == g_attached_slots.end() || it->second.dirty_ranges.empty()) {
+            return;
+        }
+        auto& data = it->second;
+        const auto memory = data.memory_cache.begin();
+        for (const auto& range : data.dirty_ranges) {
+            writes.emplace_back(range.lower(),
+                                std::vector<u8>(memory + range.lower(), memory + range.upper()));
+        }
+        data.dirty_ranges.clear();
+        memory_path = data.folder_path / FilenameSaveDataMemory;
+        memory_size = data.memory_cache.size();
+        user_id = data.user_id;
+        game_serial = data.game_serial;
+    }
+    std::string error;
+    const bool written = WriteMemoryFile(memory_path, memory_size, writes, error);
+    bool report{};
+    {
+        std::scoped_lock lk{g_slot_mtx};
+        const auto it = g_attached_slots.find(slot_id);
+        if (it != g_attached_slots.end()) {
+            auto& data = it->second;
+            if (!written) {
+                // Keep the ranges dirty, they are retried by the next write or sync.
+                for (const auto& write : writes) {
+                    data.dirty_ranges += decltype(data.dirty_ranges)::interval_type::right_open(
+                        write.offset, write.offset + write.data.size());
+                }
+                report = !std::exchange(data.failure_reported, true);
+            } else {
+                data.failure_reported = false;
+            }
+            data.flush_failed = !written;
+        }
+    }
+    if (!written) {
+        LOG_ERROR(Lib_SaveData, "Failed to persist save memory to {}: {}",
+                  Common::FS::PathToUTF8String(memory_path), error);
+        if (report) {
+            // Don't wait for the user, g_flush_mtx is held.
+            const MsgDialog::MsgDialogState dialog{MsgDialog::MsgDialogState::UserState{
+                .type = MsgDialog::ButtonType::OK,
+                .msg = "Failed to persist save memory:\n" + error + "\nat " +
+                       Common::FS::PathToUTF8String(memory_path),
+            }};
+            MsgDialog::ShowMsgDialog(dialog, false);
+        }
+        return;
+    }
+    Backup::NewRequest(user_id, game_serial, GetSaveDir(slot_id),
+                       Backup::OrbisSaveDataEventType::__DO_NOT_SAVE);
+}
+
+static bool NeedsFlush(const SlotData& data) {
+    return !data.dirty_ranges.empty() && !data.flush_failed;
+}
+
+/// Flushes the dirty slots. Slots whose last flush failed are only retried on exit.
+static void FlushAll(bool retry_failed) {
+    std::scoped_lock lk{g_flush_mtx};
+    std::vector<u32> slot_ids;
+    {
+        std::scoped_lock slot_lk{g_slot_mtx};
+        for (const auto& [slot_id, data] : g_attached_slots) {
+            if (NeedsFlush(data) || (retry_failed && !data.dirty_ranges.empty())) {
+                slot_ids.push_back(slot_id);
             }
-            const auto err = std::error_code{r, std::iostream_category()};
-            throw std::filesystem::filesystem_error{err.message(), err};
-        } catch (const std::filesystem::filesystem_error& e) {
-            errMsg = std::string{e.what()};
-            std::this_thread::sleep_for(std::chrono::seconds(1));
         }
     }
-    const MsgDialog::MsgDialogState dialog{MsgDialog::MsgDialogState::UserState{
-        .type = MsgDialog::ButtonType::OK,
-        .msg = "Failed to persist save memory:\n" + errMsg + "\nat " +
-               Common::FS::PathToUTF8String(memoryPath),
-    }};
-    MsgDialog::ShowMsgDialog(dialog);
+    for (const u32 slot_id : slot_ids) {
+        FlushSlot(slot_id);
+    }
+}
+
+static void FlushThreadBody(std::stop_token stop_token) {
+    Common::SetCurrentThreadName("shadPS4:SaveData:MemoryFlushThread");
+    const auto has_dirty = [] {
+        return std::ranges::any_of(g_attached_slots,
+                                   [](const auto& slot) { return NeedsFlush(slot.second); });
+    };
+    while (!stop_token.stop_requested()) {
+        {
+            std::unique_lock lk{g_slot_mtx};
+            Common::CondvarWait(g_flush_cv, lk, stop_token, has_dirty);
+        }
+        if (stop_token.stop_requested()) {
+            break;
+        }
+        // Give the game a moment to finish writing so that the writes hit the disk together.
+        Common::StoppableTimedWait(stop_token, FlushDelay);
+        FlushAll(false);
+    }
+    FlushAll(true);
+}
+
+// Must be called with g_slot_mtx held.
+static void StartFlushThread() {
+    if (g_flush_thread.joinable()) {
+        return;
+    }
+    g_flush_thread = std::jthread{FlushThreadBody};
+    static std::once_flag flag;
+    std::call_once(flag, [] { std::at_quick_exit([] { FlushAll(true); }); });
+}
+
+void PersistMemory(u32 slot_id) {
+    std::scoped_lock lk{g_flush_mtx};
+    FlushSlot(slot_id);
 }
 
 std::string GetSaveDir(u32 slot_id) {
@@ -99,6 +246,8 @@ std::filesystem::path GetSavePath(OrbisUserServiceUserId user_id, u32 slot_id,
 
 size_t SetupSaveMemory(OrbisUserServiceUserId user_id, u32 slot_id, std::string_view game_serial,
                        size_t memory_size) {
+    // Don't lose the pending writes of a previous setup of the slot.
+    PersistMemory(slot_id);
     std::lock_guard lck{g_slot_mtx};
 
     const auto save_dir = GetSavePath(user_id, slot_id, game_serial);
@@ -196,15 +345,8 @@ void SaveSFO(u32 slot_id) {
 void ReadMemory(u32 slot_id, void* buf, size_t buf_size, int64_t offset) {
     std::lock_guard lk{g_slot_mtx};
     auto& data = g_attached_slots[slot_id];
+    LoadMemory(data);
     auto& memory = data.memory_cache;
-    if (memory.empty()) { // Load file
-        memory.resize(data.memory_cache_size);
-        IOFile f{data.folder_path / FilenameSaveDataMemory, Common::FS::FileAccessMode::Read};
-        if (f.IsOpen()) {
-            f.Seek(0);
-            f.ReadSpan(std::span{memory});
-        }
-    }
     s64 read_size = buf_size;
     if (read_size + offset > memory.size()) {
         read_size = memory.size() - offset;
@@ -213,15 +355,21 @@ void ReadMemory(u32 slot_id, void* buf, size_t buf_size, int64_t offset) {
 }
 
 void WriteMemory(u32 slot_id, void* buf, size_t buf_size, int64_t offset) {
-    std::lock_guard lk{g_slot_mtx};
-    auto& data = g_attached_slots[slot_id];
-    auto& memory = data.memory_cache;
-    if (offset + buf_size > memory.size()) {
-        memory.resize(offset + buf_size);
+    {
+        std::lock_guard lk{g_slot_mtx};
+        auto& data = g_attached_slots[slot_id];
+        // Unmodified ranges are kept on disk, so the cache must hold the current contents.
+        LoadMemory(data);
+        auto& memory = data.memory_cache;
+        if (offset + buf_size > memory.size()) {
+            memory.resize(offset + buf_size);
+        }
+        std::memcpy(memory.data() + offset, buf, buf_size);
+        data.dirty_ranges += decltype(data.dirty_ranges)::interval_type::right_open(
+            offset, offset + buf_size);
+        data.flush_failed = false;
+        StartFlushThread();
     }
-    std::memcpy(memory.data() + offset, buf, buf_size);
-    PersistMemory(slot_id, false);
-    Backup::NewRequest(data.user_id, data.game_serial, GetSaveDir(slot_id),
-                       Backup::OrbisSaveDataEventType::__DO_NOT_SAVE);
+    g_flush_cv.notify_one();
 }
 } // namespace Libraries::SaveData::SaveMemory
\ No newline at end of file
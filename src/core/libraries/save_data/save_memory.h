@@ -14,7 +14,8 @@ using OrbisUserServiceUserId = s32;
 
 namespace Libraries::SaveData::SaveMemory {
 
-void PersistMemory(u32 slot_id, bool lock = true);
+// Writes the pending modifications of the save memory to disk
+void PersistMemory(u32 slot_id);
 
 [[nodiscard]] std::string GetSaveDir(u32 slot_id);
 
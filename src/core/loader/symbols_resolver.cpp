@@ -11,7 +11,9 @@
 namespace Core::Loader {
 
 void SymbolsResolver::AddSymbol(const SymbolResolver& s, u64 virtual_addr) {
-    m_symbols.emplace_back(GenerateName(s), s.nidName, virtual_addr);
+    auto& record = m_symbols.emplace_back(GenerateName(s), s.nidName, virtual_addr);
+    // Keep the first definition of a symbol, matching the previous lookup order.
+    m_symbol_index.try_emplace(record.name, m_symbols.size() - 1);
 }
 
 std::string SymbolsResolver::GenerateName(const SymbolResolver& s) {
@@ -20,15 +22,11 @@ std::string SymbolsResolver::GenerateName(const SymbolResolver& s) {
 }
 
 const SymbolRecord* SymbolsResolver::FindSymbol(const SymbolResolver& s) const {
-    const std::string name = GenerateName(s);
-    for (u32 i = 0; i < m_symbols.size(); i++) {
-        if (m_symbols[i].name == name) {
-            return &m_symbols[i];
-        }
+    const auto it = m_symbol_index.find(GenerateName(s));
+    if (it == m_symbol_index.end()) {
+        return nullptr;
     }
-
-    // LOG_INFO(Core_Linker, "Unresolved! {}", name);
-    return nullptr;
+    return &m_symbols[it->second];
 }
 
 void SymbolsResolver::DebugDump(const std::filesystem::path& file_name) {
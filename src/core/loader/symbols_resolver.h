@@ -6,6 +6,7 @@
 #include <filesystem>
 #include <span>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include "common/assert.h"
 #include "common/types.h"
@@ -74,6 +75,7 @@ public:
 
 private:
     std::vector<SymbolRecord> m_symbols;
+    std::unordered_map<std::string, size_t> m_symbol_index; ///< Generated name -> m_symbols index
 };
 
 } // namespace Core::Loader
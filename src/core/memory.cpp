@@ -21,8 +21,9 @@ MemoryManager::MemoryManager() {
     auto regions = impl.GetUsableRegions();
     u64 total_usable_space = 0;
     for (auto region : regions) {
-        vma_map.emplace(region.lower(),
-                        VirtualMemoryArea{region.lower(), region.upper() - region.lower()});
+        const auto it = vma_map.emplace(
+            region.lower(), VirtualMemoryArea{region.lower(), region.upper() - region.lower()});
+        vma_free_index.Insert(it.first->second);
         LOG_INFO(Kernel_Vmm, "{:#x} - {:#x}", region.lower(), region.upper());
     }
 }
@@ -55,14 +56,20 @@ void MemoryManager::SetupMemoryRegions(u64 flexible_size, bool use_extended_mem1
     // Insert an area that covers the direct memory physical address block.
     // Note that this should never be called after direct memory allocations have been made.
     dmem_map.clear();
-    dmem_map.emplace(0, DirectMemoryArea{0, total_direct_size});
+    dmem_free_index.Clear();
+    dmem_free_index.Insert(
+        dmem_map.emplace(0, DirectMemoryArea{0, total_direct_size}).first->second);
 
     // Insert an area that covers the flexible memory physical address block.
     // Note that this should never be called after flexible memory allocations have been made.
     const auto remaining_physical_space = total_size - total_direct_size;
     fmem_map.clear();
-    fmem_map.emplace(total_direct_size,
-                     FlexibleMemoryArea{total_direct_size, remaining_physical_space});
+    fmem_free_index.Clear();
+    fmem_free_index.Insert(
+        fmem_map
+            .emplace(total_direct_size,
+                     FlexibleMemoryArea{total_direct_size, remaining_physical_space})
+            .first->second);
 
     LOG_INFO(Kernel_Vmm, "Configured memory regions: flexible size = {:#x}, direct size = {:#x}",
              total_flexible_size, total_direct_size);
@@ -75,6 +82,7 @@ u64 MemoryManager::ClampRangeSize(VAddr virtual_addr, u64 size) {
         return size;
     }
 
+    std::shared_lock lk{mutex};
     ASSERT_MSG(IsValidMapping(virtual_addr), "Attempted to access invalid address {:#x}",
                virtual_addr);
 
@@ -113,6 +121,7 @@ void MemoryManager::SetPrtArea(u32 id, VAddr address, u64 size) {
 }
 
 void MemoryManager::CopySparseMemory(VAddr virtual_addr, u8* dest, u64 size) {
+    std::shared_lock lk{mutex};
     ASSERT_MSG(IsValidMapping(virtual_addr), "Attempted to access invalid address {:#x}",
                virtual_addr);
 
@@ -133,6 +142,7 @@ void MemoryManager::CopySparseMemory(VAddr virtual_addr, u8* dest, u64 size) {
 
 bool MemoryManager::TryWriteBacking(void* address, const void* data, u32 num_bytes) {
     const VAddr virtual_addr = std::bit_cast<VAddr>(address);
+    std::shared_lock lk{mutex};
     ASSERT_MSG(IsValidMapping(virtual_addr, num_bytes), "Attempted to access invalid address {:#x}",
                virtual_addr);
     const auto& vma = FindVMA(virtual_addr)->second;
@@ -148,26 +158,8 @@ PAddr MemoryManager::PoolExpand(PAddr search_start, PAddr search_end, u64 size,
     std::scoped_lock lk{mutex};
     alignment = alignment > 0 ? alignment : 64_KB;
 
-    auto dmem_area = FindDmemArea(search_start);
-    auto mapping_start = search_start > dmem_area->second.base
-                             ? Common::AlignUp(search_start, alignment)
-                             : Common::AlignUp(dmem_area->second.base, alignment);
-    auto mapping_end = mapping_start + size;
-
-    // Find the first free, large enough dmem area in the range.
-    while (dmem_area->second.dma_type != DMAType::Free ||
-           dmem_area->second.GetEnd() < mapping_end) {
-        // The current dmem_area isn't suitable, move to the next one.
-        dmem_area++;
-        if (dmem_area == dmem_map.end()) {
-            break;
-        }
-
-        // Update local variables based on the new dmem_area
-        mapping_start = Common::AlignUp(dmem_area->second.base, alignment);
-        mapping_end = mapping_start + size;
-    }
-
+    PAddr mapping_start;
+    const auto dmem_area = SearchFreeDmem(search_start, size, alignment, &mapping_start);
     if (dmem_area == dmem_map.end()) {
         // There are no suitable mappings in this range
         LOG_ERROR(Kernel_Vmm, "Unable to find free direct memory area: size = {:#x}", size);
@@ -190,26 +182,8 @@ PAddr MemoryManager::Allocate(PAddr search_start, PAddr search_end, u64 size, u6
     std::scoped_lock lk{mutex};
     alignment = alignment > 0 ? alignment : 16_KB;
 
-    auto dmem_area = FindDmemArea(search_start);
-    auto mapping_start = search_start > dmem_area->second.base
-                             ? Common::AlignUp(search_start, alignment)
-                             : Common::AlignUp(dmem_area->second.base, alignment);
-    auto mapping_end = mapping_start + size;
-
-    // Find the first free, large enough dmem area in the range.
-    while (dmem_area->second.dma_type != DMAType::Free ||
-           dmem_area->second.GetEnd() < mapping_end) {
-        // The current dmem_area isn't suitable, move to the next one.
-        dmem_area++;
-        if (dmem_area == dmem_map.end()) {
-            break;
-        }
-
-        // Update local variables based on the new dmem_area
-        mapping_start = Common::AlignUp(dmem_area->second.base, alignment);
-        mapping_end = mapping_start + size;
-    }
-
+    PAddr mapping_start;
+    const auto dmem_area = SearchFreeDmem(search_start, size, alignment, &mapping_start);
     if (dmem_area == dmem_map.end()) {
         // There are no suitable mappings in this range
         LOG_ERROR(Kernel_Vmm, "Unable to find free direct memory area: size = {:#x}", size);
@@ -225,10 +199,12 @@ PAddr MemoryManager::Allocate(PAddr search_start, PAddr search_end, u64 size, u6
 }
 
 void MemoryManager::Free(PAddr phys_addr, u64 size) {
-    std::scoped_lock lk{mutex};
+    std::scoped_lock unmap_lk{unmap_mutex};
 
     // Release any dmem mappings that reference this physical block.
     std::vector<std::pair<VAddr, u64>> remove_list;
+    std::vector<std::pair<VAddr, u64>> gpu_ranges;
+    std::shared_lock shared_lk{mutex};
     for (const auto& [addr, mapping] : vma_map) {
         if (mapping.type != VMAType::Direct) {
             continue;
@@ -245,6 +221,14 @@ void MemoryManager::Free(PAddr phys_addr, u64 size) {
             remove_list.emplace_back(addr_in_vma, size_in_vma);
         }
     }
+    for (const auto& [addr, size] : remove_list) {
+        const auto ranges = FindGpuMappedRanges(addr, size, false);
+        gpu_ranges.insert(gpu_ranges.end(), ranges.begin(), ranges.end());
+    }
+    shared_lk.unlock();
+    UnmapFromGpu(gpu_ranges);
+
+    std::scoped_lock lk{mutex};
     for (const auto& [addr, size] : remove_list) {
         UnmapMemoryImpl(addr, size);
     }
@@ -279,7 +263,8 @@ void MemoryManager::Free(PAddr phys_addr, u64 size) {
 s32 MemoryManager::PoolCommit(VAddr virtual_addr, u64 size, MemoryProt prot, s32 mtype) {
     ASSERT_MSG(IsValidMapping(virtual_addr, size), "Attempted to access invalid address {:#x}",
                virtual_addr);
-    std::scoped_lock lk{mutex};
+    std::scoped_lock unmap_lk{unmap_mutex};
+    std::unique_lock lk{mutex};
 
     // Input addresses to PoolCommit are treated as fixed, and have a constant alignment.
     const u64 alignment = 64_KB;
@@ -356,9 +341,8 @@ s32 MemoryManager::PoolCommit(VAddr virtual_addr, u64 size, MemoryProt prot, s32
     }
     ASSERT_MSG(remaining_size == 0, "Unable to map physical memory");
 
-    if (IsValidGpuMapping(mapped_addr, size)) {
-        rasterizer->MapMemory(mapped_addr, size);
-    }
+    lk.unlock();
+    MapToGpu(mapped_addr, size);
 
     return ORBIS_OK;
 }
@@ -376,42 +360,35 @@ s32 MemoryManager::MapMemory(void** out_addr, VAddr virtual_addr, u64 size, Memo
         return ORBIS_KERNEL_ERROR_EINVAL;
     }
 
-    std::scoped_lock lk{mutex};
+    // Maps are serialized with unmaps, so the GPU ranges below stay valid while the lock is
+    // released to notify the rasterizer, see UnmapFromGpu.
+    std::scoped_lock unmap_lk{unmap_mutex};
 
-    // Validate the requested physical address range
-    if (phys_addr != -1) {
-        if (total_direct_size < phys_addr + size) {
-            LOG_ERROR(Kernel_Vmm, "Unable to map {:#x} bytes at physical address {:#x}", size,
-                      phys_addr);
-            return ORBIS_KERNEL_ERROR_ENOMEM;
+    std::vector<std::pair<VAddr, u64>> gpu_ranges;
+    {
+        std::shared_lock lk{mutex};
+        if (s32 result = ValidateDmemRange(phys_addr, size, validate_dmem); result != ORBIS_OK) {
+            return result;
         }
 
-        // Validate direct memory areas involved in this call.
-        auto dmem_area = FindDmemArea(phys_addr);
-        while (dmem_area != dmem_map.end() && dmem_area->second.base < phys_addr + size) {
-            // If any requested dmem area is not allocated, return an error.
-            if (dmem_area->second.dma_type != DMAType::Allocated &&
-                dmem_area->second.dma_type != DMAType::Mapped) {
-                LOG_ERROR(Kernel_Vmm, "Unable to map {:#x} bytes at physical address {:#x}", size,
-                          phys_addr);
-                return ORBIS_KERNEL_ERROR_ENOMEM;
-            }
-
-            // If we need to perform extra validation, then check for Mapped dmem areas too.
-            if (validate_dmem && dmem_area->second.dma_type == DMAType::Mapped) {
-                LOG_ERROR(Kernel_Vmm, "Unable to map {:#x} bytes at physical address {:#x}", size,
-                          phys_addr);
-                return ORBIS_KERNEL_ERROR_EBUSY;
-            }
-
-            dmem_area++;
+        // A fixed mapping without NoOverwrite replaces whatever it overlaps.
+        if (True(flags & MemoryMapFlags::Fixed) && virtual_addr != 0 &&
+            False(flags & MemoryMapFlags::NoOverwrite)) {
+            ASSERT_MSG(IsValidMapping(virtual_addr, size),
+                       "Attempted to access invalid address {:#x}", virtual_addr);
+            gpu_ranges = FindGpuMappedRanges(virtual_addr, size, false);
         }
+    }
+    UnmapFromGpu(gpu_ranges);
 
-        // If the prior loop succeeds, we need to loop through again and carve out mapped dmas.
-        // This needs to be a separate loop to avoid modifying dmem map during failed calls.
+    std::unique_lock lk{mutex};
+
+    // Mark the requested physical address range as mapped
+    if (phys_addr != -1) {
+        // The range was validated above, carve out the mapped dmem areas.
         auto phys_addr_to_search = phys_addr;
         auto remaining_size = size;
-        dmem_area = FindDmemArea(phys_addr);
+        auto dmem_area = FindDmemArea(phys_addr);
         while (dmem_area != dmem_map.end() && remaining_size > 0) {
             // Carve a new dmem area in place of this one with the appropriate type.
             // Ensure the carved area only covers the current dmem area.
@@ -487,11 +464,8 @@ s32 MemoryManager::MapMemory(void** out_addr, VAddr virtual_addr, u64 size, Memo
         flexible_usage += size;
 
         // Find a suitable physical address
-        auto handle = fmem_map.begin();
-        while (handle != fmem_map.end() &&
-               (!handle->second.is_free || handle->second.size < size)) {
-            handle++;
-        }
+        const auto handle = fmem_free_index.FindFirst(
+            fmem_map, 0, size, [](const FlexibleMemoryArea&) { return true; });
 
         // Some games will end up fragmenting the flexible address space.
         ASSERT_MSG(handle != fmem_map.end() && handle->second.is_free,
@@ -529,13 +503,13 @@ s32 MemoryManager::MapMemory(void** out_addr, VAddr virtual_addr, u64 size, Memo
         // Just set out_addr to mapped_addr instead.
         *out_addr = std::bit_cast<void*>(mapped_addr);
     } else {
-        // If this is not a reservation, then map to GPU and address space
-        if (IsValidGpuMapping(mapped_addr, size)) {
-            rasterizer->MapMemory(mapped_addr, size);
-        }
+        // If this is not a reservation, then map to address space and GPU
         *out_addr = impl.Map(mapped_addr, size, alignment, phys_addr, is_exec);
 
         TRACK_ALLOC(*out_addr, size, "VMEM");
+
+        lk.unlock();
+        MapToGpu(mapped_addr, size);
     }
 
     return ORBIS_OK;
@@ -619,17 +593,26 @@ s32 MemoryManager::MapFile(void** out_addr, VAddr virtual_addr, u64 size, Memory
 s32 MemoryManager::PoolDecommit(VAddr virtual_addr, u64 size) {
     ASSERT_MSG(IsValidMapping(virtual_addr, size), "Attempted to access invalid address {:#x}",
                virtual_addr);
-    std::scoped_lock lk{mutex};
-
-    // Do an initial search to ensure this decommit is valid.
-    auto it = FindVMA(virtual_addr);
-    while (it != vma_map.end() && it->second.base + it->second.size <= virtual_addr + size) {
-        if (it->second.type != VMAType::PoolReserved && it->second.type != VMAType::Pooled) {
-            LOG_ERROR(Kernel_Vmm, "Attempting to decommit non-pooled memory!");
-            return ORBIS_KERNEL_ERROR_EINVAL;
+    std::scoped_lock unmap_lk{unmap_mutex};
+
+    std::vector<std::pair<VAddr, u64>> gpu_ranges;
+    {
+        std::shared_lock lk{mutex};
+
+        // Do an initial search to ensure this decommit is valid.
+        auto it = FindVMA(virtual_addr);
+        while (it != vma_map.end() && it->second.base + it->second.size <= virtual_addr + size) {
+            if (it->second.type != VMAType::PoolReserved && it->second.type != VMAType::Pooled) {
+                LOG_ERROR(Kernel_Vmm, "Attempting to decommit non-pooled memory!");
+                return ORBIS_KERNEL_ERROR_EINVAL;
+            }
+            it++;
         }
-        it++;
+        gpu_ranges = FindGpuMappedRanges(virtual_addr, size, true);
     }
+    UnmapFromGpu(gpu_ranges);
+
+    std::scoped_lock lk{mutex};
 
     // Loop through all vmas in the area, unmap them.
     u64 remaining_size = size;
@@ -642,11 +625,6 @@ s32 MemoryManager::PoolDecommit(VAddr virtual_addr, u64 size) {
         const auto size_in_vma = std::min<u64>(remaining_size, vma_base.size - start_in_vma);
 
         if (vma_base.type == VMAType::Pooled) {
-            // We always map PoolCommitted memory to GPU, so unmap when decomitting.
-            if (IsValidGpuMapping(current_addr, size_in_vma)) {
-                rasterizer->UnmapMemory(current_addr, size_in_vma);
-            }
-
             // Track how much pooled memory is decommitted
             pool_budget += size_in_vma;
 
@@ -685,17 +663,103 @@ s32 MemoryManager::PoolDecommit(VAddr virtual_addr, u64 size) {
 }
 
 s32 MemoryManager::UnmapMemory(VAddr virtual_addr, u64 size) {
-    std::scoped_lock lk{mutex};
     if (size == 0) {
         return ORBIS_OK;
     }
     virtual_addr = Common::AlignDown(virtual_addr, 16_KB);
     size = Common::AlignUp(size, 16_KB);
-    ASSERT_MSG(IsValidMapping(virtual_addr, size), "Attempted to access invalid address {:#x}",
-               virtual_addr);
+
+    std::scoped_lock unmap_lk{unmap_mutex};
+    std::vector<std::pair<VAddr, u64>> gpu_ranges;
+    {
+        std::shared_lock lk{mutex};
+        ASSERT_MSG(IsValidMapping(virtual_addr, size), "Attempted to access invalid address {:#x}",
+                   virtual_addr);
+        gpu_ranges = FindGpuMappedRanges(virtual_addr, size, false);
+    }
+    UnmapFromGpu(gpu_ranges);
+
+    std::scoped_lock lk{mutex};
     return UnmapMemoryImpl(virtual_addr, size);
 }
 
+std::vector<std::pair<VAddr, u64>> MemoryManager::FindGpuMappedRanges(VAddr virtual_addr,
+                                                                      u64 size, bool pooled_only) {
+    std::vector<std::pair<VAddr, u64>> ranges;
+    const VAddr end_addr = virtual_addr + size;
+    for (auto it = FindVMA(virtual_addr); it != vma_map.end() && it->second.base < end_addr;
+         ++it) {
+        const auto& vma = it->second;
+        const bool is_gpu_mapped =
+            pooled_only ? vma.type == VMAType::Pooled
+                        : vma.type != VMAType::Free && vma.type != VMAType::Reserved &&
+                              vma.type != VMAType::PoolReserved;
+        if (!is_gpu_mapped) {
+            continue;
+        }
+        const VAddr start = std::max(virtual_addr, vma.base);
+        const u64 range_size = std::min(end_addr, vma.base + vma.size) - start;
+        if (!IsValidGpuMapping(start, range_size)) {
+            continue;
+        }
+        if (!ranges.empty() && ranges.back().first + ranges.back().second == start) {
+            ranges.back().second += range_size;
+        } else {
+            ranges.emplace_back(start, range_size);
+        }
+    }
+    return ranges;
+}
+
+void MemoryManager::UnmapFromGpu(std::span<const std::pair<VAddr, u64>> ranges) {
+    if (!rasterizer) {
+        return;
+    }
+    for (const auto& [addr, size] : ranges) {
+        rasterizer->UnmapMemory(addr, size);
+    }
+}
+
+void MemoryManager::MapToGpu(VAddr virtual_addr, u64 size) {
+    // Tools such as the PM4 replay map guest memory without a rasterizer.
+    if (rasterizer && IsValidGpuMapping(virtual_addr, size)) {
+        rasterizer->MapMemory(virtual_addr, size);
+    }
+}
+
+s32 MemoryManager::ValidateDmemRange(PAddr phys_addr, u64 size, bool validate_dmem) {
+    if (phys_addr == -1) {
+        return ORBIS_OK;
+    }
+    if (total_direct_size < phys_addr + size) {
+        LOG_ERROR(Kernel_Vmm, "Unable to map {:#x} bytes at physical address {:#x}", size,
+                  phys_addr);
+        return ORBIS_KERNEL_ERROR_ENOMEM;
+    }
+
+    // Validate direct memory areas involved in this call.
+    auto dmem_area = FindDmemArea(phys_addr);
+    while (dmem_area != dmem_map.end() && dmem_area->second.base < phys_addr + size) {
+        // If any requested dmem area is not allocated, return an error.
+        if (dmem_area->second.dma_type != DMAType::Allocated &&
+            dmem_area->second.dma_type != DMAType::Mapped) {
+            LOG_ERROR(Kernel_Vmm, "Unable to map {:#x} bytes at physical address {:#x}", size,
+                      phys_addr);
+            return ORBIS_KERNEL_ERROR_ENOMEM;
+        }
+
+        // If we need to perform extra validation, then check for Mapped dmem areas too.
+        if (validate_dmem && dmem_area->second.dma_type == DMAType::Mapped) {
+            LOG_ERROR(Kernel_Vmm, "Unable to map {:#x} bytes at physical address {:#x}", size,
+                      phys_addr);
+            return ORBIS_KERNEL_ERROR_EBUSY;
+        }
+
+        dmem_area++;
+    }
+    return ORBIS_OK;
+}
+
 u64 MemoryManager::UnmapBytesFromEntry(VAddr virtual_addr, VirtualMemoryArea vma_base, u64 size) {
     const auto vma_base_addr = vma_base.base;
     const auto vma_base_size = vma_base.size;
@@ -763,12 +827,7 @@ u64 MemoryManager::UnmapBytesFromEntry(VAddr virtual_addr, VirtualMemoryArea vma
     MergeAdjacent(vma_map, new_it);
 
     if (type != VMAType::Reserved && type != VMAType::PoolReserved) {
-        // If this mapping has GPU access, unmap from GPU.
-        if (IsValidGpuMapping(virtual_addr, size)) {
-            rasterizer->UnmapMemory(virtual_addr, size);
-        }
-
-        // Unmap the memory region.
+        // Unmap the memory region. Callers already released it from the GPU, see UnmapFromGpu.
         impl.Unmap(vma_base_addr, vma_base_size, start_in_vma, start_in_vma + adjusted_size,
                    phys_base, is_exec, has_backing, readonly_file);
         TRACK_FREE(virtual_addr, "VMEM");
@@ -792,7 +851,7 @@ s32 MemoryManager::UnmapMemoryImpl(VAddr virtual_addr, u64 size) {
 
 s32 MemoryManager::QueryProtection(VAddr addr, void** start, void** end, u32* prot) {
     ASSERT_MSG(IsValidMapping(addr), "Attempted to access invalid address {:#x}", addr);
-    std::scoped_lock lk{mutex};
+    std::shared_lock lk{mutex};
 
     const auto it = FindVMA(addr);
     const auto& vma = it->second;
@@ -909,7 +968,7 @@ s32 MemoryManager::Protect(VAddr addr, u64 size, MemoryProt prot) {
 
 s32 MemoryManager::VirtualQuery(VAddr addr, s32 flags,
                                 ::Libraries::Kernel::OrbisVirtualQueryInfo* info) {
-    std::scoped_lock lk{mutex};
+    std::shared_lock lk{mutex};
 
     // FindVMA on addresses before the vma_map return garbage data.
     auto query_addr =
@@ -962,7 +1021,7 @@ s32 MemoryManager::VirtualQuery(VAddr addr, s32 flags,
 
 s32 MemoryManager::DirectMemoryQuery(PAddr addr, bool find_next,
                                      ::Libraries::Kernel::OrbisQueryInfo* out_info) {
-    std::scoped_lock lk{mutex};
+    std::shared_lock lk{mutex};
 
     if (addr >= total_direct_size) {
         LOG_WARNING(Kernel_Vmm, "Unable to find allocated direct memory region to query!");
@@ -997,7 +1056,7 @@ s32 MemoryManager::DirectMemoryQuery(PAddr addr, bool find_next,
 
 s32 MemoryManager::DirectQueryAvailable(PAddr search_start, PAddr search_end, u64 alignment,
                                         PAddr* phys_addr_out, u64* size_out) {
-    std::scoped_lock lk{mutex};
+    std::shared_lock lk{mutex};
 
     auto dmem_area = FindDmemArea(search_start);
     PAddr paddr{};
@@ -1120,6 +1179,8 @@ void MemoryManager::NameVirtualRange(VAddr virtual_addr, u64 size, std::string_v
 
 s32 MemoryManager::GetDirectMemoryType(PAddr addr, s32* directMemoryTypeOut,
                                        void** directMemoryStartOut, void** directMemoryEndOut) {
+    std::shared_lock lk{mutex};
+
     if (addr >= total_direct_size) {
         LOG_ERROR(Kernel_Vmm, "Unable to find allocated direct memory region to check type!");
         return ORBIS_KERNEL_ERROR_ENOENT;
@@ -1139,6 +1200,8 @@ s32 MemoryManager::GetDirectMemoryType(PAddr addr, s32* directMemoryTypeOut,
 
 s32 MemoryManager::IsStack(VAddr addr, void** start, void** end) {
     ASSERT_MSG(IsValidMapping(addr), "Attempted to access invalid address {:#x}", addr);
+    std::shared_lock lk{mutex};
+
     const auto& vma = FindVMA(addr)->second;
     if (vma.IsFree()) {
         return ORBIS_KERNEL_ERROR_EACCES;
@@ -1163,7 +1226,7 @@ s32 MemoryManager::IsStack(VAddr addr, void** start, void** end) {
 }
 
 s32 MemoryManager::GetMemoryPoolStats(::Libraries::Kernel::OrbisKernelMemoryPoolBlockStats* stats) {
-    std::scoped_lock lk{mutex};
+    std::shared_lock lk{mutex};
 
     // Run through dmem_map, determine how much physical memory is currently committed
     constexpr u64 block_size = 64_KB;
@@ -1213,36 +1276,22 @@ VAddr MemoryManager::SearchFree(VAddr virtual_addr, u64 size, u32 alignment) {
         return virtual_addr;
     }
 
-    // If we didn't hit the return above, then we know the current VMA isn't suitable
-    it++;
-
-    // Search for the first free VMA that fits our mapping.
-    while (it != vma_map.end()) {
-        if (!it->second.IsFree()) {
-            it++;
-            continue;
-        }
-
-        const auto& vma = it->second;
-        virtual_addr = Common::AlignUp(vma.base, alignment);
-        // Sometimes the alignment itself might be larger than the VMA.
-        if (virtual_addr > vma.base + vma.size) {
-            it++;
-            continue;
-        }
-
-        // Make sure the address is within our defined bounds
-        if (virtual_addr >= max_search_address) {
-            // There are no free mappings within our safely usable address space.
-            break;
-        }
-
-        // If there's enough space in the VMA, return the address.
-        const u64 remaining_size = vma.base + vma.size - virtual_addr;
-        if (remaining_size >= size) {
+    // If we didn't hit the return above, then we know the current VMA isn't suitable.
+    // Search for the first free VMA after it that fits our mapping.
+    it = vma_free_index.FindFirst(
+        vma_map, it->second.base + it->second.size, size, [&](const VirtualMemoryArea& vma) {
+            // Sometimes the alignment itself might be larger than the VMA.
+            const VAddr aligned_addr = Common::AlignUp(vma.base, alignment);
+            return aligned_addr <= vma.base + vma.size &&
+                   vma.base + vma.size - aligned_addr >= size;
+        });
+
+    // Make sure the address is within our defined bounds
+    if (it != vma_map.end()) {
+        virtual_addr = Common::AlignUp(it->second.base, alignment);
+        if (virtual_addr < max_search_address) {
             return virtual_addr;
         }
-        it++;
     }
 
     // Couldn't find a suitable VMA, return an error.
@@ -1251,6 +1300,27 @@ VAddr MemoryManager::SearchFree(VAddr virtual_addr, u64 size, u32 alignment) {
     return -1;
 }
 
+MemoryManager::DMemHandle MemoryManager::SearchFreeDmem(PAddr search_start, u64 size,
+                                                        u64 alignment, PAddr* mapping_start) {
+    // The area containing search_start is the only one where the mapping can't start at its base.
+    const auto dmem_area = FindDmemArea(search_start);
+    const auto& area = dmem_area->second;
+    *mapping_start = Common::AlignUp(std::max(search_start, area.base), alignment);
+    if (area.IsFree() && area.GetEnd() >= *mapping_start + size) {
+        return dmem_area;
+    }
+
+    // Find the first free, large enough dmem area after it.
+    const auto handle = dmem_free_index.FindFirst(
+        dmem_map, area.GetEnd(), size, [&](const DirectMemoryArea& candidate) {
+            return candidate.GetEnd() >= Common::AlignUp(candidate.base, alignment) + size;
+        });
+    if (handle != dmem_map.end()) {
+        *mapping_start = Common::AlignUp(handle->second.base, alignment);
+    }
+    return handle;
+}
+
 MemoryManager::VMAHandle MemoryManager::CarveVMA(VAddr virtual_addr, u64 size) {
     auto vma_handle = FindVMA(virtual_addr);
 
@@ -1332,6 +1402,7 @@ MemoryManager::VMAHandle MemoryManager::Split(VMAHandle vma_handle, u64 offset_i
     ASSERT(offset_in_vma < old_vma.size && offset_in_vma > 0);
 
     auto new_vma = old_vma;
+    vma_free_index.Erase(old_vma);
     old_vma.size = offset_in_vma;
     new_vma.base += offset_in_vma;
     new_vma.size -= offset_in_vma;
@@ -1339,6 +1410,8 @@ MemoryManager::VMAHandle MemoryManager::Split(VMAHandle vma_handle, u64 offset_i
     if (HasPhysicalBacking(new_vma)) {
         new_vma.phys_base += offset_in_vma;
     }
+    vma_free_index.Insert(old_vma);
+    vma_free_index.Insert(new_vma);
     return vma_map.emplace_hint(std::next(vma_handle), new_vma.base, new_vma);
 }
 
@@ -1347,11 +1420,14 @@ MemoryManager::DMemHandle MemoryManager::Split(DMemHandle dmem_handle, u64 offse
     ASSERT(offset_in_area < old_area.size && offset_in_area > 0);
 
     auto new_area = old_area;
+    dmem_free_index.Erase(old_area);
     old_area.size = offset_in_area;
     new_area.memory_type = old_area.memory_type;
     new_area.base += offset_in_area;
     new_area.size -= offset_in_area;
 
+    dmem_free_index.Insert(old_area);
+    dmem_free_index.Insert(new_area);
     return dmem_map.emplace_hint(std::next(dmem_handle), new_area.base, new_area);
 }
 
@@ -1360,10 +1436,13 @@ MemoryManager::FMemHandle MemoryManager::Split(FMemHandle fmem_handle, u64 offse
     ASSERT(offset_in_area < old_area.size && offset_in_area > 0);
 
     auto new_area = old_area;
+    fmem_free_index.Erase(old_area);
     old_area.size = offset_in_area;
     new_area.base += offset_in_area;
     new_area.size -= offset_in_area;
 
+    fmem_free_index.Insert(old_area);
+    fmem_free_index.Insert(new_area);
     return fmem_map.emplace_hint(std::next(fmem_handle), new_area.base, new_area);
 }
 
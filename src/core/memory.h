@@ -3,8 +3,13 @@
 
 #pragma once
 
+#include <array>
+#include <bit>
 #include <map>
 #include <mutex>
+#include <set>
+#include <shared_mutex>
+#include <span>
 #include <string>
 #include <string_view>
 #include "common/enum.h"
@@ -84,6 +89,10 @@ struct DirectMemoryArea {
         return base + size;
     }
 
+    bool IsFree() const noexcept {
+        return dma_type == DMAType::Free;
+    }
+
     bool CanMergeWith(const DirectMemoryArea& next) const {
         if (base + size != next.base) {
             return false;
@@ -107,6 +116,10 @@ struct FlexibleMemoryArea {
         return base + size;
     }
 
+    bool IsFree() const noexcept {
+        return is_free;
+    }
+
     bool CanMergeWith(const FlexibleMemoryArea& next) const {
         if (base + size != next.base) {
             return false;
@@ -159,6 +172,72 @@ struct VirtualMemoryArea {
     }
 };
 
+/**
+ * Index of the free areas of an address map. Free areas are bucketed by the power of two of their
+ * size and sorted by base address inside each bucket, so a first-fit search only visits areas that
+ * are large enough for the request instead of walking the whole map.
+ * Areas have to be erased before they are resized and inserted again afterwards. Areas that stop
+ * being free in place are dropped lazily when a search runs into them.
+ */
+template <typename Map>
+class FreeAreaIndex {
+public:
+    using Handle = typename Map::iterator;
+    using Area = typename Map::mapped_type;
+
+    void Clear() {
+        for (auto& bucket : buckets) {
+            bucket.clear();
+        }
+    }
+
+    void Insert(const Area& area) {
+        if (area.IsFree() && area.size != 0) {
+            buckets[GetBucket(area.size)].insert(area.base);
+        }
+    }
+
+    void Erase(const Area& area) {
+        if (area.size != 0) {
+            buckets[GetBucket(area.size)].erase(area.base);
+        }
+    }
+
+    /// Returns the free area with the lowest base address not below min_base that is at least
+    /// size bytes long and for which fits returns true, or map.end() if there is none.
+    template <typename Func>
+    Handle FindFirst(Map& map, u64 min_base, u64 size, Func&& fits) {
+        Handle best = map.end();
+        for (size_t i = size != 0 ? GetBucket(size) : 0; i < buckets.size(); ++i) {
+            auto& bucket = buckets[i];
+            for (auto it = bucket.lower_bound(min_base); it != bucket.end();) {
+                if (best != map.end() && *it >= best->first) {
+                    break;
+                }
+                const auto area = map.find(*it);
+                if (area == map.end() || !area->second.IsFree() ||
+                    GetBucket(area->second.size) != i) {
+                    it = bucket.erase(it);
+                    continue;
+                }
+                if (area->second.size >= size && fits(area->second)) {
+                    best = area;
+                    break;
+                }
+                ++it;
+            }
+        }
+        return best;
+    }
+
+private:
+    static size_t GetBucket(u64 size) {
+        return std::bit_width(size) - 1;
+    }
+
+    std::array<std::set<u64>, 64> buckets;
+};
+
 class MemoryManager {
     using DMemMap = std::map<PAddr, DirectMemoryArea>;
     using DMemHandle = DMemMap::iterator;
@@ -308,10 +387,26 @@ private:
         return std::prev(fmem_map.upper_bound(target));
     }
 
+    FreeAreaIndex<DMemMap>& GetFreeIndex(DMemMap&) {
+        return dmem_free_index;
+    }
+
+    FreeAreaIndex<FMemMap>& GetFreeIndex(FMemMap&) {
+        return fmem_free_index;
+    }
+
+    FreeAreaIndex<VMAMap>& GetFreeIndex(VMAMap&) {
+        return vma_free_index;
+    }
+
     template <typename Handle>
     Handle MergeAdjacent(auto& handle_map, Handle iter) {
+        auto& free_index = GetFreeIndex(handle_map);
+        free_index.Erase(iter->second);
+
         const auto next_vma = std::next(iter);
         if (next_vma != handle_map.end() && iter->second.CanMergeWith(next_vma->second)) {
+            free_index.Erase(next_vma->second);
             iter->second.size += next_vma->second.size;
             handle_map.erase(next_vma);
         }
@@ -319,12 +414,14 @@ private:
         if (iter != handle_map.begin()) {
             auto prev_vma = std::prev(iter);
             if (prev_vma->second.CanMergeWith(iter->second)) {
+                free_index.Erase(prev_vma->second);
                 prev_vma->second.size += iter->second.size;
                 handle_map.erase(iter);
                 iter = prev_vma;
             }
         }
 
+        free_index.Insert(iter->second);
         return iter;
     }
 
@@ -335,6 +432,8 @@ private:
 
     VAddr SearchFree(VAddr virtual_addr, u64 size, u32 alignment);
 
+    DMemHandle SearchFreeDmem(PAddr search_start, u64 size, u64 alignment, PAddr* mapping_start);
+
     VMAHandle CarveVMA(VAddr virtual_addr, u64 size);
 
     DMemHandle CarveDmemArea(PAddr addr, u64 size);
@@ -351,12 +450,37 @@ private:
 
     s32 UnmapMemoryImpl(VAddr virtual_addr, u64 size);
 
+    /// Returns the parts of the range that are mapped to the GPU, merged when adjacent.
+    std::vector<std::pair<VAddr, u64>> FindGpuMappedRanges(VAddr virtual_addr, u64 size,
+                                                           bool pooled_only);
+
+    /// Releases ranges from the GPU caches. This may wait for the GPU thread, which takes the
+    /// lock to read guest memory, so it must be called without holding it.
+    void UnmapFromGpu(std::span<const std::pair<VAddr, u64>> ranges);
+
+    /// Registers a new mapping with the GPU caches. Called without holding the lock, for the same
+    /// reason as UnmapFromGpu.
+    void MapToGpu(VAddr virtual_addr, u64 size);
+
+    /// Checks that the physical range of a direct mapping is allocated, and unmapped if requested.
+    s32 ValidateDmemRange(PAddr phys_addr, u64 size, bool validate_dmem);
+
 private:
     AddressSpace impl;
     DMemMap dmem_map;
     FMemMap fmem_map;
     VMAMap vma_map;
-    std::mutex mutex;
+    FreeAreaIndex<DMemMap> dmem_free_index;
+    FreeAreaIndex<FMemMap> fmem_free_index;
+    FreeAreaIndex<VMAMap> vma_free_index;
+    /// Queries and guest memory reads take the lock shared, changes to the maps take it
+    /// exclusive. The glibc rwlock behind std::shared_mutex prefers readers, so a steady stream of
+    /// overlapping readers could delay a writer. Readers only hold it for a lookup or a single
+    /// copy, so it is released between every call and writers get through in practice.
+    std::shared_mutex mutex;
+    /// Serializes maps and unmaps, so the ranges handed to the GPU caches stay valid while the
+    /// lock above is released to notify them.
+    std::mutex unmap_mutex;
     u64 total_direct_size{};
     u64 total_flexible_size{};
     u64 flexible_usage{};
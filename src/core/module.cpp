@@ -226,12 +226,12 @@ void Module::LoadModuleToMemory(u32& max_tls_index) {
     const VAddr entry_addr = base_virtual_addr + elf.GetElfEntry();
     LOG_INFO(Core_Linker, "program entry addr ..........: {:#018x}", entry_addr);
 
-    if (MemoryPatcher::g_eboot_address == 0) {
-        if (name == "eboot.bin") {
-            MemoryPatcher::g_eboot_address = base_virtual_addr;
-            MemoryPatcher::g_eboot_image_size = base_size;
-            MemoryPatcher::OnGameLoaded();
-        }
+    if (name != "eboot.bin") {
+        MemoryPatcher::OnModuleLoaded(base_virtual_addr, base_size);
+    } else if (MemoryPatcher::g_eboot_address == 0) {
+        MemoryPatcher::g_eboot_address = base_virtual_addr;
+        MemoryPatcher::g_eboot_image_size = base_size;
+        MemoryPatcher::OnGameLoaded();
     }
 }
 
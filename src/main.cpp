@@ -12,6 +12,8 @@
 #include <fmt/core.h>
 #include "common/config.h"
 #include "common/logging/backend.h"
+#include "common/logging/binary_log.h"
+#include "common/logging/text_formatter.h"
 #include "common/memory_patcher.h"
 #include "common/path_util.h"
 #include "core/debugger.h"
@@ -62,6 +64,8 @@ int main(int argc, char* argv[]) {
                     "  --set-addon-folder <folder>   Sets the addon folder to the config.\n"
                     "  --log-append                  Append log output to file instead of "
                     "overwriting it.\n"
+                    "  --decode-log <file>           Print a log written with the binary log "
+                    "type as text.\n"
                     "  --override-root <folder>      Override the game root folder. Default is the "
                     "parent of game path\n"
                     "  --wait-for-debugger           Wait for debugger to attach\n"
@@ -161,6 +165,22 @@ int main(int argc, char* argv[]) {
              exit(0);
          }},
         {"--log-append", [&](int& i) { Common::Log::SetAppend(); }},
+        {"--decode-log",
+         [&](int& i) {
+             if (++i >= argc) {
+                 std::cerr << "Error: Missing argument for --decode-log\n";
+                 exit(1);
+             }
+             const bool decoded = Common::Log::BinaryLog::Decode(
+                 argv[i], [](const Common::Log::Entry& entry) {
+                     std::cout << Common::Log::FormatLogMessage(entry) << '\n';
+                 });
+             if (!decoded) {
+                 std::cerr << "Error: Failed to decode log file: " << argv[i] << "\n";
+                 exit(1);
+             }
+             exit(0);
+         }},
         {"--config-clean", [&](int& i) { Config::setConfigMode(Config::ConfigMode::Clean); }},
         {"--config-global", [&](int& i) { Config::setConfigMode(Config::ConfigMode::Global); }},
         {"--override-root",
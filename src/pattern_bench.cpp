@@ -0,0 +1,158 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+// Benchmark of the memory patch pattern scanner. Builds a synthetic image with the byte
+// distribution of x86 code, scans it for many wildcard signatures in a single pass and checks a
+// sample of the results against a naive per-pattern search.
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <chrono>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fmt/core.h>
+#include "common/pattern_scanner.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t ImageSize = 64_MB;
+
+/// Bytes that make up most of compiled x86 code, the scanner anchors are chosen to avoid them.
+constexpr std::array<u8, 16> CommonBytes = {0x00, 0x48, 0x8B, 0x89, 0xFF, 0xE8, 0x0F, 0x83,
+                                            0xC7, 0x45, 0x24, 0x4C, 0x85, 0xC0, 0x74, 0x75};
+
+struct Signature {
+    std::string text;
+    std::vector<std::optional<u8>> bytes; ///< Wildcard bytes are empty
+    size_t index{};
+};
+
+void PrintUsage() {
+    std::cout << "Usage: shadps4-pattern-bench [options]\n"
+                 "Options:\n"
+                 "  -p, --patterns <count>    Number of signatures to search for (default: 300)\n"
+                 "  -v, --verify <count>      Number of results to check with a naive search "
+                 "(default: 20)\n"
+                 "  -h, --help                Display this help message\n";
+}
+
+/// Parses a positive number, returns false if the text isn't one.
+bool ParseCount(std::string_view text, u32& out) {
+    const auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), out);
+    return ec == std::errc{} && end == text.data() + text.size() && out > 0;
+}
+
+double ElapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+uintptr_t NaiveScan(const Signature& signature, std::span<const u8> image) {
+    const auto& bytes = signature.bytes;
+    for (size_t pos = 0; pos + bytes.size() <= image.size(); ++pos) {
+        bool match = true;
+        for (size_t i = 0; i < bytes.size() && match; ++i) {
+            match = !bytes[i] || image[pos + i] == *bytes[i];
+        }
+        if (match) {
+            return reinterpret_cast<uintptr_t>(image.data() + pos);
+        }
+    }
+    return 0;
+}
+
+} // Anonymous namespace
+
+int main(int argc, char* argv[]) {
+    u32 num_patterns = 300;
+    u32 num_verify = 20;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (arg == "-h" || arg == "--help") {
+            PrintUsage();
+            return 0;
+        } else if ((arg == "-p" || arg == "--patterns") && has_value) {
+            if (!ParseCount(argv[++i], num_patterns)) {
+                std::cerr << "Invalid number of patterns: " << argv[i] << "\n";
+                return 1;
+            }
+        } else if ((arg == "-v" || arg == "--verify") && has_value) {
+            if (!ParseCount(argv[++i], num_verify)) {
+                std::cerr << "Invalid number of results to verify: " << argv[i] << "\n";
+                return 1;
+            }
+        } else {
+            std::cerr << "Unknown argument: " << arg << "\n";
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    // Three quarters of the bytes come from the common set, the rest are uniform.
+    std::mt19937_64 rng{42};
+    std::vector<u8> image(ImageSize);
+    for (u8& byte : image) {
+        const u64 r = rng();
+        byte = (r & 3) != 0 ? CommonBytes[(r >> 8) & 0xF] : static_cast<u8>(r >> 16);
+    }
+
+    // Every fourth signature is random and most likely absent, so the scan reads the whole image.
+    std::vector<Signature> signatures(num_patterns);
+    for (u32 k = 0; k < num_patterns; ++k) {
+        auto& signature = signatures[k];
+        const size_t length = 8 + rng() % 16;
+        const size_t offset = rng() % (image.size() - length);
+        const bool present = k % 4 != 0;
+        for (size_t i = 0; i < length; ++i) {
+            const bool wildcard = i > 0 && rng() % 4 == 0;
+            const u8 value = present ? image[offset + i] : static_cast<u8>(rng());
+            if (wildcard) {
+                signature.text += "?? ";
+                signature.bytes.emplace_back();
+            } else {
+                signature.text += fmt::format("{:02X} ", value);
+                signature.bytes.emplace_back(value);
+            }
+        }
+    }
+
+    Common::PatternScanner scanner;
+    const auto scan_start = Clock::now();
+    for (auto& signature : signatures) {
+        signature.index = scanner.AddPattern(signature.text);
+    }
+    scanner.Scan(image);
+    const double scan_ms = ElapsedMs(scan_start);
+
+    const u32 verified = std::min(num_verify, num_patterns);
+    u32 num_found{};
+    u32 num_mismatched{};
+    const auto naive_start = Clock::now();
+    for (u32 k = 0; k < verified; ++k) {
+        const uintptr_t expected = NaiveScan(signatures[k], image);
+        const uintptr_t result = scanner.GetResult(signatures[k].index);
+        if (result != expected) {
+            fmt::print(stderr, "Pattern {} matched at {:#x}, expected {:#x}\n", k, result,
+                       expected);
+            ++num_mismatched;
+        }
+    }
+    const double naive_ms = ElapsedMs(naive_start);
+    for (const auto& signature : signatures) {
+        num_found += scanner.GetResult(signature.index) != 0;
+    }
+
+    fmt::print("{} patterns, {} found: single pass {:.1f} ms\n", num_patterns, num_found, scan_ms);
+    fmt::print("Naive search of {} patterns: {:.1f} ms ({:.1f} ms per pattern), {} mismatches\n",
+               verified, naive_ms, naive_ms / verified, num_mismatched);
+    return num_mismatched == 0 ? 0 : 1;
+}
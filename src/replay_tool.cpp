@@ -0,0 +1,216 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+// Headless PM4 replay. Feeds the frames of a capture written by the "Capture to file" devtools
+// option back through the command processor, without a game, a window or a Vulkan device. The
+// command processor runs without a rasterizer, so the timings measure the CPU cost of processing
+// the command streams.
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <boost/icl/interval_set.hpp>
+
+#include <fmt/core.h>
+#include "common/alignment.h"
+#include "common/config.h"
+#include "common/logging/backend.h"
+#include "common/path_util.h"
+#include "core/libraries/kernel/memory.h"
+#include "core/memory.h"
+#include "video_core/amdgpu/liverpool.h"
+#include "video_core/amdgpu/pm4_capture.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr u64 PageSize = 16_KB;
+
+void PrintUsage() {
+    std::cout << "Usage: shadps4-replay [options] <capture file>\n"
+                 "Options:\n"
+                 "  -n, --loops <count>       Number of times to replay the capture (default: 1)\n"
+                 "  -t, --timeout <ms>        Time to wait for a frame to finish (default: 5000)\n"
+                 "  -h, --help                Display this help message\n";
+}
+
+/// Parses a positive number, returns false if the text isn't one.
+bool ParseCount(std::string_view text, u32& out) {
+    const auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), out);
+    return ec == std::errc{} && end == text.data() + text.size() && out > 0;
+}
+
+/// Returns the guest ranges the capture writes to, aligned to pages.
+boost::icl::interval_set<VAddr> GetCaptureRanges(const AmdGpu::Capture::CaptureData& capture) {
+    using Interval = boost::icl::interval_set<VAddr>::interval_type;
+    boost::icl::interval_set<VAddr> ranges;
+    const auto add = [&](VAddr address, u64 size) {
+        ranges += Interval::right_open(Common::AlignDown(address, PageSize),
+                                       Common::AlignUp(address + size, PageSize));
+    };
+    for (const auto& frame : capture.frames) {
+        for (const auto& block : frame.memory) {
+            add(block.address, block.data.size());
+        }
+        for (const auto& label : frame.labels) {
+            add(label.address, label.size);
+        }
+    }
+    return ranges;
+}
+
+} // Anonymous namespace
+
+int main(int argc, char* argv[]) {
+    const auto user_dir = Common::FS::GetUserPath(Common::FS::PathType::UserDir);
+    Config::load(user_dir / "config.toml");
+
+    u32 num_loops = 1;
+    u32 timeout_ms = 5000;
+    std::filesystem::path capture_path;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (arg == "-h" || arg == "--help") {
+            PrintUsage();
+            return 0;
+        } else if ((arg == "-n" || arg == "--loops") && has_value) {
+            if (!ParseCount(argv[++i], num_loops)) {
+                std::cerr << "Invalid number of loops: " << argv[i] << "\n";
+                PrintUsage();
+                return 1;
+            }
+        } else if ((arg == "-t" || arg == "--timeout") && has_value) {
+            if (!ParseCount(argv[++i], timeout_ms)) {
+                std::cerr << "Invalid timeout: " << argv[i] << "\n";
+                PrintUsage();
+                return 1;
+            }
+        } else if (capture_path.empty() && !arg.starts_with('-')) {
+            capture_path = arg;
+        } else {
+            std::cerr << "Unknown argument: " << arg << "\n";
+            PrintUsage();
+            return 1;
+        }
+    }
+    if (capture_path.empty()) {
+        PrintUsage();
+        return 1;
+    }
+
+    Common::Log::Initialize("replay_tool.log");
+    Common::Log::Start();
+
+    AmdGpu::Capture::CaptureData capture;
+    if (!AmdGpu::Capture::Load(capture_path, capture)) {
+        fmt::print(stderr, "Failed to load capture {}\n", capture_path.string());
+        return 1;
+    }
+
+    // Back the captured guest ranges with flexible memory at their original addresses.
+    const auto ranges = GetCaptureRanges(capture);
+    auto* memory = Core::Memory::Instance();
+    const u64 flexible_size =
+        std::max(ORBIS_FLEXIBLE_MEMORY_SIZE, ORBIS_FLEXIBLE_MEMORY_BASE + ranges.size());
+    memory->SetupMemoryRegions(flexible_size, false, false);
+    for (const auto& range : ranges) {
+        void* out_addr{};
+        const s32 result =
+            memory->MapMemory(&out_addr, range.lower(), range.upper() - range.lower(),
+                              Core::MemoryProt::CpuReadWrite | Core::MemoryProt::GpuReadWrite,
+                              Core::MemoryMapFlags::Fixed, Core::VMAType::Flexible, "pm4_replay");
+        if (result != 0) {
+            fmt::print(stderr, "Failed to map {:#x} - {:#x}\n", range.lower(), range.upper());
+            return 1;
+        }
+    }
+
+    auto liverpool = std::make_unique<AmdGpu::Liverpool>();
+    liverpool->LoadCaptureState(*capture.state);
+    if (Config::copyGPUCmdBuffers()) {
+        liverpool->ReserveCopyBufferSpace();
+    }
+
+    // Compute queues are indexed by virtual queue id, map them in order.
+    u32 num_queues{};
+    for (const auto& queue : capture.queues) {
+        num_queues = std::max(num_queues, queue.vqid);
+    }
+    std::vector<u32> read_ptrs(num_queues);
+    for (u32 vqid = 1; vqid <= num_queues; ++vqid) {
+        const auto it =
+            std::ranges::find(capture.queues, vqid, &AmdGpu::Capture::ComputeQueue::vqid);
+        const bool found = it != capture.queues.end();
+        liverpool->asc_queues.insert(found ? it->ring_addr : 0, &read_ptrs[vqid - 1],
+                                     found ? it->ring_size_dw : 1, found ? it->pipe_id : 0);
+    }
+
+    fmt::print("Replaying {} frames, {} loops, {} compute queues, {} KB of guest memory\n",
+               capture.frames.size(), num_loops, num_queues, ranges.size() / 1_KB);
+
+    std::vector<double> frame_ms(capture.frames.size());
+    size_t num_packets_dw{};
+    for (const auto& frame : capture.frames) {
+        for (const auto& submit : frame.submits) {
+            num_packets_dw += submit.dcb.size() + submit.ccb.size();
+        }
+    }
+
+    const auto timeout = std::chrono::milliseconds{timeout_ms};
+    for (u32 loop = 0; loop < num_loops; ++loop) {
+        for (size_t i = 0; i < capture.frames.size(); ++i) {
+            const auto& frame = capture.frames[i];
+            for (const auto& block : frame.memory) {
+                std::memcpy(reinterpret_cast<void*>(block.address), block.data.data(),
+                            block.data.size());
+            }
+            // Waits on the CPU or the flip can't be satisfied during replay, pass them upfront.
+            for (const auto& label : frame.labels) {
+                label.Satisfy();
+            }
+
+            const auto start_time = Clock::now();
+            for (const auto& submit : frame.submits) {
+                if (submit.vqid == AmdGpu::Liverpool::GfxQueueId) {
+                    liverpool->SubmitGfx(submit.dcb, submit.ccb);
+                } else {
+                    liverpool->SubmitAsc(submit.vqid, submit.dcb);
+                }
+            }
+            liverpool->SubmitDone();
+            while (!liverpool->IsGpuIdle()) {
+                if (Clock::now() - start_time > timeout) {
+                    // The command processor is stuck on a wait, don't join its thread.
+                    fmt::print(stderr, "Frame {} did not finish within {} ms\n", i, timeout_ms);
+                    std::exit(1);
+                }
+                std::this_thread::yield();
+            }
+            const std::chrono::duration<double, std::milli> elapsed = Clock::now() - start_time;
+            frame_ms[i] += elapsed.count();
+        }
+    }
+
+    double total_ms{};
+    for (size_t i = 0; i < frame_ms.size(); ++i) {
+        const double average_ms = frame_ms[i] / num_loops;
+        fmt::print("Frame {:>3}: {:8.3f} ms ({} submits)\n", i, average_ms,
+                   capture.frames[i].submits.size());
+        total_ms += frame_ms[i];
+    }
+    const double loop_ms = total_ms / num_loops;
+    fmt::print("Average per loop: {:.3f} ms, {:.1f} MDW/s of PM4\n", loop_ms,
+               loop_ms > 0 ? num_packets_dw / (loop_ms * 1000.0) : 0.0);
+    return 0;
+}
@@ -5,6 +5,7 @@
 
 #include <optional>
 #include <vector>
+#include "common/hash.h"
 #include "common/types.h"
 #include "shader_recompiler/info.h"
 
@@ -64,6 +65,16 @@ struct FetchShaderData {
                instance_offset_sgpr == other.instance_offset_sgpr;
     }
 
+    [[nodiscard]] u64 Hash() const {
+        u64 hash = HashCombine(u64(u8(vertex_offset_sgpr)), u64(u8(instance_offset_sgpr)));
+        for (const auto& attrib : attributes) {
+            hash = HashCombine(hash, (u64(attrib.semantic) << 32) | (attrib.dest_vgpr << 24) |
+                                         (attrib.num_elements << 16) | (attrib.sgpr_base << 8) |
+                                         attrib.dword_offset);
+        }
+        return hash;
+    }
+
     void Serialize(Serialization::Archive& ar) const;
     bool Deserialize(Serialization::Archive& buffer);
 };
@@ -10,6 +10,7 @@
 #include <vector>
 #include <boost/intrusive/list.hpp>
 #include <fmt/format.h>
+#include "common/scope_exit.h"
 #include "shader_recompiler/frontend/structured_control_flow.h"
 #include "shader_recompiler/frontend/translate/translate.h"
 #include "shader_recompiler/ir/ir_emitter.h"
@@ -806,7 +807,11 @@ private:
 IR::AbstractSyntaxList BuildASL(Common::ObjectPool<IR::Inst>& inst_pool,
                                 Common::ObjectPool<IR::Block>& block_pool, CFG& cfg, Info& info,
                                 const RuntimeInfo& runtime_info, const Profile& profile) {
-    Common::ObjectPool<Statement> stmt_pool{64};
+    // Statements are scratch data of the structurizer, reuse the pool of the calling thread.
+    thread_local Common::ObjectPool<Statement> stmt_pool{64};
+    SCOPE_EXIT {
+        stmt_pool.ReleaseContents();
+    };
     GotoPass goto_pass{cfg, stmt_pool};
     Statement& root{goto_pass.RootStatement()};
     IR::AbstractSyntaxList syntax_list;
@@ -0,0 +1,57 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <fmt/format.h>
+#include "shader_recompiler/pass_stats.h"
+
+namespace Shader {
+
+PassStatistics& PassStatistics::Instance() {
+    // Passes may run on several compile threads, so avoid lazy unsynchronized construction.
+    static PassStatistics instance;
+    return instance;
+}
+
+void PassStatistics::Record(std::string_view name, u64 time_ns, u64 insts_before,
+                            u64 insts_after, u64 allocations, u64 heap_allocations) {
+    std::scoped_lock lk{mutex};
+    auto it = std::ranges::find(passes, name, &PassStats::name);
+    if (it == passes.end()) {
+        it = passes.insert(passes.end(), PassStats{.name = name});
+    }
+    ++it->runs;
+    it->time_ns += time_ns;
+    it->insts_before += insts_before;
+    it->insts_after += insts_after;
+    it->allocations += allocations;
+    it->heap_allocations += heap_allocations;
+}
+
+void PassStatistics::Reset() {
+    std::scoped_lock lk{mutex};
+    passes.clear();
+}
+
+std::vector<PassStats> PassStatistics::Snapshot() const {
+    std::scoped_lock lk{mutex};
+    return passes;
+}
+
+std::string PassStatistics::ToJson() const {
+    const auto stats = Snapshot();
+    std::string json = "{\n  \"passes\": [";
+    for (size_t i = 0; i < stats.size(); ++i) {
+        const auto& pass = stats[i];
+        json += fmt::format("{}\n    {{\"name\": \"{}\", \"runs\": {}, \"time_ns\": {}, "
+                            "\"insts_before\": {}, \"insts_after\": {}, \"allocations\": {}, "
+                            "\"heap_allocations\": {}}}",
+                            i == 0 ? "" : ",", pass.name, pass.runs, pass.time_ns,
+                            pass.insts_before, pass.insts_after, pass.allocations,
+                            pass.heap_allocations);
+    }
+    json += "\n  ]\n}\n";
+    return json;
+}
+
+} // namespace Shader
@@ -0,0 +1,57 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "common/types.h"
+
+namespace Shader {
+
+struct PassStats {
+    std::string_view name;
+    u64 runs{};
+    u64 time_ns{};
+    u64 insts_before{};
+    u64 insts_after{};
+    u64 allocations{};      ///< Objects created in the instruction and block pools
+    u64 heap_allocations{}; ///< Pool chunks allocated from the heap
+};
+
+/**
+ * Aggregated cost of every recompiler pass across all translated shaders. Collection is off by
+ * default and can be toggled at any time, recording is thread-safe.
+ */
+class PassStatistics {
+public:
+    static PassStatistics& Instance();
+
+    [[nodiscard]] bool IsEnabled() const {
+        return enabled.load(std::memory_order_relaxed);
+    }
+
+    void SetEnabled(bool enable) {
+        enabled.store(enable, std::memory_order_relaxed);
+    }
+
+    void Record(std::string_view name, u64 time_ns, u64 insts_before, u64 insts_after,
+                u64 allocations, u64 heap_allocations);
+    void Reset();
+
+    /// Returns the statistics of all passes in execution order.
+    [[nodiscard]] std::vector<PassStats> Snapshot() const;
+
+    /// Serializes the statistics to JSON.
+    [[nodiscard]] std::string ToJson() const;
+
+private:
+    std::atomic<bool> enabled{};
+    mutable std::mutex mutex;
+    std::vector<PassStats> passes;
+};
+
+} // namespace Shader
@@ -1,11 +1,16 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <chrono>
+#include <optional>
+
+#include "common/scope_exit.h"
 #include "shader_recompiler/frontend/control_flow_graph.h"
 #include "shader_recompiler/frontend/decode.h"
 #include "shader_recompiler/frontend/structured_control_flow.h"
 #include "shader_recompiler/ir/passes/ir_passes.h"
 #include "shader_recompiler/ir/post_order.h"
+#include "shader_recompiler/pass_stats.h"
 #include "shader_recompiler/profile.h"
 #include "shader_recompiler/recompiler.h"
 
@@ -29,6 +34,14 @@ IR::BlockList GenerateBlocks(const IR::AbstractSyntaxList& syntax_list) {
     return blocks;
 }
 
+static u64 CountInstructions(const IR::Program& program) {
+    u64 num_insts{};
+    for (const IR::Block* block : program.blocks) {
+        num_insts += block->Instructions().size();
+    }
+    return num_insts;
+}
+
 IR::Program TranslateProgram(const std::span<const u32>& code, Pools& pools, Info& info,
                              RuntimeInfo& runtime_info, const Profile& profile) {
     // Ensure first instruction is expected.
@@ -39,53 +52,85 @@ IR::Program TranslateProgram(const std::span<const u32>& code, Pools& pools, Inf
 
     Gcn::GcnCodeSlice slice(code.data(), code.data() + code.size());
     Gcn::GcnDecodeContext decoder;
+    IR::Program program{info};
+
+    auto& stats = PassStatistics::Instance();
+    const bool collect_stats = stats.IsEnabled();
+    const auto run_pass = [&](std::string_view name, auto&& pass) {
+        if (!collect_stats) {
+            pass();
+            return;
+        }
+        const u64 insts_before = CountInstructions(program);
+        const u64 allocs_before = pools.NumAllocated();
+        const u64 chunks_before = pools.NumChunkAllocations();
+        const auto start_time = std::chrono::steady_clock::now();
+        pass();
+        const auto time = std::chrono::steady_clock::now() - start_time;
+        stats.Record(name, std::chrono::duration_cast<std::chrono::nanoseconds>(time).count(),
+                     insts_before, CountInstructions(program), pools.NumAllocated() - allocs_before,
+                     pools.NumChunkAllocations() - chunks_before);
+    };
 
     // Decode and save instructions
-    IR::Program program{info};
     program.ins_list.reserve(code.size());
-    while (!slice.atEnd()) {
-        program.ins_list.emplace_back(decoder.decodeInstruction(slice));
-    }
+    run_pass("Decode", [&] {
+        while (!slice.atEnd()) {
+            program.ins_list.emplace_back(decoder.decodeInstruction(slice));
+        }
+    });
 
     // Clear any previous pooled data.
     pools.ReleaseContents();
 
-    // Create control flow graph
-    Common::ObjectPool<Gcn::Block> gcn_block_pool{64};
-    Gcn::CFG cfg{gcn_block_pool, program.ins_list};
+    // Create control flow graph. The blocks only live during translation, so the pool is kept
+    // per thread and reused by the next shader translated on it.
+    thread_local Common::ObjectPool<Gcn::Block> gcn_block_pool{64};
+    SCOPE_EXIT {
+        gcn_block_pool.ReleaseContents();
+    };
+    std::optional<Gcn::CFG> cfg;
+    run_pass("BuildCFG", [&] { cfg.emplace(gcn_block_pool, program.ins_list); });
 
     // Structurize control flow graph and create program.
-    program.syntax_list =
-        Shader::Gcn::BuildASL(pools.inst_pool, pools.block_pool, cfg, info, runtime_info, profile);
-    program.blocks = GenerateBlocks(program.syntax_list);
-    program.post_order_blocks = Shader::IR::PostOrder(program.syntax_list.front());
+    run_pass("BuildASL", [&] {
+        program.syntax_list = Shader::Gcn::BuildASL(pools.inst_pool, pools.block_pool, *cfg, info,
+                                                    runtime_info, profile);
+        program.blocks = GenerateBlocks(program.syntax_list);
+        program.post_order_blocks = Shader::IR::PostOrder(program.syntax_list.front());
+    });
 
     // Run optimization passes
+    using namespace Shader::Optimization;
     if (!profile.support_float64) {
-        Shader::Optimization::LowerFp64ToFp32(program);
+        run_pass("LowerFp64ToFp32", [&] { LowerFp64ToFp32(program); });
     }
-    Shader::Optimization::SsaRewritePass(program.post_order_blocks);
-    Shader::Optimization::ConstantPropagationPass(program.post_order_blocks);
-    Shader::Optimization::IdentityRemovalPass(program.blocks);
+    run_pass("SsaRewritePass", [&] { SsaRewritePass(program.post_order_blocks); });
+    run_pass("ConstantPropagationPass",
+             [&] { ConstantPropagationPass(program.post_order_blocks); });
+    run_pass("IdentityRemovalPass", [&] { IdentityRemovalPass(program.blocks); });
     if (info.l_stage == LogicalStage::TessellationControl) {
-        Shader::Optimization::TessellationPreprocess(program, runtime_info);
-        Shader::Optimization::HullShaderTransform(program, runtime_info);
+        run_pass("TessellationPreprocess", [&] { TessellationPreprocess(program, runtime_info); });
+        run_pass("HullShaderTransform", [&] { HullShaderTransform(program, runtime_info); });
     } else if (info.l_stage == LogicalStage::TessellationEval) {
-        Shader::Optimization::TessellationPreprocess(program, runtime_info);
-        Shader::Optimization::DomainShaderTransform(program, runtime_info);
+        run_pass("TessellationPreprocess", [&] { TessellationPreprocess(program, runtime_info); });
+        run_pass("DomainShaderTransform", [&] { DomainShaderTransform(program, runtime_info); });
     }
-    Shader::Optimization::RingAccessElimination(program, runtime_info);
-    Shader::Optimization::ReadLaneEliminationPass(program);
-    Shader::Optimization::FlattenExtendedUserdataPass(program);
-    Shader::Optimization::ResourceTrackingPass(program);
-    Shader::Optimization::LowerBufferFormatToRaw(program);
-    Shader::Optimization::SharedMemorySimplifyPass(program, profile);
-    Shader::Optimization::SharedMemoryToStoragePass(program, runtime_info, profile);
-    Shader::Optimization::SharedMemoryBarrierPass(program, runtime_info, profile);
-    Shader::Optimization::IdentityRemovalPass(program.blocks);
-    Shader::Optimization::DeadCodeEliminationPass(program);
-    Shader::Optimization::ConstantPropagationPass(program.post_order_blocks);
-    Shader::Optimization::CollectShaderInfoPass(program, profile);
+    run_pass("RingAccessElimination", [&] { RingAccessElimination(program, runtime_info); });
+    run_pass("ReadLaneEliminationPass", [&] { ReadLaneEliminationPass(program); });
+    run_pass("FlattenExtendedUserdataPass", [&] { FlattenExtendedUserdataPass(program); });
+    run_pass("ResourceTrackingPass", [&] { ResourceTrackingPass(program); });
+    run_pass("LowerBufferFormatToRaw", [&] { LowerBufferFormatToRaw(program); });
+    run_pass("SharedMemorySimplifyPass", [&] { SharedMemorySimplifyPass(program, profile); });
+    run_pass("SharedMemoryToStoragePass",
+             [&] { SharedMemoryToStoragePass(program, runtime_info, profile); });
+    run_pass("SharedMemoryBarrierPass",
+             [&] { SharedMemoryBarrierPass(program, runtime_info, profile); });
+    run_pass("IdentityRemovalPass", [&] { IdentityRemovalPass(program.blocks); });
+    run_pass("DeadCodeEliminationPass", [&] { DeadCodeEliminationPass(program); });
+    run_pass("ConstantPropagationPass",
+             [&] { ConstantPropagationPass(program.post_order_blocks); });
+    run_pass("CollectShaderInfoPass", [&] { CollectShaderInfoPass(program, profile); });
 
     Shader::IR::DumpProgram(program, info);
 
@@ -25,6 +25,14 @@ struct Pools {
         inst_pool.ReleaseContents();
         block_pool.ReleaseContents();
     }
+
+    [[nodiscard]] u64 NumAllocated() const {
+        return inst_pool.NumAllocated() + block_pool.NumAllocated();
+    }
+
+    [[nodiscard]] u64 NumChunkAllocations() const {
+        return inst_pool.NumChunkAllocations() + block_pool.NumChunkAllocations();
+    }
 };
 
 [[nodiscard]] IR::Program TranslateProgram(const std::span<const u32>& code, Pools& pools,
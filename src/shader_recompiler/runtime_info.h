@@ -4,6 +4,7 @@
 #pragma once
 
 #include <span>
+#include "common/hash.h"
 #include "common/types.h"
 #include "shader_recompiler/frontend/tessellation.h"
 #include "video_core/amdgpu/pixel_format.h"
@@ -271,6 +272,47 @@ struct RuntimeInfo {
             return true;
         }
     }
+
+    /// Hashes a subset of the fields compared by operator==, so equal infos always hash equal.
+    [[nodiscard]] u64 Hash() const noexcept {
+        const auto combine = [](u64 seed, auto... values) {
+            ((seed = HashCombine(seed, static_cast<u64>(values))), ...);
+            return seed;
+        };
+        switch (stage) {
+        case Stage::Fragment: {
+            u64 hash = combine(u64(stage), fs_info.num_inputs, fs_info.z_export_format,
+                               fs_info.mrtz_mask, fs_info.dual_source_blending);
+            for (const auto& cb : fs_info.color_buffers) {
+                hash = combine(hash, cb.data_format, cb.num_format, cb.export_format);
+            }
+            for (u32 i = 0; i < fs_info.num_inputs; i++) {
+                const auto& input = fs_info.inputs[i];
+                hash = combine(hash, input.param_index, input.is_flat, input.default_value);
+            }
+            return hash;
+        }
+        case Stage::Vertex:
+            return combine(u64(stage), vs_info.num_outputs, vs_info.step_rate_0,
+                           vs_info.step_rate_1, vs_info.clip_disable, vs_info.tess_type,
+                           vs_info.hs_output_cp_stride);
+        case Stage::Compute:
+            return combine(u64(stage), cs_info.workgroup_size[0], cs_info.workgroup_size[1],
+                           cs_info.workgroup_size[2]);
+        case Stage::Export:
+            return combine(u64(stage), es_info.vertex_data_size);
+        case Stage::Geometry:
+            return combine(u64(stage), gs_info.num_outputs, gs_info.output_vertices,
+                           gs_info.in_primitive, gs_info.vs_copy_hash);
+        case Stage::Hull:
+            return combine(u64(stage), hs_info.num_input_control_points, hs_info.num_threads,
+                           hs_info.ls_stride, hs_info.hs_output_cp_stride, hs_info.hs_output_base);
+        case Stage::Local:
+            return combine(u64(stage), ls_info.ls_stride);
+        default:
+            return u64(stage);
+        }
+    }
 };
 
 } // namespace Shader
@@ -3,8 +3,10 @@
 
 #pragma once
 
+#include <bit>
 #include <bitset>
 
+#include "common/hash.h"
 #include "common/types.h"
 #include "shader_recompiler/backend/bindings.h"
 #include "shader_recompiler/frontend/fetch_shader.h"
@@ -19,6 +21,10 @@ struct VsAttribSpecialization {
     AmdGpu::CompMapping dst_select{};
 
     bool operator==(const VsAttribSpecialization&) const = default;
+
+    [[nodiscard]] u64 Hash() const {
+        return HashCombine(u64(divisor), (u64(num_class) << 32) | std::bit_cast<u32>(dst_select));
+    }
 };
 
 struct BufferSpecialization {
@@ -61,6 +67,10 @@ struct FMaskSpecialization {
     u32 height;
 
     bool operator==(const FMaskSpecialization&) const = default;
+
+    [[nodiscard]] u64 Hash() const {
+        return (u64(width) << 32) | height;
+    }
 };
 
 struct SamplerSpecialization {
@@ -68,6 +78,10 @@ struct SamplerSpecialization {
     u8 force_degamma : 1;
 
     bool operator==(const SamplerSpecialization&) const = default;
+
+    [[nodiscard]] u64 Hash() const {
+        return force_unnormalized | (force_degamma << 1);
+    }
 };
 
 /**
@@ -75,6 +89,10 @@ struct SamplerSpecialization {
  * for compatibility. Can be used as a key for storing shader permutations.
  * Is separate from runtime information, because resource layout can only be deduced
  * after the first compilation of a module.
+ *
+ * The hash is accumulated while the resources are collected and only covers the fields that are
+ * always compared. Buffers, images and start bindings are left out, as a resource that is not
+ * bound matches any permutation and they are only compared for some pairs of specializations.
  */
 struct StageSpecialization {
     static constexpr size_t MaxStageResources = 128;
@@ -89,6 +107,7 @@ struct StageSpecialization {
     boost::container::small_vector<FMaskSpecialization, 8> fmasks;
     boost::container::small_vector<SamplerSpecialization, 16> samplers;
     Backend::Bindings start{};
+    u64 hash{};
 
     StageSpecialization() = default;
     StageSpecialization(const Info& info_, RuntimeInfo runtime_info_, const Profile& profile_,
@@ -167,16 +186,30 @@ struct StageSpecialization {
                 runtime_info.vs_info.InitFromTessConstants(tess_constants);
             }
         }
+        HashFixedState();
+    }
+
+    void HashSpec(const auto& spec) {
+        if constexpr (requires { spec.Hash(); }) {
+            hash = HashCombine(hash, spec.Hash());
+        }
+    }
+
+    void HashFixedState() {
+        hash = HashCombine(hash, runtime_info.Hash());
+        if (fetch_shader_data) {
+            hash = HashCombine(hash, fetch_shader_data->Hash());
+        }
     }
 
     void ForEachSharp(auto& spec_list, auto& desc_list, auto&& func) {
         for (const auto& desc : desc_list) {
             auto& spec = spec_list.emplace_back();
             const auto sharp = desc.GetSharp(*info);
-            if (!sharp) {
-                continue;
+            if (sharp) {
+                func(spec, desc, sharp);
             }
-            func(spec, desc, sharp);
+            HashSpec(spec);
         }
     }
 
@@ -184,12 +217,12 @@ struct StageSpecialization {
         for (const auto& desc : desc_list) {
             auto& spec = spec_list.emplace_back();
             const auto sharp = desc.GetSharp(*info);
-            if (!sharp) {
-                binding++;
-                continue;
+            if (sharp) {
+                bitset.set(binding);
+                func(spec, desc, sharp);
             }
-            bitset.set(binding++);
-            func(spec, desc, sharp);
+            binding++;
+            HashSpec(spec);
         }
     }
 
@@ -198,7 +231,7 @@ struct StageSpecialization {
     }
 
     bool operator==(const StageSpecialization& other) const {
-        if (!Valid()) {
+        if (!Valid() || hash != other.hash) {
             return false;
         }
 
@@ -0,0 +1,310 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+// Offline shader recompiler. Runs the GCN -> IR -> SPIR-V pipeline over the shaders of a game
+// without starting the emulator or creating a Vulkan device. Inputs are the shader metadata of
+// the game pipeline cache and the `.bin`/`.ud` files written when shader dumping is enabled.
+// Shaders that read guest memory while being translated (fetch shaders, SRT walkers and
+// tessellation constants) are skipped, that memory only exists while the game is running.
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <ranges>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <fmt/core.h>
+#include "common/config.h"
+#include "common/io_file.h"
+#include "common/logging/backend.h"
+#include "common/path_util.h"
+#include "common/serdes.h"
+#include "shader_recompiler/backend/spirv/emit_spirv.h"
+#include "shader_recompiler/info.h"
+#include "shader_recompiler/pass_stats.h"
+#include "shader_recompiler/profile.h"
+#include "shader_recompiler/recompiler.h"
+#include "shader_recompiler/runtime_info.h"
+#include "shader_recompiler/specialization.h"
+#include "video_core/cache_storage.h"
+#include "video_core/renderer_vulkan/vk_pipeline_cache.h"
+#include "video_core/renderer_vulkan/vk_pipeline_serialization.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct ShaderJob {
+    Shader::Stage stage;
+    Shader::LogicalStage l_stage;
+    u64 pgm_hash;
+    size_t perm_idx;
+    Shader::RuntimeInfo runtime_info;
+    Shader::Backend::Bindings start;
+    std::vector<u32> code;
+    std::vector<u32> user_data;
+
+    double translate_ms{};
+    double emit_ms{};
+    size_t spirv_size{};
+};
+
+void PrintUsage() {
+    std::cout << "Usage: shadps4-shader-tool [options] <game serial>\n"
+                 "Options:\n"
+                 "  -j, --jobs <count>        Number of compile threads (default: all cores)\n"
+                 "  -d, --dump-dir <folder>   Folder with dumped .bin/.ud shaders\n"
+                 "  -o, --output <folder>     Write the generated SPIR-V to this folder\n"
+                 "  -s, --stats <file>        Write per-pass statistics as JSON to this file\n"
+                 "  -h, --help                Display this help message\n";
+}
+
+/// Parses a positive number, returns false if the text isn't one.
+bool ParseCount(std::string_view text, u32& out) {
+    const auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), out);
+    return ec == std::errc{} && end == text.data() + text.size() && out > 0;
+}
+
+std::vector<u32> ReadWords(const std::filesystem::path& path) {
+    const auto file = Common::FS::IOFile{path, Common::FS::FileAccessMode::Read};
+    if (!file.IsOpen()) {
+        return {};
+    }
+    std::vector<u32> words(file.GetSize() / sizeof(u32));
+    file.Read(words);
+    return words;
+}
+
+} // Anonymous namespace
+
+int main(int argc, char* argv[]) {
+    const auto user_dir = Common::FS::GetUserPath(Common::FS::PathType::UserDir);
+    Config::load(user_dir / "config.toml");
+
+    u32 num_threads = std::max(std::thread::hardware_concurrency(), 1u);
+    auto dump_dir = Common::FS::GetUserPath(Common::FS::PathType::ShaderDir) / "dumps";
+    std::optional<std::filesystem::path> output_dir;
+    std::optional<std::filesystem::path> stats_path;
+    std::string serial;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (arg == "-h" || arg == "--help") {
+            PrintUsage();
+            return 0;
+        } else if ((arg == "-j" || arg == "--jobs") && has_value) {
+            if (!ParseCount(argv[++i], num_threads)) {
+                std::cerr << "Invalid number of jobs: " << argv[i] << "\n";
+                PrintUsage();
+                return 1;
+            }
+        } else if ((arg == "-d" || arg == "--dump-dir") && has_value) {
+            dump_dir = argv[++i];
+        } else if ((arg == "-o" || arg == "--output") && has_value) {
+            output_dir = argv[++i];
+        } else if ((arg == "-s" || arg == "--stats") && has_value) {
+            stats_path = argv[++i];
+        } else if (serial.empty() && !arg.starts_with('-')) {
+            serial = arg;
+        } else {
+            std::cerr << "Unknown argument: " << arg << "\n";
+            PrintUsage();
+            return 1;
+        }
+    }
+    if (serial.empty()) {
+        PrintUsage();
+        return 1;
+    }
+
+    Common::Log::Initialize("shader_tool.log");
+    Common::Log::Start();
+
+    auto& storage = Storage::DataBase::Instance();
+    storage.Open(serial);
+
+    // The cache stores the profile of the device it was generated on, compile against the same
+    // one so the output matches what the emulator would produce.
+    std::vector<u8> profile_data;
+    storage.Load(Storage::BlobType::ShaderProfile, "profile", profile_data);
+    if (profile_data.size() != sizeof(Shader::Profile)) {
+        fmt::print(stderr, "No compatible shader profile found in the cache of {}\n", serial);
+        return 1;
+    }
+    Shader::Profile profile{};
+    std::memcpy(&profile, profile_data.data(), sizeof(profile));
+
+    std::vector<ShaderJob> jobs;
+    u32 num_stale{};
+    u32 num_missing{};
+    u32 num_fetch{};
+    u32 num_srt{};
+    u32 num_tess{};
+    storage.ForEachBlob(Storage::BlobType::ShaderMeta, [&](std::vector<u8>&& data) {
+        Serialization::Archive ar{std::move(data)};
+        Shader::Info info{};
+        std::optional<Shader::Gcn::FetchShaderData> fetch_shader_data;
+        Shader::StageSpecialization spec{};
+        spec.info = &info;
+        size_t perm_idx{};
+        if (!Vulkan::LoadShaderMeta(ar, info, fetch_shader_data, spec, perm_idx)) {
+            ++num_stale;
+            return;
+        }
+        if (info.has_fetch_shader) {
+            // The fetch shader is read from guest memory during translation.
+            ++num_fetch;
+            return;
+        }
+        if (info.srt_info.walker_func_size != 0) {
+            // The SRT walker follows the user data pointers into guest memory.
+            ++num_srt;
+            return;
+        }
+        if (info.l_stage == Shader::LogicalStage::TessellationControl ||
+            info.l_stage == Shader::LogicalStage::TessellationEval) {
+            // The tessellation constants are read from guest memory during translation.
+            ++num_tess;
+            return;
+        }
+
+        const auto name =
+            Vulkan::PipelineCache::GetShaderName(info.stage, info.pgm_hash, perm_idx);
+        auto code = ReadWords(dump_dir / fmt::format("{}.bin", name));
+        auto user_data = ReadWords(dump_dir / fmt::format("{}.ud", name));
+        if (code.empty() || user_data.size() != Shader::ShaderParams::NumShaderUserData) {
+            ++num_missing;
+            return;
+        }
+
+        jobs.push_back(ShaderJob{
+            .stage = info.stage,
+            .l_stage = info.l_stage,
+            .pgm_hash = info.pgm_hash,
+            .perm_idx = perm_idx,
+            .runtime_info = spec.runtime_info,
+            .start = spec.start,
+            .code = std::move(code),
+            .user_data = std::move(user_data),
+        });
+    });
+
+    fmt::print("Found {} shaders ({} stale, {} without dumps)\n", jobs.size(), num_stale,
+               num_missing);
+    if (num_fetch + num_srt + num_tess != 0) {
+        // These read guest memory during translation, which doesn't exist offline.
+        fmt::print("Skipped {} with fetch shaders, {} with SRT walkers, {} tessellation shaders\n",
+                   num_fetch, num_srt, num_tess);
+    }
+    if (jobs.empty()) {
+        return 0;
+    }
+    if (output_dir) {
+        std::filesystem::create_directories(*output_dir);
+    }
+
+    auto& pass_stats = Shader::PassStatistics::Instance();
+    pass_stats.SetEnabled(true);
+
+    num_threads = std::min<u32>(num_threads, static_cast<u32>(jobs.size()));
+    std::atomic<size_t> next_job{};
+    const auto worker = [&] {
+        Shader::Pools pools;
+        for (size_t i = next_job++; i < jobs.size(); i = next_job++) {
+            auto& job = jobs[i];
+            const Shader::ShaderParams params{
+                .user_data = std::span<const u32, Shader::ShaderParams::NumShaderUserData>{
+                    job.user_data.data(), Shader::ShaderParams::NumShaderUserData},
+                .code = job.code,
+                .hash = job.pgm_hash,
+            };
+            Shader::Info info{job.stage, job.l_stage, params};
+            auto runtime_info = job.runtime_info;
+            auto binding = job.start;
+
+            const auto start_time = Clock::now();
+            const auto program =
+                Shader::TranslateProgram(job.code, pools, info, runtime_info, profile);
+            const auto translate_time = Clock::now();
+            const auto spv =
+                Shader::Backend::SPIRV::EmitSPIRV(profile, runtime_info, program, binding);
+            const auto emit_time = Clock::now();
+
+            job.translate_ms =
+                std::chrono::duration<double, std::milli>(translate_time - start_time).count();
+            job.emit_ms =
+                std::chrono::duration<double, std::milli>(emit_time - translate_time).count();
+            job.spirv_size = spv.size() * sizeof(u32);
+
+            if (output_dir) {
+                const auto name =
+                    Vulkan::PipelineCache::GetShaderName(job.stage, job.pgm_hash, job.perm_idx);
+                const auto file = Common::FS::IOFile{*output_dir / fmt::format("{}.spv", name),
+                                                     Common::FS::FileAccessMode::Create};
+                file.WriteSpan(std::span<const u32>{spv});
+            }
+        }
+    };
+
+    const auto start_time = Clock::now();
+    {
+        std::vector<std::jthread> workers;
+        workers.reserve(num_threads);
+        for (u32 i = 0; i < num_threads; ++i) {
+            workers.emplace_back(worker);
+        }
+    }
+    const auto wall_ms =
+        std::chrono::duration<double, std::milli>(Clock::now() - start_time).count();
+
+    double translate_ms{};
+    double emit_ms{};
+    size_t spirv_size{};
+    for (const auto& job : jobs) {
+        translate_ms += job.translate_ms;
+        emit_ms += job.emit_ms;
+        spirv_size += job.spirv_size;
+    }
+
+    fmt::print("Compiled {} shaders in {:.2f} ms using {} threads ({:.1f} shaders/s)\n",
+               jobs.size(), wall_ms, num_threads, jobs.size() * 1000.0 / wall_ms);
+    fmt::print("  translate: {:.2f} ms total, {:.3f} ms average\n", translate_ms,
+               translate_ms / jobs.size());
+    fmt::print("  emit:      {:.2f} ms total, {:.3f} ms average\n", emit_ms,
+               emit_ms / jobs.size());
+    fmt::print("  SPIR-V:    {} bytes total, {} bytes average\n", spirv_size,
+               spirv_size / jobs.size());
+
+    std::ranges::sort(jobs, [](const ShaderJob& a, const ShaderJob& b) {
+        return a.translate_ms + a.emit_ms > b.translate_ms + b.emit_ms;
+    });
+    fmt::print("Slowest shaders:\n");
+    for (const auto& job : jobs | std::views::take(10)) {
+        fmt::print("  {:<40} translate {:8.3f} ms, emit {:8.3f} ms, {:7} bytes\n",
+                   Vulkan::PipelineCache::GetShaderName(job.stage, job.pgm_hash, job.perm_idx),
+                   job.translate_ms, job.emit_ms, job.spirv_size);
+    }
+
+    fmt::print("Passes:\n");
+    for (const auto& pass : pass_stats.Snapshot()) {
+        fmt::print("  {:<28} {:10.3f} ms, {:8.2f} us average, {:9} -> {:9} insts, {:9} allocs, "
+                   "{:6} chunks\n",
+                   pass.name, pass.time_ns / 1e6, pass.time_ns / 1e3 / pass.runs,
+                   pass.insts_before, pass.insts_after, pass.allocations, pass.heap_allocations);
+    }
+    if (stats_path) {
+        const auto json = pass_stats.ToJson();
+        const auto file = Common::FS::IOFile{*stats_path, Common::FS::FileAccessMode::Create};
+        file.WriteString(json);
+    }
+
+    storage.Close();
+    return 0;
+}
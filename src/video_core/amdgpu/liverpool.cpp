@@ -14,6 +14,7 @@
 #include "core/memory.h"
 #include "core/platform.h"
 #include "video_core/amdgpu/liverpool.h"
+#include "video_core/amdgpu/pm4_capture.h"
 #include "video_core/amdgpu/pm4_cmds.h"
 #include "video_core/renderdoc.h"
 #include "video_core/renderer_vulkan/vk_rasterizer.h"
@@ -96,8 +97,11 @@ void Liverpool::Process(std::stop_token stoken) {
     while (!stoken.stop_requested()) {
         {
             std::unique_lock lk{submit_mutex};
+            // Submitters only take the mutex to notify us when we announced going to sleep.
+            gpu_sleeping = true;
             Common::CondvarWait(submit_cv, lk, stoken,
                                 [this] { return num_commands || num_submits || submit_done; });
+            gpu_sleeping = false;
         }
         if (stoken.stop_requested()) {
             break;
@@ -114,25 +118,22 @@ void Liverpool::Process(std::stop_token stoken) {
 
             auto& queue = mapped_queues[curr_qid];
 
-            Task::Handle task{};
-            {
-                std::scoped_lock lock{queue.m_access};
-                if (queue.submits.empty()) {
-                    continue;
-                }
-                task = queue.submits.front();
+            const Task::Handle* front = queue.submits.Front();
+            if (!front) {
+                continue;
             }
+            const Task::Handle task = *front;
             task.resume();
 
             if (task.done()) {
                 task.destroy();
+                queue.submits.Pop();
 
-                std::scoped_lock lock{queue.m_access};
-                queue.submits.pop();
-
-                --num_submits;
-                std::scoped_lock lock2{submit_mutex};
-                submit_cv.notify_all();
+                // Only idle waiters are interested in completions.
+                if (--num_submits == 0) {
+                    std::scoped_lock lock{submit_mutex};
+                    submit_cv.notify_all();
+                }
             }
         }
 
@@ -215,6 +216,123 @@ Liverpool::Task Liverpool::ProcessCeUpdate(std::span<const u32> ccb) {
     FIBER_EXIT;
 }
 
+void Liverpool::SetConfigRegs(const PM4Header* header) {
+    const auto* set_data = reinterpret_cast<const PM4CmdSetData*>(header);
+    const u32 count = header->type3.NumWords();
+    const auto reg_addr = Regs::ConfigRegWordOffset + set_data->reg_offset;
+    std::memcpy(&regs.reg_array[reg_addr], header + 2, (count - 1) * sizeof(u32));
+}
+
+void Liverpool::SetContextRegs(const PM4Header* header) {
+    const auto* set_data = reinterpret_cast<const PM4CmdSetData*>(header);
+    const u32 count = header->type3.NumWords();
+    const auto reg_addr = Regs::ContextRegWordOffset + set_data->reg_offset;
+    const auto* payload = reinterpret_cast<const u32*>(header + 2);
+
+    std::memcpy(&regs.reg_array[reg_addr], payload, (count - 1) * sizeof(u32));
+    MarkRegsDirty(reg_addr, count - 1);
+
+    // In the case of HW, render target memory has alignment as color block operates on
+    // tiles. There is no information of actual resource extents stored in CB context
+    // regs, so any deduction of it from slices/pitch will lead to a larger surface
+    // created. The same applies to the depth targets. Fortunately, the guest always
+    // sends a trailing NOP packet right after the context regs setup, so we can use the
+    // heuristic below and extract the hint to determine actual resource dims.
+
+    switch (reg_addr) {
+    case ContextRegs::CbColor0Base:
+    case ContextRegs::CbColor1Base:
+    case ContextRegs::CbColor2Base:
+    case ContextRegs::CbColor3Base:
+    case ContextRegs::CbColor4Base:
+    case ContextRegs::CbColor5Base:
+    case ContextRegs::CbColor6Base:
+    case ContextRegs::CbColor7Base: {
+        const auto col_buf_id = (reg_addr - ContextRegs::CbColor0Base) /
+                                (ContextRegs::CbColor1Base - ContextRegs::CbColor0Base);
+        ASSERT(col_buf_id < NUM_COLOR_BUFFERS);
+
+        const auto nop_offset = header->type3.count;
+        if (nop_offset == 0x0e || nop_offset == 0x0d || nop_offset == 0x0b) {
+            ASSERT_MSG(payload[nop_offset] == 0xc0001000,
+                       "NOP hint is missing in CB setup sequence");
+            last_cb_extent[col_buf_id].raw = payload[nop_offset + 1];
+        } else {
+            last_cb_extent[col_buf_id].raw = 0;
+        }
+        break;
+    }
+    case ContextRegs::CbColor0Cmask:
+    case ContextRegs::CbColor1Cmask:
+    case ContextRegs::CbColor2Cmask:
+    case ContextRegs::CbColor3Cmask:
+    case ContextRegs::CbColor4Cmask:
+    case ContextRegs::CbColor5Cmask:
+    case ContextRegs::CbColor6Cmask:
+    case ContextRegs::CbColor7Cmask: {
+        const auto col_buf_id =
+            (reg_addr - ContextRegs::CbColor0Cmask) /
+            (ContextRegs::CbColor1Cmask - ContextRegs::CbColor0Cmask);
+        ASSERT(col_buf_id < NUM_COLOR_BUFFERS);
+
+        const auto nop_offset = header->type3.count;
+        if (nop_offset == 0x04) {
+            ASSERT_MSG(payload[nop_offset] == 0xc0001000,
+                       "NOP hint is missing in CB setup sequence");
+            last_cb_extent[col_buf_id].raw = payload[nop_offset + 1];
+        }
+        break;
+    }
+    case ContextRegs::DbZInfo: {
+        if (header->type3.count == 8) {
+            ASSERT_MSG(payload[20] == 0xc0001000,
+                       "NOP hint is missing in DB setup sequence");
+            last_db_extent.raw = payload[21];
+        } else {
+            last_db_extent.raw = 0;
+        }
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+void Liverpool::SetShRegs(const PM4Header* header) {
+    const auto* set_data = reinterpret_cast<const PM4CmdSetData*>(header);
+    const u32 count = header->type3.NumWords();
+    const auto set_size = (count - 1) * sizeof(u32);
+
+    if (set_data->reg_offset >= 0x200 &&
+        set_data->reg_offset <= (0x200 + sizeof(ComputeProgram) / 4)) {
+        ASSERT(set_size <= sizeof(ComputeProgram));
+        auto* addr = reinterpret_cast<u32*>(&mapped_queues[GfxQueueId].cs_state) +
+                     (set_data->reg_offset - 0x200);
+        std::memcpy(addr, header + 2, set_size);
+    } else {
+        const auto reg_addr = Regs::ShRegWordOffset + set_data->reg_offset;
+        std::memcpy(&regs.reg_array[reg_addr], header + 2, set_size);
+        MarkRegsDirty(reg_addr, count - 1);
+    }
+}
+
+void Liverpool::SetUconfigRegs(const PM4Header* header) {
+    const auto* set_data = reinterpret_cast<const PM4CmdSetData*>(header);
+    const u32 count = header->type3.NumWords();
+    const auto reg_addr = Regs::UconfigRegWordOffset + set_data->reg_offset;
+    std::memcpy(&regs.reg_array[reg_addr], header + 2, (count - 1) * sizeof(u32));
+    MarkRegsDirty(reg_addr, count - 1);
+}
+
+const std::array<Liverpool::RegWriteHandler, 256> Liverpool::reg_write_handlers = [] {
+    std::array<RegWriteHandler, 256> handlers{};
+    handlers[static_cast<u8>(PM4ItOpcode::SetConfigReg)] = &Liverpool::SetConfigRegs;
+    handlers[static_cast<u8>(PM4ItOpcode::SetContextReg)] = &Liverpool::SetContextRegs;
+    handlers[static_cast<u8>(PM4ItOpcode::SetShReg)] = &Liverpool::SetShRegs;
+    handlers[static_cast<u8>(PM4ItOpcode::SetUconfigReg)] = &Liverpool::SetUconfigRegs;
+    return handlers;
+}();
+
 Liverpool::Task Liverpool::ProcessGraphics(std::span<const u32> dcb, std::span<const u32> ccb) {
     FIBER_ENTER(dcb_task_name);
 
@@ -252,6 +370,24 @@ Liverpool::Task Liverpool::ProcessGraphics(std::span<const u32> dcb, std::span<c
         case 3:
             const u32 count = header->type3.NumWords();
             const PM4ItOpcode opcode = header->type3.opcode;
+
+            // Register writes make up most of a command buffer. Apply runs of them in a tight
+            // table-driven loop instead of going through the generic dispatcher below.
+            if (auto handler = reg_write_handlers[static_cast<u8>(opcode)]) {
+                do {
+                    (this->*handler)(header);
+                    dcb = NextPacket(dcb, header->type3.NumWords() + 1);
+                    if (dcb.empty()) {
+                        break;
+                    }
+                    header = reinterpret_cast<const PM4Header*>(dcb.data());
+                    handler = header->type == 3 ? reg_write_handlers[static_cast<u8>(
+                                                      header->type3.opcode.Value())]
+                                                : nullptr;
+                } while (handler);
+                continue;
+            }
+
             switch (opcode) {
             case PM4ItOpcode::Nop: {
                 const auto* nop = reinterpret_cast<const PM4CmdNop*>(header);
@@ -302,108 +438,7 @@ Liverpool::Task Liverpool::ProcessGraphics(std::span<const u32> dcb, std::span<c
             }
             case PM4ItOpcode::ClearState: {
                 regs.SetDefaults();
-                break;
-            }
-            case PM4ItOpcode::SetConfigReg: {
-                const auto* set_data = reinterpret_cast<const PM4CmdSetData*>(header);
-                const auto reg_addr = Regs::ConfigRegWordOffset + set_data->reg_offset;
-                const auto* payload = reinterpret_cast<const u32*>(header + 2);
-                std::memcpy(&regs.reg_array[reg_addr], payload, (count - 1) * sizeof(u32));
-                break;
-            }
-            case PM4ItOpcode::SetContextReg: {
-                const auto* set_data = reinterpret_cast<const PM4CmdSetData*>(header);
-                const auto reg_addr = Regs::ContextRegWordOffset + set_data->reg_offset;
-                const auto* payload = reinterpret_cast<const u32*>(header + 2);
-
-                std::memcpy(&regs.reg_array[reg_addr], payload, (count - 1) * sizeof(u32));
-
-                // In the case of HW, render target memory has alignment as color block operates on
-                // tiles. There is no information of actual resource extents stored in CB context
-                // regs, so any deduction of it from slices/pitch will lead to a larger surface
-                // created. The same applies to the depth targets. Fortunately, the guest always
-                // sends a trailing NOP packet right after the context regs setup, so we can use the
-                // heuristic below and extract the hint to determine actual resource dims.
-
-                switch (reg_addr) {
-                case ContextRegs::CbColor0Base:
-                case ContextRegs::CbColor1Base:
-                case ContextRegs::CbColor2Base:
-                case ContextRegs::CbColor3Base:
-                case ContextRegs::CbColor4Base:
-                case ContextRegs::CbColor5Base:
-                case ContextRegs::CbColor6Base:
-                case ContextRegs::CbColor7Base: {
-                    const auto col_buf_id = (reg_addr - ContextRegs::CbColor0Base) /
-                                            (ContextRegs::CbColor1Base - ContextRegs::CbColor0Base);
-                    ASSERT(col_buf_id < NUM_COLOR_BUFFERS);
-
-                    const auto nop_offset = header->type3.count;
-                    if (nop_offset == 0x0e || nop_offset == 0x0d || nop_offset == 0x0b) {
-                        ASSERT_MSG(payload[nop_offset] == 0xc0001000,
-                                   "NOP hint is missing in CB setup sequence");
-                        last_cb_extent[col_buf_id].raw = payload[nop_offset + 1];
-                    } else {
-                        last_cb_extent[col_buf_id].raw = 0;
-                    }
-                    break;
-                }
-                case ContextRegs::CbColor0Cmask:
-                case ContextRegs::CbColor1Cmask:
-                case ContextRegs::CbColor2Cmask:
-                case ContextRegs::CbColor3Cmask:
-                case ContextRegs::CbColor4Cmask:
-                case ContextRegs::CbColor5Cmask:
-                case ContextRegs::CbColor6Cmask:
-                case ContextRegs::CbColor7Cmask: {
-                    const auto col_buf_id =
-                        (reg_addr - ContextRegs::CbColor0Cmask) /
-                        (ContextRegs::CbColor1Cmask - ContextRegs::CbColor0Cmask);
-                    ASSERT(col_buf_id < NUM_COLOR_BUFFERS);
-
-                    const auto nop_offset = header->type3.count;
-                    if (nop_offset == 0x04) {
-                        ASSERT_MSG(payload[nop_offset] == 0xc0001000,
-                                   "NOP hint is missing in CB setup sequence");
-                        last_cb_extent[col_buf_id].raw = payload[nop_offset + 1];
-                    }
-                    break;
-                }
-                case ContextRegs::DbZInfo: {
-                    if (header->type3.count == 8) {
-                        ASSERT_MSG(payload[20] == 0xc0001000,
-                                   "NOP hint is missing in DB setup sequence");
-                        last_db_extent.raw = payload[21];
-                    } else {
-                        last_db_extent.raw = 0;
-                    }
-                    break;
-                }
-                default:
-                    break;
-                }
-                break;
-            }
-            case PM4ItOpcode::SetShReg: {
-                const auto* set_data = reinterpret_cast<const PM4CmdSetData*>(header);
-                const auto set_size = (count - 1) * sizeof(u32);
-
-                if (set_data->reg_offset >= 0x200 &&
-                    set_data->reg_offset <= (0x200 + sizeof(ComputeProgram) / 4)) {
-                    ASSERT(set_size <= sizeof(ComputeProgram));
-                    auto* addr = reinterpret_cast<u32*>(&mapped_queues[GfxQueueId].cs_state) +
-                                 (set_data->reg_offset - 0x200);
-                    std::memcpy(addr, header + 2, set_size);
-                } else {
-                    std::memcpy(&regs.reg_array[Regs::ShRegWordOffset + set_data->reg_offset],
-                                header + 2, set_size);
-                }
-                break;
-            }
-            case PM4ItOpcode::SetUconfigReg: {
-                const auto* set_data = reinterpret_cast<const PM4CmdSetData*>(header);
-                std::memcpy(&regs.reg_array[Regs::UconfigRegWordOffset + set_data->reg_offset],
-                            header + 2, (count - 1) * sizeof(u32));
+                dirty_regs = RegGroup::All;
                 break;
             }
             case PM4ItOpcode::SetPredication: {
@@ -741,8 +776,8 @@ Liverpool::Task Liverpool::ProcessGraphics(std::span<const u32> dcb, std::span<c
                 // there are no other submits to yield to we can sleep the thread
                 // instead and allow other tasks to run.
                 const u64* wait_addr = wait_reg_mem->Address<u64*>();
-                if (vo_port->IsVoLabel(wait_addr) &&
-                    num_submits == mapped_queues[GfxQueueId].submits.size()) {
+                if (vo_port && vo_port->IsVoLabel(wait_addr) &&
+                    num_submits == mapped_queues[GfxQueueId].submits.Size()) {
                     vo_port->WaitVoLabel([&] { return wait_reg_mem->Test(regs.reg_array); });
                     break;
                 }
@@ -951,8 +986,9 @@ Liverpool::Task Liverpool::ProcessCompute(std::span<const u32> acb, u32 vqid) {
                              (set_data->reg_offset - 0x200);
                 std::memcpy(addr, header + 2, set_size);
             } else {
-                std::memcpy(&regs.reg_array[Regs::ShRegWordOffset + set_data->reg_offset],
-                            header + 2, set_size);
+                const auto reg_addr = Regs::ShRegWordOffset + set_data->reg_offset;
+                std::memcpy(&regs.reg_array[reg_addr], header + 2, set_size);
+                MarkRegsDirty(reg_addr, static_cast<u32>(set_size / sizeof(u32)));
             }
             break;
         }
@@ -1095,19 +1131,20 @@ Liverpool::CmdBuffer Liverpool::CopyCmdBuffers(std::span<const u32> dcb, std::sp
 void Liverpool::SubmitGfx(std::span<const u32> dcb, std::span<const u32> ccb) {
     auto& queue = mapped_queues[GfxQueueId];
 
+    if (capturing) [[unlikely]] {
+        std::scoped_lock lk{capture_mutex};
+        if (capture) {
+            capture->RecordGfx(dcb, ccb);
+        }
+    }
+
     if (Config::copyGPUCmdBuffers()) {
         std::tie(dcb, ccb) = CopyCmdBuffers(dcb, ccb);
     }
 
     auto task = ProcessGraphics(dcb, ccb);
-    {
-        std::scoped_lock lock{queue.m_access};
-        queue.submits.emplace(task.handle);
-    }
-
-    std::scoped_lock lk{submit_mutex};
-    ++num_submits;
-    submit_cv.notify_one();
+    queue.submits.EmplaceWait(task.handle);
+    NotifySubmit();
 }
 
 void Liverpool::SubmitAsc(u32 gnm_vqid, std::span<const u32> acb) {
@@ -1115,16 +1152,76 @@ void Liverpool::SubmitAsc(u32 gnm_vqid, std::span<const u32> acb) {
     auto& queue = mapped_queues[gnm_vqid];
 
     const auto vqid = gnm_vqid - 1;
+    if (capturing) [[unlikely]] {
+        std::scoped_lock lk{capture_mutex};
+        if (capture) {
+            capture->RecordAsc(gnm_vqid, asc_queues[{vqid}], acb);
+        }
+    }
     const auto& task = ProcessCompute(acb, vqid);
-    {
-        std::scoped_lock lock{queue.m_access};
-        queue.submits.emplace(task.handle);
+    queue.submits.EmplaceWait(task.handle);
+
+    u32 num_queues = num_mapped_queues.load(std::memory_order_relaxed);
+    while (num_queues < gnm_vqid + 1 &&
+           !num_mapped_queues.compare_exchange_weak(num_queues, gnm_vqid + 1)) {
+    }
+    NotifySubmit();
+}
+
+void Liverpool::StartCapture(u32 num_frames, std::filesystem::path path) {
+    if (num_frames == 0) {
+        return;
     }
+    WaitGpuIdle();
+
+    auto state = std::make_unique<Capture::State>();
+    SendCommand<true>([this, &state] {
+        state->regs = regs;
+        for (u32 i = 0; i < NumTotalQueues; ++i) {
+            state->cs_states[i] = mapped_queues[i].cs_state;
+        }
+    });
+
+    std::scoped_lock lk{capture_mutex};
+    capture = std::make_unique<Capture::Recorder>(std::move(path), num_frames, num_counter_pairs,
+                                                  *state);
+    capturing = true;
+    LOG_INFO(Render, "Capturing {} frames to {}", num_frames, capture->GetPath().string());
+}
 
-    std::scoped_lock lk{submit_mutex};
-    num_mapped_queues = std::max(num_mapped_queues, gnm_vqid + 1);
+void Liverpool::LoadCaptureState(const Capture::State& state) {
+    SendCommand<true>([this, &state] {
+        regs = state.regs;
+        for (u32 i = 0; i < NumTotalQueues; ++i) {
+            mapped_queues[i].cs_state = state.cs_states[i];
+        }
+        dirty_regs = RegGroup::All;
+    });
+}
+
+void Liverpool::EndCaptureFrame() {
+    std::scoped_lock lk{capture_mutex};
+    if (!capture || !capture->EndFrame()) {
+        return;
+    }
+    const auto& path = capture->GetPath();
+    if (Capture::Save(path, capture->GetData())) {
+        LOG_INFO(Render, "Saved frame capture to {}", path.string());
+    } else {
+        LOG_ERROR(Render, "Failed to write frame capture to {}", path.string());
+    }
+    capture.reset();
+    capturing = false;
+}
+
+void Liverpool::NotifySubmit() {
+    // Sequentially consistent increment and load pair with the store and predicate check done by
+    // the command processor before sleeping, so either it sees the new submit or we see it asleep.
     ++num_submits;
-    submit_cv.notify_one();
+    if (gpu_sleeping) {
+        std::scoped_lock lk{submit_mutex};
+        submit_cv.notify_one();
+    }
 }
 
 } // namespace AmdGpu
@@ -6,6 +6,8 @@
 #include <condition_variable>
 #include <coroutine>
 #include <exception>
+#include <filesystem>
+#include <memory>
 #include <mutex>
 #include <semaphore>
 #include <span>
@@ -14,6 +16,7 @@
 #include <queue>
 
 #include "common/assert.h"
+#include "common/mpsc_ring.h"
 #include "common/slot_vector.h"
 #include "common/types.h"
 #include "common/unique_function.h"
@@ -30,6 +33,13 @@ struct VideoOutPort;
 
 namespace AmdGpu {
 
+union PM4Header;
+
+namespace Capture {
+class Recorder;
+struct State;
+} // namespace Capture
+
 struct Liverpool {
     static constexpr u32 GfxQueueId = 0u;
     static constexpr u32 NumGfxRings = 1u;     // actually 2, but HP is reserved by system software
@@ -71,13 +81,25 @@ public:
     void SubmitAsc(u32 gnm_vqid, std::span<const u32> acb);
 
     void SubmitDone() noexcept {
-        std::scoped_lock lk{submit_mutex};
-        mapped_queues[GfxQueueId].ccb_buffer_offset = 0;
-        mapped_queues[GfxQueueId].dcb_buffer_offset = 0;
-        submit_done = true;
-        submit_cv.notify_one();
+        {
+            std::scoped_lock lk{submit_mutex};
+            mapped_queues[GfxQueueId].ccb_buffer_offset = 0;
+            mapped_queues[GfxQueueId].dcb_buffer_offset = 0;
+            submit_done = true;
+            submit_cv.notify_one();
+        }
+        if (capturing) {
+            EndCaptureFrame();
+        }
     }
 
+    /// Records the submissions of the next frames to a capture file. Waits for the GPU to be
+    /// idle so the captured register state matches the start of the first recorded frame.
+    void StartCapture(u32 num_frames, std::filesystem::path path);
+
+    /// Replaces the register and compute state with the state of a capture. Replay only.
+    void LoadCaptureState(const Capture::State& state);
+
     void WaitGpuIdle() noexcept {
         std::unique_lock lk{submit_mutex};
         submit_cv.wait(lk, [this] { return num_submits == 0; });
@@ -132,6 +154,14 @@ public:
         return mapped_queues[curr_qid].cs_state;
     }
 
+    /// Returns which of the given register groups were written since they were last consumed
+    /// and clears them. Must be called from the GPU thread.
+    RegGroup ConsumeDirtyRegs(RegGroup groups) {
+        const RegGroup dirty = dirty_regs & groups;
+        dirty_regs &= ~groups;
+        return dirty;
+    }
+
     struct AscQueueInfo {
         static constexpr size_t Pm4BufferSize = 1024;
         VAddr map_addr;
@@ -186,18 +216,37 @@ private:
     void ProcessCommands();
     void Process(std::stop_token stoken);
 
+    void SetConfigRegs(const PM4Header* header);
+    void SetContextRegs(const PM4Header* header);
+    void SetShRegs(const PM4Header* header);
+    void SetUconfigRegs(const PM4Header* header);
+
+    void MarkRegsDirty(u32 reg_begin, u32 num_regs) {
+        dirty_regs |= Regs::GetGroups(reg_begin, num_regs);
+    }
+
+    /// Handlers of register write packets indexed by PM4 type 3 opcode, null for other packets.
+    using RegWriteHandler = void (Liverpool::*)(const PM4Header* header);
+    static const std::array<RegWriteHandler, 256> reg_write_handlers;
+
+    void NotifySubmit();
+    void EndCaptureFrame();
+
     struct GpuQueue {
+        static constexpr size_t MaxPendingSubmits = 1024;
+
         std::mutex m_access{};
         std::atomic<u32> dcb_buffer_offset;
         std::atomic<u32> ccb_buffer_offset;
         std::vector<u32> dcb_buffer;
         std::vector<u32> ccb_buffer;
-        std::queue<Task::Handle> submits{};
+        Common::MPSCRing<Task::Handle, MaxPendingSubmits> submits{};
         ComputeProgram cs_state{};
     };
     std::array<GpuQueue, NumTotalQueues> mapped_queues{};
-    u32 num_mapped_queues{1u}; // GFX is always available
+    std::atomic<u32> num_mapped_queues{1u}; // GFX is always available
 
+    RegGroup dirty_regs{RegGroup::All};
     VAddr indirect_args_addr{};
     u32 num_counter_pairs{};
     u64 pixel_counter{};
@@ -226,11 +275,16 @@ private:
     std::atomic<u32> num_submits{};
     std::atomic<u32> num_commands{};
     std::atomic<bool> submit_done{};
+    std::atomic<bool> gpu_sleeping{};
     std::mutex submit_mutex;
     std::condition_variable_any submit_cv;
     std::queue<Common::UniqueFunction<void>> command_queue{};
     std::thread::id gpu_id;
     s32 curr_qid{-1};
+
+    std::mutex capture_mutex;
+    std::unique_ptr<Capture::Recorder> capture{};
+    std::atomic<bool> capturing{};
 };
 
 } // namespace AmdGpu
@@ -0,0 +1,508 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <cstring>
+
+#include "common/io_file.h"
+#include "common/logging/log.h"
+#include "video_core/amdgpu/pm4_capture.h"
+
+namespace AmdGpu::Capture {
+
+namespace {
+
+/// Guards against indirect buffers that chain into themselves.
+constexpr u32 MaxIndirectDepth = 8;
+
+using Function = PM4CmdWaitRegMem::Function;
+
+bool TestLabel(Function function, u32 value, u32 ref) {
+    switch (function) {
+    case Function::Always:
+        return true;
+    case Function::LessThan:
+        return value < ref;
+    case Function::LessThanEqual:
+        return value <= ref;
+    case Function::Equal:
+        return value == ref;
+    case Function::NotEqual:
+        return value != ref;
+    case Function::GreaterThanEqual:
+        return value >= ref;
+    case Function::GreaterThan:
+        return value > ref;
+    default:
+        return false;
+    }
+}
+
+u32 SatisfyingValue(Function function, u32 ref) {
+    switch (function) {
+    case Function::LessThan:
+        return ref - 1;
+    case Function::NotEqual:
+        return ~ref;
+    case Function::GreaterThan:
+        return ref + 1;
+    default:
+        return ref;
+    }
+}
+
+u64 FenceSize(DataSelect data_sel) {
+    switch (data_sel) {
+    case DataSelect::None:
+        return 0;
+    case DataSelect::Data32Low:
+        return sizeof(u32);
+    default:
+        return sizeof(u64);
+    }
+}
+
+class Writer {
+public:
+    explicit Writer(const std::filesystem::path& path)
+        : file{path, Common::FS::FileAccessMode::Create} {}
+
+    template <typename T>
+    void Append(const T& object) {
+        Append(&object, sizeof(T));
+    }
+
+    void Append(const void* data, size_t size) {
+        ok &= file.WriteSpan(std::span{static_cast<const u8*>(data), size}) == size;
+    }
+
+    [[nodiscard]] bool Ok() const {
+        return file.IsOpen() && ok;
+    }
+
+private:
+    Common::FS::IOFile file;
+    bool ok = true;
+};
+
+class Reader {
+public:
+    explicit Reader(std::span<const u8> data_) : data{data_} {}
+
+    template <typename T>
+    bool Read(T& object) {
+        return Read(&object, sizeof(T));
+    }
+
+    bool Read(void* out, size_t size) {
+        if (data.size() - pos < size) {
+            return false;
+        }
+        std::memcpy(out, data.data() + pos, size);
+        pos += size;
+        return true;
+    }
+
+    [[nodiscard]] bool AtEnd() const {
+        return pos == data.size();
+    }
+
+    [[nodiscard]] size_t Remaining() const {
+        return data.size() - pos;
+    }
+
+    [[nodiscard]] ChunkType PeekType() const {
+        return static_cast<ChunkType>(data[pos]);
+    }
+
+private:
+    std::span<const u8> data;
+    size_t pos{};
+};
+
+/// Reads count elements, the count comes from the file and is checked before allocating.
+template <typename T>
+bool ReadVector(Reader& reader, std::vector<T>& out, u64 count) {
+    if (count > reader.Remaining() / sizeof(T)) {
+        return false;
+    }
+    out.resize(count);
+    return reader.Read(out.data(), count * sizeof(T));
+}
+
+} // Anonymous namespace
+
+void Label::Satisfy() const {
+    if (size == sizeof(u64)) {
+        // Semaphore waits pass once the counter is non-zero.
+        auto* counter = reinterpret_cast<u64*>(address);
+        *counter = std::max<u64>(*counter, 1);
+        return;
+    }
+    auto* value = reinterpret_cast<u32*>(address);
+    if (TestLabel(function, *value & mask, ref)) {
+        return;
+    }
+    *value = (*value & ~mask) | (SatisfyingValue(function, ref) & mask);
+}
+
+bool Save(const std::filesystem::path& path, const CaptureData& capture) {
+    Writer writer{path};
+    writer.Append(FileHeader{Magic, Version});
+
+    writer.Append(StateChunk{
+        .type = ChunkType::State,
+        .regs_size = sizeof(Regs),
+        .num_cs_states = static_cast<u32>(capture.state->cs_states.size()),
+        .cs_state_size = sizeof(ComputeProgram),
+    });
+    writer.Append(capture.state->regs);
+    writer.Append(capture.state->cs_states);
+
+    for (const ComputeQueue& queue : capture.queues) {
+        writer.Append(ComputeQueueChunk{
+            .type = ChunkType::ComputeQueue,
+            .vqid = queue.vqid,
+            .pipe_id = queue.pipe_id,
+            .ring_size_dw = queue.ring_size_dw,
+            .ring_addr = queue.ring_addr,
+        });
+    }
+
+    for (const Frame& frame : capture.frames) {
+        for (const MemoryBlock& block : frame.memory) {
+            writer.Append(MemoryChunk{
+                .type = ChunkType::Memory,
+                .address = block.address,
+                .size = block.data.size(),
+            });
+            writer.Append(block.data.data(), block.data.size());
+        }
+        for (const Label& label : frame.labels) {
+            writer.Append(LabelChunk{
+                .type = ChunkType::Label,
+                .function = label.function,
+                .size = label.size,
+                .address = label.address,
+                .ref = label.ref,
+                .mask = label.mask,
+            });
+        }
+        for (const Submit& submit : frame.submits) {
+            writer.Append(SubmitChunk{
+                .type = ChunkType::Submit,
+                .vqid = submit.vqid,
+                .dcb_address = submit.dcb_address,
+                .ccb_address = submit.ccb_address,
+                .dcb_size_dw = static_cast<u32>(submit.dcb.size()),
+                .ccb_size_dw = static_cast<u32>(submit.ccb.size()),
+            });
+            writer.Append(submit.dcb.data(), submit.dcb.size() * sizeof(u32));
+            writer.Append(submit.ccb.data(), submit.ccb.size() * sizeof(u32));
+        }
+        writer.Append(ChunkType::FrameEnd);
+    }
+    return writer.Ok();
+}
+
+bool Load(const std::filesystem::path& path, CaptureData& capture) {
+    const Common::FS::IOFile file{path, Common::FS::FileAccessMode::Read};
+    if (!file.IsOpen()) {
+        return false;
+    }
+    std::vector<u8> data(file.GetSize());
+    if (file.ReadSpan(std::span{data}) != data.size()) {
+        return false;
+    }
+
+    Reader reader{data};
+    FileHeader header;
+    if (!reader.Read(header) || header.magic != Magic || header.version != Version) {
+        return false;
+    }
+
+    capture = {};
+    bool frame_open = false;
+    const auto current_frame = [&]() -> Frame& {
+        if (!frame_open) {
+            capture.frames.emplace_back();
+            frame_open = true;
+        }
+        return capture.frames.back();
+    };
+
+    while (!reader.AtEnd()) {
+        switch (reader.PeekType()) {
+        case ChunkType::State: {
+            StateChunk chunk;
+            if (!reader.Read(chunk) || chunk.regs_size != sizeof(Regs) ||
+                chunk.num_cs_states != Liverpool::NumTotalQueues ||
+                chunk.cs_state_size != sizeof(ComputeProgram)) {
+                return false;
+            }
+            capture.state = std::make_unique<State>();
+            if (!reader.Read(capture.state->regs) || !reader.Read(capture.state->cs_states)) {
+                return false;
+            }
+            break;
+        }
+        case ChunkType::ComputeQueue: {
+            ComputeQueueChunk chunk;
+            if (!reader.Read(chunk)) {
+                return false;
+            }
+            capture.queues.push_back({chunk.vqid, chunk.pipe_id, chunk.ring_size_dw,
+                                      static_cast<VAddr>(chunk.ring_addr)});
+            break;
+        }
+        case ChunkType::Memory: {
+            MemoryChunk chunk;
+            if (!reader.Read(chunk)) {
+                return false;
+            }
+            MemoryBlock& block = current_frame().memory.emplace_back();
+            block.address = chunk.address;
+            if (!ReadVector(reader, block.data, chunk.size)) {
+                return false;
+            }
+            break;
+        }
+        case ChunkType::Label: {
+            LabelChunk chunk;
+            if (!reader.Read(chunk)) {
+                return false;
+            }
+            current_frame().labels.push_back({chunk.function, chunk.size,
+                                              static_cast<VAddr>(chunk.address), chunk.ref,
+                                              chunk.mask});
+            break;
+        }
+        case ChunkType::Submit: {
+            SubmitChunk chunk;
+            if (!reader.Read(chunk)) {
+                return false;
+            }
+            Submit& submit = current_frame().submits.emplace_back();
+            submit.vqid = chunk.vqid;
+            submit.dcb_address = chunk.dcb_address;
+            submit.ccb_address = chunk.ccb_address;
+            if (!ReadVector(reader, submit.dcb, chunk.dcb_size_dw) ||
+                !ReadVector(reader, submit.ccb, chunk.ccb_size_dw)) {
+                return false;
+            }
+            break;
+        }
+        case ChunkType::FrameEnd: {
+            ChunkType type;
+            reader.Read(type);
+            current_frame();
+            frame_open = false;
+            break;
+        }
+        default:
+            return false;
+        }
+    }
+    return capture.state != nullptr;
+}
+
+Recorder::Recorder(std::filesystem::path path_, u32 num_frames_, u32 num_counter_pairs_,
+                   const State& state)
+    : path{std::move(path_)}, num_frames{num_frames_}, num_counter_pairs{num_counter_pairs_} {
+    data.state = std::make_unique<State>(state);
+    data.frames.emplace_back();
+}
+
+Recorder::~Recorder() = default;
+
+void Recorder::RecordGfx(std::span<const u32> dcb, std::span<const u32> ccb) {
+    Walk(dcb, Stream::Draw, 0);
+    Walk(ccb, Stream::Constant, 0);
+    data.frames.back().submits.push_back({
+        .vqid = Liverpool::GfxQueueId,
+        .dcb_address = reinterpret_cast<VAddr>(dcb.data()),
+        .ccb_address = reinterpret_cast<VAddr>(ccb.data()),
+        .dcb = {dcb.begin(), dcb.end()},
+        .ccb = {ccb.begin(), ccb.end()},
+    });
+}
+
+void Recorder::RecordAsc(u32 gnm_vqid, const Liverpool::AscQueueInfo& queue,
+                         std::span<const u32> acb) {
+    const bool known = std::ranges::any_of(
+        data.queues, [gnm_vqid](const ComputeQueue& q) { return q.vqid == gnm_vqid; });
+    if (!known) {
+        data.queues.push_back({gnm_vqid, queue.pipe_id, queue.ring_size_dw, queue.map_addr});
+    }
+    data.frames.back().submits.push_back({
+        .vqid = gnm_vqid,
+        .dcb_address = reinterpret_cast<VAddr>(acb.data()),
+        .ccb_address = 0,
+        .dcb = {acb.begin(), acb.end()},
+        .ccb = {},
+    });
+
+    // Packets split across the ring boundary are completed by the next submission of the queue.
+    auto& partial = partial_packets[gnm_vqid - 1];
+    if (!partial.empty()) {
+        const auto* header = reinterpret_cast<const PM4Header*>(partial.data());
+        const size_t missing = header->type3.NumWords() + 1 - partial.size();
+        const size_t count = std::min(missing, acb.size());
+        partial.insert(partial.end(), acb.begin(), acb.begin() + count);
+        acb = acb.subspan(count);
+        if (count < missing) {
+            return;
+        }
+        RecordPacket(reinterpret_cast<const PM4Header*>(partial.data()), Stream::Compute, 0);
+        partial.clear();
+    }
+    const auto remaining = Walk(acb, Stream::Compute, 0);
+    partial.assign(remaining.begin(), remaining.end());
+}
+
+bool Recorder::EndFrame() {
+    frame_memory.clear();
+    if (data.frames.size() == num_frames) {
+        return true;
+    }
+    data.frames.emplace_back();
+    return false;
+}
+
+std::span<const u32> Recorder::Walk(std::span<const u32> cmds, Stream stream, u32 depth) {
+    while (!cmds.empty()) {
+        const auto* header = reinterpret_cast<const PM4Header*>(cmds.data());
+        if (header->type == 2) {
+            cmds = cmds.subspan(1);
+            continue;
+        }
+        if (header->type != 3) {
+            LOG_WARNING(Render, "Capture stopped walking at PM4 type {} packet",
+                        header->type.Value());
+            return {};
+        }
+        const u32 num_words = header->type3.NumWords() + 1;
+        if (num_words > cmds.size()) {
+            return cmds;
+        }
+        RecordPacket(header, stream, depth);
+        cmds = cmds.subspan(num_words);
+    }
+    return {};
+}
+
+void Recorder::RecordPacket(const PM4Header* header, Stream stream, u32 depth) {
+    switch (header->type3.opcode) {
+    case PM4ItOpcode::IndirectBuffer:
+    case PM4ItOpcode::IndirectBufferConst: {
+        const auto* indirect_buffer = reinterpret_cast<const PM4CmdIndirectBuffer*>(header);
+        const std::span<const u32> ib{indirect_buffer->Address<const u32>(),
+                                      indirect_buffer->ib_size};
+        AddMemory(reinterpret_cast<VAddr>(ib.data()), ib.size_bytes());
+        if (depth < MaxIndirectDepth) {
+            Walk(ib, stream, depth + 1);
+        }
+        break;
+    }
+    case PM4ItOpcode::DumpConstRam: {
+        const auto* dump_const = reinterpret_cast<const PM4DumpConstRam*>(header);
+        AddMemory(dump_const->Address<VAddr>(), dump_const->Size());
+        break;
+    }
+    case PM4ItOpcode::EventWrite: {
+        if (stream == Stream::Compute) {
+            break;
+        }
+        const auto* event = reinterpret_cast<const PM4CmdEventWrite*>(header);
+        if (event->event_index.Value() == EventIndex::ZpassDone &&
+            event->event_type.Value() == EventType::PixelPipeStatDump) {
+            AddMemory(event->Address<VAddr>(), num_counter_pairs * 2 * sizeof(u64));
+        }
+        break;
+    }
+    case PM4ItOpcode::EventWriteEos: {
+        const auto* event_eos = reinterpret_cast<const PM4CmdEventWriteEos*>(header);
+        AddMemory(event_eos->Address<VAddr>(), sizeof(u32));
+        break;
+    }
+    case PM4ItOpcode::EventWriteEop: {
+        const auto* event_eop = reinterpret_cast<const PM4CmdEventWriteEop*>(header);
+        AddMemory(reinterpret_cast<VAddr>(event_eop->Address<u32>()),
+                  FenceSize(event_eop->data_sel.Value()));
+        break;
+    }
+    case PM4ItOpcode::ReleaseMem: {
+        const auto* release_mem = reinterpret_cast<const PM4CmdReleaseMem*>(header);
+        AddMemory(reinterpret_cast<VAddr>(release_mem->Address<u32>()),
+                  FenceSize(release_mem->data_sel.Value()));
+        break;
+    }
+    case PM4ItOpcode::WriteData: {
+        const auto* write_data = reinterpret_cast<const PM4CmdWriteData*>(header);
+        AddMemory(write_data->Address<VAddr>(), write_data->Size());
+        break;
+    }
+    case PM4ItOpcode::MemSemaphore: {
+        const auto* mem_semaphore = reinterpret_cast<const PM4CmdMemSemaphore*>(header);
+        AddMemory(mem_semaphore->Address<VAddr>(), sizeof(u64));
+        if (!mem_semaphore->IsSignaling()) {
+            AddSemaphore(*mem_semaphore);
+        }
+        break;
+    }
+    case PM4ItOpcode::WaitRegMem: {
+        const auto* wait_reg_mem = reinterpret_cast<const PM4CmdWaitRegMem*>(header);
+        if (wait_reg_mem->mem_space.Value() == PM4CmdWaitRegMem::MemSpace::Memory) {
+            AddMemory(wait_reg_mem->Address<VAddr>(), sizeof(u32));
+            AddLabel(*wait_reg_mem);
+        }
+        break;
+    }
+    case PM4ItOpcode::CondExec: {
+        const auto* cond_exec = reinterpret_cast<const PM4CmdCondExec*>(header);
+        AddMemory(reinterpret_cast<VAddr>(cond_exec->Address()), sizeof(u32));
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+void Recorder::AddMemory(VAddr address, u64 size) {
+    if (address == 0 || size == 0) {
+        return;
+    }
+    using Interval = boost::icl::interval_set<VAddr>::interval_type;
+    boost::icl::interval_set<VAddr> missing{Interval::right_open(address, address + size)};
+    missing -= frame_memory;
+    for (const auto& interval : missing) {
+        const auto* src = reinterpret_cast<const u8*>(interval.lower());
+        data.frames.back().memory.push_back({
+            .address = interval.lower(),
+            .data = {src, src + (interval.upper() - interval.lower())},
+        });
+    }
+    frame_memory += missing;
+}
+
+void Recorder::AddLabel(const PM4CmdWaitRegMem& wait_reg_mem) {
+    data.frames.back().labels.push_back({
+        .function = wait_reg_mem.function.Value(),
+        .size = sizeof(u32),
+        .address = wait_reg_mem.Address<VAddr>(),
+        .ref = wait_reg_mem.ref,
+        .mask = wait_reg_mem.mask,
+    });
+}
+
+void Recorder::AddSemaphore(const PM4CmdMemSemaphore& semaphore) {
+    data.frames.back().labels.push_back({
+        .function = Function::Always,
+        .size = sizeof(u64),
+        .address = semaphore.Address<VAddr>(),
+        .ref = 0,
+        .mask = 0,
+    });
+}
+
+} // namespace AmdGpu::Capture
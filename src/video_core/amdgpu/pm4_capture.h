@@ -0,0 +1,205 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <array>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <vector>
+#include <boost/icl/interval_set.hpp>
+
+#include "common/types.h"
+#include "video_core/amdgpu/liverpool.h"
+#include "video_core/amdgpu/pm4_cmds.h"
+
+/**
+ * Persistent captures of the command streams submitted to the GPU, replayed by the
+ * shadps4-replay tool. A capture holds the register state at the start of the first frame and,
+ * for every frame, the submitted DCB/CCB/ACB streams together with the guest memory the command
+ * processor reads or writes while executing them: indirect buffers, constant RAM dumps, fences,
+ * labels and semaphores. Memory referenced by draws and dispatches (index buffers, indirect
+ * arguments, shader resources) is not captured, so captures are replayed without a rasterizer.
+ *
+ * The file is the magic followed by a sequence of chunks. Every frame is a run of memory and
+ * label chunks, then its submissions and a frame end chunk. Memory is copied when the first
+ * submission of the frame that references it is made.
+ */
+namespace AmdGpu::Capture {
+
+constexpr std::array<char, 8> Magic = {'S', 'H', 'A', 'D', 'P', 'M', '4', 'C'};
+constexpr u32 Version = 1;
+
+enum class ChunkType : u8 {
+    State = 1,
+    ComputeQueue = 2,
+    Memory = 3,
+    Label = 4,
+    Submit = 5,
+    FrameEnd = 6,
+};
+
+/// Chunks are written as is, reserved fields keep them free of implicit padding.
+struct FileHeader {
+    std::array<char, 8> magic;
+    u32 version;
+};
+static_assert(sizeof(FileHeader) == 12);
+
+/// Followed by the register file and the compute state of every queue.
+struct StateChunk {
+    ChunkType type;
+    std::array<u8, 3> reserved{};
+    u32 regs_size;
+    u32 num_cs_states;
+    u32 cs_state_size;
+};
+static_assert(sizeof(StateChunk) == 16);
+
+struct ComputeQueueChunk {
+    ChunkType type;
+    std::array<u8, 3> reserved{};
+    u32 vqid;
+    u32 pipe_id;
+    u32 ring_size_dw;
+    u64 ring_addr;
+};
+static_assert(sizeof(ComputeQueueChunk) == 24);
+
+/// Followed by size bytes to write at the address.
+struct MemoryChunk {
+    ChunkType type;
+    std::array<u8, 7> reserved{};
+    u64 address;
+    u64 size;
+};
+static_assert(sizeof(MemoryChunk) == 24);
+
+/// Memory polled by the command processor, set to satisfy the wait before the frame is replayed.
+struct LabelChunk {
+    ChunkType type;
+    std::array<u8, 3> reserved{};
+    PM4CmdWaitRegMem::Function function;
+    u32 size; ///< 4 for WaitRegMem labels, 8 for semaphores
+    std::array<u8, 4> reserved2{};
+    u64 address;
+    u32 ref;
+    u32 mask;
+};
+static_assert(sizeof(LabelChunk) == 32);
+
+/// Followed by the DCB and CCB words. Compute submissions only have a DCB, holding the ACB.
+struct SubmitChunk {
+    ChunkType type;
+    std::array<u8, 3> reserved{};
+    u32 vqid; ///< Zero for graphics submissions
+    u64 dcb_address;
+    u64 ccb_address;
+    u32 dcb_size_dw;
+    u32 ccb_size_dw;
+};
+static_assert(sizeof(SubmitChunk) == 32);
+
+struct State {
+    Regs regs;
+    std::array<ComputeProgram, Liverpool::NumTotalQueues> cs_states;
+};
+
+struct ComputeQueue {
+    u32 vqid;
+    u32 pipe_id;
+    u32 ring_size_dw;
+    VAddr ring_addr;
+};
+
+struct MemoryBlock {
+    VAddr address;
+    std::vector<u8> data;
+};
+
+struct Label {
+    PM4CmdWaitRegMem::Function function;
+    u32 size;
+    VAddr address;
+    u32 ref;
+    u32 mask;
+
+    /// Writes a value that satisfies the wait if the memory doesn't already.
+    void Satisfy() const;
+};
+
+struct Submit {
+    u32 vqid;
+    VAddr dcb_address;
+    VAddr ccb_address;
+    std::vector<u32> dcb;
+    std::vector<u32> ccb;
+};
+
+struct Frame {
+    std::vector<MemoryBlock> memory;
+    std::vector<Label> labels;
+    std::vector<Submit> submits;
+};
+
+struct CaptureData {
+    std::unique_ptr<State> state;
+    std::vector<ComputeQueue> queues;
+    std::vector<Frame> frames;
+};
+
+/// Reads a capture file. Returns false if the file is malformed or from another version.
+bool Load(const std::filesystem::path& path, CaptureData& capture);
+
+/// Writes a capture file. Returns false if the file could not be written.
+bool Save(const std::filesystem::path& path, const CaptureData& capture);
+
+/**
+ * Records the submissions of a number of frames. Submissions are walked when they are made, the
+ * same way the command processor executes them, to find the memory they reference.
+ */
+class Recorder {
+public:
+    explicit Recorder(std::filesystem::path path, u32 num_frames, u32 num_counter_pairs,
+                      const State& state);
+    ~Recorder();
+
+    void RecordGfx(std::span<const u32> dcb, std::span<const u32> ccb);
+    void RecordAsc(u32 gnm_vqid, const Liverpool::AscQueueInfo& queue, std::span<const u32> acb);
+
+    /// Ends the current frame, returns true once all the requested frames have been recorded.
+    bool EndFrame();
+
+    [[nodiscard]] const std::filesystem::path& GetPath() const {
+        return path;
+    }
+
+    [[nodiscard]] const CaptureData& GetData() const {
+        return data;
+    }
+
+private:
+    enum class Stream : u32 {
+        Draw,
+        Constant,
+        Compute,
+    };
+
+    /// Walks the packets of a stream and returns the words of a trailing incomplete packet.
+    std::span<const u32> Walk(std::span<const u32> cmds, Stream stream, u32 depth);
+    void RecordPacket(const PM4Header* header, Stream stream, u32 depth);
+
+    void AddMemory(VAddr address, u64 size);
+    void AddLabel(const PM4CmdWaitRegMem& wait_reg_mem);
+    void AddSemaphore(const PM4CmdMemSemaphore& semaphore);
+
+    std::filesystem::path path;
+    u32 num_frames;
+    u32 num_counter_pairs;
+    CaptureData data;
+    boost::icl::interval_set<VAddr> frame_memory;
+    std::array<std::vector<u32>, Liverpool::NumComputeRings> partial_packets;
+};
+
+} // namespace AmdGpu::Capture
@@ -1,6 +1,9 @@
 // SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
+#include <cstddef>
+
 #include "video_core/amdgpu/regs.h"
 
 namespace AmdGpu {
@@ -123,6 +126,77 @@ static_assert(GFX6_3D_REG_INDEX(primitive_type) == 0xC242);
 static_assert(GFX6_3D_REG_INDEX(num_instances) == 0xC24D);
 static_assert(GFX6_3D_REG_INDEX(vgt_tf_memory_base) == 0xc250);
 
+static const std::array<RegGroup, Regs::NumRegs> REG_GROUPS = [] {
+    std::array<RegGroup, Regs::NumRegs> groups{};
+    const auto set_range = [&groups](u32 begin, u32 end, RegGroup group) {
+        std::fill(groups.begin() + begin, groups.begin() + end, group);
+    };
+    const auto end_of = [](u32 begin, size_t size) {
+        return begin + static_cast<u32>(size / sizeof(u32));
+    };
+#define REG_RANGE(first, last)                                                                     \
+    GFX6_3D_REG_INDEX(first), end_of(GFX6_3D_REG_INDEX(last), sizeof(Regs::last))
+
+    // Every context and uconfig register is assumed to affect the pipeline, except for the ones
+    // listed here that the pipeline key never reads. They are only read as dynamic state or for
+    // resource binding on each draw.
+    set_range(Regs::ContextRegWordOffset, Regs::NumRegs, RegGroup::PipelineState);
+#define DYNAMIC_REG(reg) set_range(REG_RANGE(reg, reg), RegGroup::None)
+    DYNAMIC_REG(depth_view);
+    DYNAMIC_REG(depth_htile_data_base);
+    DYNAMIC_REG(depth_bounds_min);
+    DYNAMIC_REG(depth_bounds_max);
+    DYNAMIC_REG(stencil_clear);
+    DYNAMIC_REG(depth_clear);
+    DYNAMIC_REG(screen_scissor);
+    DYNAMIC_REG(window_offset);
+    DYNAMIC_REG(window_scissor);
+    DYNAMIC_REG(generic_scissor);
+    DYNAMIC_REG(viewport_scissors);
+    DYNAMIC_REG(viewport_depths);
+    DYNAMIC_REG(index_offset);
+    DYNAMIC_REG(primitive_restart_index);
+    DYNAMIC_REG(blend_constants);
+    DYNAMIC_REG(stencil_control);
+    DYNAMIC_REG(stencil_ref_front);
+    DYNAMIC_REG(stencil_ref_back);
+    DYNAMIC_REG(viewports);
+    DYNAMIC_REG(clip_user_data);
+    DYNAMIC_REG(index_base_address);
+    DYNAMIC_REG(draw_initiator);
+    DYNAMIC_REG(depth_control);
+    DYNAMIC_REG(line_control);
+    DYNAMIC_REG(index_size);
+    DYNAMIC_REG(max_index_size);
+    DYNAMIC_REG(index_buffer_type);
+    DYNAMIC_REG(poly_offset);
+    DYNAMIC_REG(cp_strmout_cntl);
+    DYNAMIC_REG(num_indices);
+    DYNAMIC_REG(num_instances);
+#undef DYNAMIC_REG
+
+    // Graphics shader stages, the compute program is tracked per queue.
+    for (const u32 program : {GFX6_3D_REG_INDEX(ps_program), GFX6_3D_REG_INDEX(vs_program),
+                              GFX6_3D_REG_INDEX(gs_program), GFX6_3D_REG_INDEX(es_program),
+                              GFX6_3D_REG_INDEX(hs_program), GFX6_3D_REG_INDEX(ls_program)}) {
+        const u32 user_data = program + static_cast<u32>(offsetof(ShaderProgram, user_data) / 4);
+        set_range(program, user_data, RegGroup::ShaderProgram);
+        set_range(user_data, end_of(user_data, sizeof(ShaderProgram::user_data)),
+                  RegGroup::ShaderUserData);
+    }
+#undef REG_RANGE
+    return groups;
+}();
+
+RegGroup Regs::GetGroups(u32 reg_begin, u32 num_regs) {
+    const u32 reg_end = std::min(reg_begin + num_regs, NumRegs);
+    RegGroup groups{};
+    for (u32 reg = reg_begin; reg < reg_end; ++reg) {
+        groups |= REG_GROUPS[reg];
+    }
+    return groups;
+}
+
 #undef GFX6_3D_REG_INDEX
 
 } // namespace AmdGpu
@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include "common/enum.h"
 #include "video_core/amdgpu/regs_color.h"
 #include "video_core/amdgpu/regs_depth.h"
 #include "video_core/amdgpu/regs_primitive.h"
@@ -17,6 +18,16 @@ namespace AmdGpu {
 #define INSERT_PADDING_WORDS(num_words)                                                            \
     [[maybe_unused]] std::array<u32, num_words> CONCAT2(pad, __LINE__)
 
+/// Groups of registers that cached rasterizer state is derived from, used for dirty tracking.
+enum class RegGroup : u8 {
+    None = 0,
+    PipelineState = 1 << 0,  ///< Context and uconfig registers read by the graphics pipeline key
+    ShaderProgram = 1 << 1,  ///< Program address and settings of the graphics stages
+    ShaderUserData = 1 << 2, ///< User data of the graphics stages
+    All = PipelineState | ShaderProgram | ShaderUserData,
+};
+DECLARE_ENUM_FLAG_OPERATORS(RegGroup)
+
 union Regs {
     static constexpr u32 NumRegs = 0xD000;
     static constexpr u32 UconfigRegWordOffset = 0xC000;
@@ -180,6 +191,9 @@ union Regs {
     }
 
     void SetDefaults();
+
+    /// Returns the groups of the registers in [reg_begin, reg_begin + num_regs).
+    static RegGroup GetGroups(u32 reg_begin, u32 num_regs);
 };
 
 #undef DO_CONCAT2
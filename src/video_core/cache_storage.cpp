@@ -13,11 +13,15 @@
 
 #include <miniz.h>
 
+#include <algorithm>
 #include <condition_variable>
+#include <cstring>
 #include <functional>
 #include <future>
+#include <limits>
 #include <mutex>
 #include <queue>
+#include <unordered_map>
 
 namespace {
 
@@ -27,7 +31,44 @@ std::condition_variable_any request_cv{};
 std::queue<std::packaged_task<void()>> req_queue{};
 std::mutex m_request{};
 
-mz_zip_archive zip_ar{};
+// Archived caches are stored in a single append-only container: a ContainerHeader followed by
+// records made of a BlobHeader, the blob name and the blob data. The whole container is read once
+// on open and indexed by blob name, new blobs are appended to the end of the file, so nothing
+// needs to be rewritten on close. Records replaced by newer ones are dropped on open.
+constexpr u32 ContainerMagic = 0x43505353; // "SSPC"
+constexpr u32 ContainerVersion = 1u;
+
+enum class BlobCompression : u32 {
+    None,
+    Deflate,
+};
+
+struct ContainerHeader {
+    u32 magic;
+    u32 version;
+};
+
+struct BlobHeader {
+    Storage::BlobType type;
+    BlobCompression compression;
+    u32 name_size;
+    u32 reserved;
+    u64 stored_size;
+    u64 raw_size;
+};
+
+struct BlobEntry {
+    Storage::BlobType type;
+    BlobCompression compression;
+    u64 offset;
+    u64 stored_size;
+    u64 raw_size;
+};
+
+Common::FS::IOFile container_file{};
+u64 container_size{}; // end of the last complete record in container_file
+std::vector<u8> container_data{};
+std::unordered_map<std::string, BlobEntry> container_index{};
 bool ar_is_read_only{true};
 
 } // namespace
@@ -87,30 +128,226 @@ constexpr std::string GetBlobFileExtension(BlobType type) {
     }
 }
 
+/// Rewrites the container with only the records referenced by the index, in file order.
+static void CompactContainer(const std::filesystem::path& path, size_t live_size) {
+    using namespace Common::FS;
+
+    std::vector<std::pair<const std::string*, BlobEntry*>> records;
+    records.reserve(container_index.size());
+    for (auto& [name, entry] : container_index) {
+        records.emplace_back(&name, &entry);
+    }
+    std::ranges::sort(records, {}, [](const auto& record) { return record.second->offset; });
+
+    std::vector<u8> compacted(live_size);
+    const ContainerHeader header{ContainerMagic, ContainerVersion};
+    std::memcpy(compacted.data(), &header, sizeof(header));
+    std::vector<u64> offsets;
+    offsets.reserve(records.size());
+    size_t offset = sizeof(header);
+    for (const auto& [name, entry] : records) {
+        const BlobHeader blob{
+            .type = entry->type,
+            .compression = entry->compression,
+            .name_size = static_cast<u32>(name->size()),
+            .stored_size = entry->stored_size,
+            .raw_size = entry->raw_size,
+        };
+        std::memcpy(compacted.data() + offset, &blob, sizeof(blob));
+        offset += sizeof(blob);
+        std::memcpy(compacted.data() + offset, name->data(), name->size());
+        offset += name->size();
+        std::memcpy(compacted.data() + offset, container_data.data() + entry->offset,
+                    entry->stored_size);
+        offsets.push_back(offset);
+        offset += entry->stored_size;
+    }
+
+    // Write a copy first so the existing container survives a failed write.
+    auto temp_path = path;
+    temp_path += ".tmp";
+    bool written{};
+    {
+        const auto file = IOFile{temp_path, FileAccessMode::Create};
+        written = file.IsOpen() && file.Write(compacted) == compacted.size();
+    }
+    std::error_code ec;
+    if (written) {
+        std::filesystem::rename(temp_path, path, ec);
+    }
+    if (!written || ec) {
+        LOG_WARNING(Render, "Failed to compact cache archive {}", path.string().c_str());
+        std::filesystem::remove(temp_path, ec);
+        return;
+    }
+    for (size_t i = 0; i < records.size(); ++i) {
+        records[i].second->offset = offsets[i];
+    }
+    LOG_INFO(Render, "Compacted cache archive {} from {} to {} bytes", path.string().c_str(),
+             container_data.size(), compacted.size());
+    container_data = std::move(compacted);
+}
+
+/// Checks the sizes of a record against each other. Deflate can't shrink data by more than
+/// about 1:1032, so a larger raw size can only come from a corrupt header.
+static bool IsValidBlob(const BlobHeader& blob) {
+    switch (blob.compression) {
+    case BlobCompression::None:
+        return blob.raw_size == blob.stored_size;
+    case BlobCompression::Deflate:
+        return blob.raw_size <= std::numeric_limits<mz_ulong>::max() &&
+               blob.raw_size / 1032 <= blob.stored_size;
+    default:
+        return false;
+    }
+}
+
+static void LoadContainer(const std::filesystem::path& path) {
+    using namespace Common::FS;
+
+    container_index.clear();
+    container_data.clear();
+    {
+        const auto file = IOFile{path, FileAccessMode::Read};
+        if (file.IsOpen()) {
+            container_data.resize(file.GetSize());
+            file.Read(container_data);
+        }
+    }
+
+    ContainerHeader header{};
+    if (container_data.size() >= sizeof(header)) {
+        std::memcpy(&header, container_data.data(), sizeof(header));
+    }
+    if (header.magic != ContainerMagic || header.version != ContainerVersion) {
+        LOG_INFO(Render, "Cache archive {} is not found or has an incompatible format",
+                 path.string().c_str());
+        container_data.clear();
+        const auto file = IOFile{path, FileAccessMode::Create};
+        file.WriteObject(ContainerHeader{ContainerMagic, ContainerVersion});
+        return;
+    }
+
+    // Sizes come from the file, compare them against what is left so nothing can overflow.
+    size_t offset = sizeof(header);
+    while (container_data.size() - offset >= sizeof(BlobHeader)) {
+        BlobHeader blob{};
+        std::memcpy(&blob, container_data.data() + offset, sizeof(blob));
+        const size_t name_offset = offset + sizeof(blob);
+        if (blob.name_size > container_data.size() - name_offset) {
+            break;
+        }
+        const size_t data_offset = name_offset + blob.name_size;
+        if (blob.stored_size > container_data.size() - data_offset || !IsValidBlob(blob)) {
+            break;
+        }
+        std::string name{reinterpret_cast<const char*>(container_data.data() + name_offset),
+                         blob.name_size};
+        // Later records override earlier ones with the same name.
+        container_index.insert_or_assign(std::move(name),
+                                         BlobEntry{blob.type, blob.compression, data_offset,
+                                                   blob.stored_size, blob.raw_size});
+        offset = data_offset + blob.stored_size;
+    }
+
+    if (offset != container_data.size()) {
+        // Most likely the emulator was closed while a blob was being appended. Failed appends
+        // are cut off when they happen, so this can only be the end of the file.
+        LOG_WARNING(Render, "Cache archive {} has a truncated record, dropping {} bytes",
+                    path.string().c_str(), container_data.size() - offset);
+        const auto file = IOFile{path, FileAccessMode::ReadWrite};
+        file.SetSize(offset);
+        container_data.resize(offset);
+    }
+
+    // Blobs saved again leave their older records behind, drop them once they waste a quarter
+    // of the container.
+    size_t live_size = sizeof(ContainerHeader);
+    for (const auto& [name, entry] : container_index) {
+        live_size += sizeof(BlobHeader) + name.size() + entry.stored_size;
+    }
+    if (live_size < container_data.size() - container_data.size() / 4) {
+        CompactContainer(path, live_size);
+    }
+}
+
+template <typename T>
+static void ReadBlob(const BlobEntry& entry, std::vector<T>& v) {
+    if (entry.raw_size % sizeof(T) != 0) {
+        LOG_ERROR(Render, "Cache blob size {} is not a multiple of {}", entry.raw_size, sizeof(T));
+        v.clear();
+        return;
+    }
+    v.resize(entry.raw_size / sizeof(T));
+    const u8* data = container_data.data() + entry.offset;
+    if (entry.compression == BlobCompression::Deflate) {
+        mz_ulong size = entry.raw_size;
+        if (mz_uncompress(reinterpret_cast<u8*>(v.data()), &size, data, entry.stored_size) !=
+                MZ_OK ||
+            size != entry.raw_size) {
+            LOG_ERROR(Render, "Failed to decompress cache blob");
+            v.clear();
+        }
+    } else {
+        std::memcpy(v.data(), data, entry.raw_size);
+    }
+}
+
+static void AppendBlob(BlobType type, const std::string& name, const void* data, size_t size) {
+    ASSERT_MSG(!ar_is_read_only,
+               "The archive is read-only. Did you forget to call `FinishPreload`?");
+
+    BlobHeader header{
+        .type = type,
+        .compression = BlobCompression::None,
+        .name_size = static_cast<u32>(name.size()),
+        .stored_size = size,
+        .raw_size = size,
+    };
+
+    // Store the blob compressed only when it actually gets smaller.
+    std::vector<u8> compressed(mz_compressBound(size));
+    mz_ulong compressed_size = compressed.size();
+    if (mz_compress2(compressed.data(), &compressed_size, static_cast<const u8*>(data), size,
+                     MZ_DEFAULT_LEVEL) == MZ_OK &&
+        compressed_size < size) {
+        header.compression = BlobCompression::Deflate;
+        header.stored_size = compressed_size;
+        data = compressed.data();
+    }
+
+    // Assemble the whole record first so a partial write can only happen at the very end.
+    std::vector<u8> record(sizeof(header) + name.size() + header.stored_size);
+    std::memcpy(record.data(), &header, sizeof(header));
+    std::memcpy(record.data() + sizeof(header), name.data(), name.size());
+    std::memcpy(record.data() + sizeof(header) + name.size(), data, header.stored_size);
+    if (container_file.Write(record) != record.size()) {
+        // Cut the partial record off, or the blobs appended after it couldn't be loaded.
+        LOG_ERROR(Render, "Failed to add {} to the archive", name);
+        container_file.Flush();
+        container_file.SetSize(container_size);
+        return;
+    }
+    container_size += record.size();
+}
+
 void DataBase::Open() {
+    Open(std::string{Common::ElfInfo::Instance().GameSerial()});
+}
+
+void DataBase::Open(const std::string& serial) {
     if (opened) {
         return;
     }
 
-    const auto& game_info = Common::ElfInfo::Instance();
-
     using namespace Common::FS;
     if (Config::isPipelineCacheArchived()) {
-        mz_zip_zero_struct(&zip_ar);
-
         cache_path = GetUserPath(PathType::CacheDir) /
-                     std::filesystem::path{game_info.GameSerial()}.replace_extension(".zip");
-
-        if (!mz_zip_reader_init_file(&zip_ar, cache_path.string().c_str(),
-                                     MZ_ZIP_FLAG_READ_ALLOW_WRITING) ||
-            !mz_zip_validate_archive(&zip_ar, 0)) {
-            LOG_INFO(Render, "Cache archive {} is not found or archive is corrupted",
-                     cache_path.string().c_str());
-            mz_zip_reader_end(&zip_ar);
-            mz_zip_writer_init_file(&zip_ar, cache_path.string().c_str(), 0);
-        }
+                     std::filesystem::path{serial}.replace_extension(".cache");
+        LoadContainer(cache_path);
+        ar_is_read_only = true;
     } else {
-        cache_path = GetUserPath(PathType::CacheDir) / game_info.GameSerial();
+        cache_path = GetUserPath(PathType::CacheDir) / serial;
         if (!std::filesystem::exists(cache_path)) {
             std::filesystem::create_directories(cache_path);
         }
@@ -129,8 +366,10 @@ void DataBase::Close() {
     io_worker.join();
 
     if (Config::isPipelineCacheArchived()) {
-        mz_zip_writer_finalize_archive(&zip_ar);
-        mz_zip_writer_end(&zip_ar);
+        container_file.Close();
+        container_index.clear();
+        container_data.clear();
+        container_data.shrink_to_fit();
     }
 
     LOG_INFO(Render, "Cache dumped");
@@ -143,12 +382,7 @@ bool WriteVector(const BlobType type, std::filesystem::path&& path_, std::vector
             auto path{path_};
             path.replace_extension(GetBlobFileExtension(type));
             if (Config::isPipelineCacheArchived()) {
-                ASSERT_MSG(!ar_is_read_only,
-                           "The archive is read-only. Did you forget to call `FinishPreload`?");
-                if (!mz_zip_writer_add_mem(&zip_ar, path.string().c_str(), v.data(),
-                                           v.size() * sizeof(T), MZ_BEST_COMPRESSION)) {
-                    LOG_ERROR(Render, "Failed to add {} to the archive", path.string().c_str());
-                }
+                AppendBlob(type, path.string(), v.data(), v.size() * sizeof(T));
             } else {
                 using namespace Common::FS;
                 const auto file = IOFile{path, FileAccessMode::Create};
@@ -170,16 +404,12 @@ void LoadVector(BlobType type, std::filesystem::path& path, std::vector<T>& v) {
     using namespace Common::FS;
     path.replace_extension(GetBlobFileExtension(type));
     if (Config::isPipelineCacheArchived()) {
-        int index{-1};
-        index = mz_zip_reader_locate_file(&zip_ar, path.string().c_str(), nullptr, 0);
-        if (index < 0) {
+        const auto it = container_index.find(path.string());
+        if (it == container_index.end()) {
             LOG_WARNING(Render, "File {} is not found in the archive", path.string().c_str());
             return;
         }
-        mz_zip_archive_file_stat stat{};
-        mz_zip_reader_file_stat(&zip_ar, index, &stat);
-        v.resize(stat.m_uncomp_size / sizeof(T));
-        mz_zip_reader_extract_to_mem(&zip_ar, index, v.data(), stat.m_uncomp_size, 0);
+        ReadBlob(it->second, v);
     } else {
         const auto file = IOFile{path, FileAccessMode::Read};
         v.resize(file.GetSize() / sizeof(T));
@@ -226,16 +456,10 @@ void DataBase::Load(BlobType type, const std::string& name, std::vector<u32>& da
 void DataBase::ForEachBlob(BlobType type, const std::function<void(std::vector<u8>&& data)>& func) {
     const auto& ext = GetBlobFileExtension(type);
     if (Config::isPipelineCacheArchived()) {
-        const auto num_files = mz_zip_reader_get_num_files(&zip_ar);
-        for (int index = 0; index < num_files; ++index) {
-            std::array<char, MZ_ZIP_MAX_ARCHIVE_FILENAME_SIZE> file_name{};
-            file_name.fill(0);
-            mz_zip_reader_get_filename(&zip_ar, index, file_name.data(), file_name.size());
-            if (std::string{file_name.data()}.ends_with(ext)) {
-                mz_zip_archive_file_stat stat{};
-                mz_zip_reader_file_stat(&zip_ar, index, &stat);
-                std::vector<u8> data(stat.m_uncomp_size);
-                mz_zip_reader_extract_to_mem(&zip_ar, index, data.data(), data.size(), 0);
+        for (const auto& [name, entry] : container_index) {
+            if (entry.type == type) {
+                std::vector<u8> data;
+                ReadBlob(entry, data);
                 func(std::move(data));
             }
         }
@@ -256,7 +480,11 @@ void DataBase::ForEachBlob(BlobType type, const std::function<void(std::vector<u
 
 void DataBase::FinishPreload() {
     if (Config::isPipelineCacheArchived()) {
-        mz_zip_writer_init_from_reader(&zip_ar, cache_path.string().c_str());
+        // Blobs are only read during the preload, new ones are appended to the file directly.
+        container_index.clear();
+        std::vector<u8>{}.swap(container_data);
+        container_file.Open(cache_path, Common::FS::FileAccessMode::Append);
+        container_size = container_file.GetSize();
         ar_is_read_only = false;
     }
 }
@@ -27,6 +27,7 @@ public:
     }
 
     void Open();
+    void Open(const std::string& serial);
     void Close();
     [[nodiscard]] bool IsOpened() const {
         return opened;
@@ -2,11 +2,15 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 
 #include <ranges>
+#include <boost/container/static_vector.hpp>
 
 #include "common/config.h"
 #include "common/hash.h"
 #include "common/io_file.h"
 #include "common/path_util.h"
+#include "common/polyfill_thread.h"
+#include "common/scope_exit.h"
+#include "common/thread.h"
 #include "core/debug_state.h"
 #include "shader_recompiler/backend/spirv/emit_spirv.h"
 #include "shader_recompiler/info.h"
@@ -270,6 +274,10 @@ PipelineCache::PipelineCache(const Instance& instance_, Scheduler& scheduler_,
 
     WarmUp();
 
+    for (auto& worker : compile_workers) {
+        worker = std::jthread(std::bind_front(&PipelineCache::ShaderCompileThread, this));
+    }
+
     auto [cache_result, cache] = instance.GetDevice().createPipelineCacheUnique({});
     ASSERT_MSG(cache_result == vk::Result::eSuccess, "Failed to create pipeline cache: {}",
                vk::to_string(cache_result));
@@ -279,9 +287,19 @@ PipelineCache::PipelineCache(const Instance& instance_, Scheduler& scheduler_,
 PipelineCache::~PipelineCache() = default;
 
 const GraphicsPipeline* PipelineCache::GetGraphicsPipeline() {
-    if (!RefreshGraphicsKey()) {
+    // Draws with identical state are common, skip rebuilding the key if no register it is
+    // derived from has been written since the last draw.
+    const auto dirty_regs = liverpool->ConsumeDirtyRegs(AmdGpu::RegGroup::All);
+    if (last_graphics_pipeline && graphics_stages_reusable && False(dirty_regs)) {
+        return last_graphics_pipeline;
+    }
+    if (!RefreshGraphicsKey(dirty_regs)) {
+        last_graphics_pipeline = nullptr;
         return nullptr;
     }
+    if (last_graphics_pipeline && graphics_key == last_graphics_key) {
+        return last_graphics_pipeline;
+    }
     const auto [it, is_new] = graphics_pipelines.try_emplace(graphics_key);
     if (is_new) {
         const auto pipeline_hash = std::hash<GraphicsPipelineKey>{}(graphics_key);
@@ -305,7 +323,9 @@ const GraphicsPipeline* PipelineCache::GetGraphicsPipeline() {
         }
         fetch_shader.reset();
     }
-    return it->second.get();
+    last_graphics_key = graphics_key;
+    last_graphics_pipeline = it->second.get();
+    return last_graphics_pipeline;
 }
 
 const ComputePipeline* PipelineCache::GetComputePipeline() {
@@ -332,7 +352,7 @@ const ComputePipeline* PipelineCache::GetComputePipeline() {
     return it->second.get();
 }
 
-bool PipelineCache::RefreshGraphicsKey() {
+bool PipelineCache::RefreshGraphicsKey(AmdGpu::RegGroup dirty_regs) {
     std::memset(&graphics_key, 0, sizeof(GraphicsPipelineKey));
     const auto& regs = liverpool->regs;
     auto& key = graphics_key;
@@ -378,7 +398,7 @@ bool PipelineCache::RefreshGraphicsKey() {
     }
 
     // Compile and bind shader stages
-    if (!RefreshGraphicsStages()) {
+    if (!RefreshGraphicsStages(dirty_regs)) {
         return false;
     }
 
@@ -425,23 +445,17 @@ bool PipelineCache::RefreshGraphicsKey() {
     return true;
 }
 
-bool PipelineCache::RefreshGraphicsStages() {
+bool PipelineCache::RefreshGraphicsStages(AmdGpu::RegGroup dirty_regs) {
     const auto& regs = liverpool->regs;
     auto& key = graphics_key;
     fetch_shader = std::nullopt;
+    graphics_stages_reusable = false;
 
     Shader::Backend::Bindings binding{};
     const auto bind_stage = [&](Shader::Stage stage_in, Shader::LogicalStage stage_out) -> bool {
-        const auto stage_in_idx = static_cast<u32>(stage_in);
         const auto stage_out_idx = static_cast<u32>(stage_out);
-        if (!regs.stage_enable.IsStageEnabled(stage_in_idx)) {
-            key.stage_hashes[stage_out_idx] = 0;
-            infos[stage_out_idx] = nullptr;
-            return false;
-        }
-
-        const auto* pgm = regs.ProgramForStage(stage_in_idx);
-        if (!pgm || !pgm->Address<u32*>()) {
+        const auto* pgm = GetStageProgram(stage_in);
+        if (!pgm) {
             key.stage_hashes[stage_out_idx] = 0;
             infos[stage_out_idx] = nullptr;
             return false;
@@ -460,22 +474,32 @@ bool PipelineCache::RefreshGraphicsStages() {
 
     infos.fill(nullptr);
     modules.fill(nullptr);
+
+    // Translations queued here are only valid for the current register state. Programs bound by
+    // the last refresh are already in the cache if no stage was changed since.
+    if (True(dirty_regs & (AmdGpu::RegGroup::PipelineState | AmdGpu::RegGroup::ShaderProgram))) {
+        PrefetchGraphicsStages();
+    }
+    SCOPE_EXIT {
+        DiscardPendingPrograms();
+    };
+
     bind_stage(Stage::Fragment, LogicalStage::Fragment);
 
     const auto* fs_info = infos[static_cast<u32>(LogicalStage::Fragment)];
     key.mrt_mask = fs_info ? fs_info->mrt_mask : 0u;
     key.num_color_attachments = std::bit_width(key.mrt_mask);
 
+    if (!IsGraphicsStageSetupSupported()) {
+        LOG_WARNING(Render_Vulkan, "Unsupported {} stage setup, skipping",
+                    regs.stage_enable.raw == AmdGpu::ShaderStageEnable::VgtStages::EsGs
+                        ? "geometry"
+                        : "tessellation");
+        return false;
+    }
+
     switch (regs.stage_enable.raw) {
     case AmdGpu::ShaderStageEnable::VgtStages::EsGs:
-        if (!instance.IsGeometryStageSupported()) {
-            LOG_WARNING(Render_Vulkan, "Geometry shader stage unsupported, skipping");
-            return false;
-        }
-        if (regs.vgt_gs_mode.onchip || regs.vgt_strmout_config.raw) {
-            LOG_WARNING(Render_Vulkan, "Geometry shader features unsupported, skipping");
-            return false;
-        }
         if (!bind_stage(Stage::Export, LogicalStage::Vertex)) {
             return false;
         }
@@ -484,11 +508,6 @@ bool PipelineCache::RefreshGraphicsStages() {
         }
         break;
     case AmdGpu::ShaderStageEnable::VgtStages::LsHs:
-        if (!instance.IsTessellationSupported() ||
-            (regs.tess_config.type == AmdGpu::TessellationType::Isoline &&
-             !instance.IsTessellationIsolinesSupported())) {
-            return false;
-        }
         if (!bind_stage(Stage::Hull, LogicalStage::TessellationControl)) {
             return false;
         }
@@ -517,6 +536,13 @@ bool PipelineCache::RefreshGraphicsStages() {
         }
     }
 
+    // Stage specializations that read fetch shaders, sharps or tessellation constants from
+    // memory have to be checked on every draw, as memory can change without register writes.
+    graphics_stages_reusable =
+        !fetch_shader && regs.stage_enable.raw != AmdGpu::ShaderStageEnable::VgtStages::LsHs &&
+        std::ranges::none_of(infos, [](const Shader::Info* info) {
+            return info && info->srt_info.walker_func;
+        });
     return true;
 }
 
@@ -535,8 +561,17 @@ vk::ShaderModule PipelineCache::CompileModule(Shader::Info& info, Shader::Runtim
     LOG_INFO(Render_Vulkan, "Compiling {} shader {:#x} {}", info.stage, info.pgm_hash,
              perm_idx != 0 ? "(permutation)" : "");
     DumpShader(code, info.pgm_hash, info.stage, perm_idx, "bin");
+    DumpShader(info.user_data, info.pgm_hash, info.stage, perm_idx, "ud");
 
     const auto ir_program = Shader::TranslateProgram(code, pools, info, runtime_info, profile);
+    return EmitModule(ir_program, runtime_info, code, perm_idx, binding);
+}
+
+vk::ShaderModule PipelineCache::EmitModule(const Shader::IR::Program& ir_program,
+                                           Shader::RuntimeInfo& runtime_info,
+                                           const std::span<const u32>& code, size_t perm_idx,
+                                           Shader::Backend::Bindings& binding) {
+    const auto& info = ir_program.info;
     auto spv = Shader::Backend::SPIRV::EmitSPIRV(profile, runtime_info, ir_program, binding);
     DumpShader(spv, info.pgm_hash, info.stage, perm_idx, "spv");
 
@@ -562,16 +597,150 @@ vk::ShaderModule PipelineCache::CompileModule(Shader::Info& info, Shader::Runtim
     return module;
 }
 
+const AmdGpu::ShaderProgram* PipelineCache::GetStageProgram(Shader::Stage stage) const {
+    const auto& regs = liverpool->regs;
+    const auto stage_idx = static_cast<u32>(stage);
+    if (!regs.stage_enable.IsStageEnabled(stage_idx)) {
+        return nullptr;
+    }
+    const auto* pgm = regs.ProgramForStage(stage_idx);
+    if (!pgm || !pgm->Address<u32*>()) {
+        return nullptr;
+    }
+    return pgm;
+}
+
+bool PipelineCache::IsGraphicsStageSetupSupported() const {
+    const auto& regs = liverpool->regs;
+    switch (regs.stage_enable.raw) {
+    case AmdGpu::ShaderStageEnable::VgtStages::EsGs:
+        return instance.IsGeometryStageSupported() && !regs.vgt_gs_mode.onchip &&
+               !regs.vgt_strmout_config.raw;
+    case AmdGpu::ShaderStageEnable::VgtStages::LsHs:
+        return instance.IsTessellationSupported() &&
+               (regs.tess_config.type != AmdGpu::TessellationType::Isoline ||
+                instance.IsTessellationIsolinesSupported());
+    default:
+        return true;
+    }
+}
+
+void PipelineCache::PrefetchGraphicsStages() {
+    const auto& regs = liverpool->regs;
+
+    // Only queue the stages RefreshGraphicsStages looks up: the fragment stage, then the pipeline
+    // stages if their setup is supported, up to the first missing one that fails the bind.
+    boost::container::static_vector<std::pair<Stage, LogicalStage>, MaxShaderStages> stages;
+    bool stop_at_missing = true;
+    stages.emplace_back(Stage::Fragment, LogicalStage::Fragment);
+    if (IsGraphicsStageSetupSupported()) {
+        switch (regs.stage_enable.raw) {
+        case AmdGpu::ShaderStageEnable::VgtStages::EsGs:
+            stages.emplace_back(Stage::Export, LogicalStage::Vertex);
+            stages.emplace_back(Stage::Geometry, LogicalStage::Geometry);
+            break;
+        case AmdGpu::ShaderStageEnable::VgtStages::LsHs:
+            // The local stage runtime info is built from the hull shader info, so it is left to
+            // GetProgram.
+            stages.emplace_back(Stage::Hull, LogicalStage::TessellationControl);
+            stages.emplace_back(Stage::Vertex, LogicalStage::TessellationEval);
+            break;
+        default:
+            stages.emplace_back(Stage::Vertex, LogicalStage::Vertex);
+            stop_at_missing = false;
+            break;
+        }
+    }
+
+    // The first stage missing from the cache is translated inline by GetProgram while the
+    // workers handle the remaining ones. Binding assignment and SPIR-V emission stay in order.
+    bool translate_inline = true;
+    u32 num_queued = 0;
+    for (const auto [stage, l_stage] : stages) {
+        const auto* pgm = GetStageProgram(stage);
+        if (!pgm) {
+            if (stop_at_missing && stage != Stage::Fragment) {
+                break;
+            }
+            continue;
+        }
+        const auto params = AmdGpu::GetParams(*pgm);
+        if (program_cache.contains(params.hash) || pending_programs.contains(params.hash)) {
+            continue;
+        }
+        if (std::exchange(translate_inline, false)) {
+            continue;
+        }
+
+        auto pending = std::make_unique<PendingProgram>();
+        pending->program = std::make_unique<Program>(stage, l_stage, params);
+        pending->runtime_info = BuildRuntimeInfo(stage, l_stage);
+        pending->code = params.code;
+        pending->pools = &compile_pools[num_queued++];
+        pending->translated = pending->promise.get_future();
+
+        LOG_INFO(Render_Vulkan, "Compiling {} shader {:#x}", stage, params.hash);
+        DumpShader(params.code, params.hash, stage, 0, "bin");
+        DumpShader(params.user_data, params.hash, stage, 0, "ud");
+        {
+            std::scoped_lock lk{compile_mutex};
+            compile_queue.push(pending.get());
+        }
+        compile_cv.notify_one();
+        pending_programs.emplace(params.hash, std::move(pending));
+    }
+}
+
+void PipelineCache::DiscardPendingPrograms() {
+    // Stages that were not consumed belong to a pipeline that failed to bind.
+    for (auto& [_, pending] : pending_programs) {
+        pending->translated.wait();
+    }
+    pending_programs.clear();
+}
+
+void PipelineCache::ShaderCompileThread(std::stop_token stoken) {
+    Common::SetCurrentThreadName("shadPS4:ShaderCompiler");
+
+    while (!stoken.stop_requested()) {
+        PendingProgram* pending;
+        {
+            std::unique_lock lk{compile_mutex};
+            Common::CondvarWait(compile_cv, lk, stoken, [this] { return !compile_queue.empty(); });
+            if (stoken.stop_requested()) {
+                break;
+            }
+            pending = compile_queue.front();
+            compile_queue.pop();
+        }
+
+        pending->ir_program.emplace(Shader::TranslateProgram(
+            pending->code, *pending->pools, pending->program->info, pending->runtime_info, profile));
+        pending->promise.set_value();
+    }
+}
+
 PipelineCache::Result PipelineCache::GetProgram(Stage stage, LogicalStage l_stage,
                                                 const Shader::ShaderParams& params,
                                                 Shader::Backend::Bindings& binding) {
     auto runtime_info = BuildRuntimeInfo(stage, l_stage);
     auto [it_pgm, new_program] = program_cache.try_emplace(params.hash);
     if (new_program) {
-        it_pgm.value() = std::make_unique<Program>(stage, l_stage, params);
-        auto& program = it_pgm.value();
         auto start = binding;
-        const auto module = CompileModule(program->info, runtime_info, params.code, 0, binding);
+        vk::ShaderModule module;
+        if (const auto it_pending = pending_programs.find(params.hash);
+            it_pending != pending_programs.end()) {
+            auto& pending = it_pending->second;
+            pending->translated.wait();
+            it_pgm.value() = std::move(pending->program);
+            runtime_info = pending->runtime_info;
+            module = EmitModule(*pending->ir_program, runtime_info, params.code, 0, binding);
+            pending_programs.erase(it_pending);
+        } else {
+            it_pgm.value() = std::make_unique<Program>(stage, l_stage, params);
+            module = CompileModule(it_pgm.value()->info, runtime_info, params.code, 0, binding);
+        }
+        auto& program = it_pgm.value();
         auto spec = Shader::StageSpecialization(program->info, runtime_info, profile, start);
         const auto perm_hash = HashCombine(params.hash, 0);
 
@@ -593,7 +762,7 @@ PipelineCache::Result PipelineCache::GetProgram(Stage stage, LogicalStage l_stag
 
     vk::ShaderModule module{};
 
-    const auto it = std::ranges::find(program->modules, spec, &Program::Module::spec);
+    const auto it = program->FindPermut(spec);
     if (it == program->modules.end()) {
         auto new_info = Shader::Info(stage, l_stage, params);
         module = CompileModule(new_info, runtime_info, params.code, perm_idx, binding);
@@ -629,6 +798,7 @@ std::optional<vk::ShaderModule> PipelineCache::ReplaceShader(vk::ShaderModule mo
             if (std::holds_alternative<GraphicsPipelineKey>(key)) {
                 auto& graphics_key = std::get<GraphicsPipelineKey>(key);
                 graphics_pipelines.erase(graphics_key);
+                last_graphics_pipeline = nullptr;
             } else if (std::holds_alternative<ComputePipelineKey>(key)) {
                 auto& compute_key = std::get<ComputePipelineKey>(key);
                 compute_pipelines.erase(compute_key);
@@ -3,6 +3,13 @@
 
 #pragma once
 
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <unordered_map>
 #include <variant>
 #include <tsl/robin_map.h>
 #include "shader_recompiler/profile.h"
@@ -47,19 +54,44 @@ struct Program {
 
     Shader::Info info;
     ModuleList modules{};
+    std::unordered_multimap<u64, size_t> permut_index; ///< Specialization hash to module index
 
     Program() = default;
     Program(Shader::Stage stage, Shader::LogicalStage l_stage, Shader::ShaderParams params)
         : info{stage, l_stage, params} {}
 
+    /// Finds a permutation compatible with the specialization, only comparing the ones with a
+    /// matching hash.
+    ModuleList::iterator FindPermut(const Shader::StageSpecialization& spec) {
+        const auto [begin, end] = permut_index.equal_range(spec.hash);
+        for (auto it = begin; it != end; ++it) {
+            if (modules[it->second].spec == spec) {
+                return modules.begin() + it->second;
+            }
+        }
+        return modules.end();
+    }
+
     void AddPermut(vk::ShaderModule module, Shader::StageSpecialization&& spec) {
+        permut_index.emplace(spec.hash, modules.size());
         modules.emplace_back(module, std::move(spec));
     }
 
     void InsertPermut(vk::ShaderModule module, Shader::StageSpecialization&& spec,
                       size_t perm_idx) {
         modules.resize(std::max(modules.size(), perm_idx + 1)); // <-- beware of realloc
-        modules[perm_idx] = {module, std::move(spec)};
+        auto& entry = modules[perm_idx];
+        if (entry.spec.Valid()) {
+            const auto [begin, end] = permut_index.equal_range(entry.spec.hash);
+            const auto it = std::find_if(begin, end, [&](const auto& p) {
+                return p.second == perm_idx;
+            });
+            if (it != end) {
+                permut_index.erase(it);
+            }
+        }
+        permut_index.emplace(spec.hash, perm_idx);
+        entry = {module, std::move(spec)};
     }
 };
 
@@ -96,8 +128,8 @@ public:
     }
 
 private:
-    bool RefreshGraphicsKey();
-    bool RefreshGraphicsStages();
+    bool RefreshGraphicsKey(AmdGpu::RegGroup dirty_regs);
+    bool RefreshGraphicsStages(AmdGpu::RegGroup dirty_regs);
     bool RefreshComputeKey();
 
     void DumpShader(std::span<const u32> code, u64 hash, Shader::Stage stage, size_t perm_idx,
@@ -107,12 +139,44 @@ private:
     vk::ShaderModule CompileModule(Shader::Info& info, Shader::RuntimeInfo& runtime_info,
                                    const std::span<const u32>& code, size_t perm_idx,
                                    Shader::Backend::Bindings& binding);
+    vk::ShaderModule EmitModule(const Shader::IR::Program& ir_program,
+                                Shader::RuntimeInfo& runtime_info,
+                                const std::span<const u32>& code, size_t perm_idx,
+                                Shader::Backend::Bindings& binding);
+    /// Returns the program of an enabled stage, or null if the stage isn't bound.
+    const AmdGpu::ShaderProgram* GetStageProgram(Shader::Stage stage) const;
+    /// Returns false if the enabled stages need features the device doesn't have.
+    bool IsGraphicsStageSetupSupported() const;
+    void PrefetchGraphicsStages();
+    void DiscardPendingPrograms();
+    void ShaderCompileThread(std::stop_token stoken);
     const Shader::RuntimeInfo& BuildRuntimeInfo(Shader::Stage stage, Shader::LogicalStage l_stage);
 
     [[nodiscard]] bool IsPipelineCacheDirty() const {
         return num_new_pipelines > 0;
     }
 
+    void CreatePreloadedPipelines();
+
+    /// Pipeline creation deferred by the loaders, executed in parallel at the end of WarmUp.
+    struct PreloadJob {
+        std::variant<GraphicsPipelineKey, ComputePipelineKey> key;
+        std::function<std::unique_ptr<Pipeline>()> create;
+    };
+
+    /// Stage translation started on a compile worker ahead of GetProgram.
+    struct PendingProgram {
+        std::unique_ptr<Program> program;
+        Shader::RuntimeInfo runtime_info;
+        std::span<const u32> code;
+        Shader::Pools* pools;
+        std::optional<Shader::IR::Program> ir_program;
+        std::promise<void> promise;
+        std::future<void> translated;
+    };
+
+    static constexpr u32 NumShaderCompileWorkers = 2;
+
 private:
     const Instance& instance;
     Scheduler& scheduler;
@@ -130,13 +194,24 @@ private:
     std::array<vk::ShaderModule, MaxShaderStages> modules{};
     std::optional<Shader::Gcn::FetchShaderData> fetch_shader{};
     GraphicsPipelineKey graphics_key{};
+    GraphicsPipelineKey last_graphics_key{};
+    const GraphicsPipeline* last_graphics_pipeline{};
+    bool graphics_stages_reusable{}; // stage lookups of the last key only depend on registers
     ComputePipelineKey compute_key{};
     u32 num_new_pipelines{}; // new pipelines added to the cache since the game start
+    std::vector<PreloadJob> preload_jobs;
+    tsl::robin_map<size_t, std::unique_ptr<PendingProgram>> pending_programs;
+    std::array<Shader::Pools, NumShaderCompileWorkers> compile_pools;
+    std::queue<PendingProgram*> compile_queue;
+    std::mutex compile_mutex;
+    std::condition_variable_any compile_cv;
 
     // Only if Config::collectShadersForDebug()
     tsl::robin_map<vk::ShaderModule,
                    std::vector<std::variant<GraphicsPipelineKey, ComputePipelineKey>>>
         module_related_pipelines;
+
+    std::array<std::jthread, NumShaderCompileWorkers> compile_workers;
 };
 
 } // namespace Vulkan
@@ -11,6 +11,50 @@
 
 namespace Vulkan {
 
+namespace {
+
+/// Copy of push descriptor writes that owns the descriptor infos they point to, so they can be
+/// replayed after the rasterizer has reused its binding storage.
+class PushDescriptorWrites {
+public:
+    explicit PushDescriptorWrites(const Pipeline::DescriptorWrites& set_writes)
+        : writes{set_writes} {
+        for (const auto& write : set_writes) {
+            if (write.pBufferInfo) {
+                buffer_infos.insert(buffer_infos.end(), write.pBufferInfo,
+                                    write.pBufferInfo + write.descriptorCount);
+            } else if (write.pImageInfo) {
+                image_infos.insert(image_infos.end(), write.pImageInfo,
+                                   write.pImageInfo + write.descriptorCount);
+            }
+        }
+    }
+
+    void Push(vk::CommandBuffer cmdbuf, vk::PipelineBindPoint bind_point,
+              vk::PipelineLayout layout) {
+        // Point the writes at the owned infos, which may have moved since construction.
+        size_t buffer_index{};
+        size_t image_index{};
+        for (auto& write : writes) {
+            if (write.pBufferInfo) {
+                write.pBufferInfo = &buffer_infos[buffer_index];
+                buffer_index += write.descriptorCount;
+            } else if (write.pImageInfo) {
+                write.pImageInfo = &image_infos[image_index];
+                image_index += write.descriptorCount;
+            }
+        }
+        cmdbuf.pushDescriptorSetKHR(bind_point, layout, 0, writes);
+    }
+
+private:
+    Pipeline::DescriptorWrites writes;
+    boost::container::small_vector<vk::DescriptorBufferInfo, 16> buffer_infos;
+    boost::container::small_vector<vk::DescriptorImageInfo, 8> image_infos;
+};
+
+} // Anonymous namespace
+
 Pipeline::Pipeline(const Instance& instance_, Scheduler& scheduler_, DescriptorHeap& desc_heap_,
                    const Shader::Profile& profile_, vk::PipelineCache pipeline_cache,
                    bool is_compute_ /*= false*/)
@@ -21,22 +65,25 @@ Pipeline::~Pipeline() = default;
 
 void Pipeline::BindResources(DescriptorWrites& set_writes, const BufferBarriers& buffer_barriers,
                              const Shader::PushData& push_data) const {
-    const auto cmdbuf = scheduler.CommandBuffer();
     const auto bind_point =
         IsCompute() ? vk::PipelineBindPoint::eCompute : vk::PipelineBindPoint::eGraphics;
+    const auto layout = *pipeline_layout;
 
     if (!buffer_barriers.empty()) {
-        const auto dependencies = vk::DependencyInfo{
-            .dependencyFlags = vk::DependencyFlagBits::eByRegion,
-            .bufferMemoryBarrierCount = u32(buffer_barriers.size()),
-            .pBufferMemoryBarriers = buffer_barriers.data(),
-        };
         scheduler.EndRendering();
-        cmdbuf.pipelineBarrier2(dependencies);
+        scheduler.Record([buffer_barriers](vk::CommandBuffer cmdbuf) {
+            cmdbuf.pipelineBarrier2(vk::DependencyInfo{
+                .dependencyFlags = vk::DependencyFlagBits::eByRegion,
+                .bufferMemoryBarrierCount = u32(buffer_barriers.size()),
+                .pBufferMemoryBarriers = buffer_barriers.data(),
+            });
+        });
     }
 
     const auto stage_flags = IsCompute() ? vk::ShaderStageFlagBits::eCompute : AllGraphicsStageBits;
-    cmdbuf.pushConstants(*pipeline_layout, stage_flags, 0u, sizeof(push_data), &push_data);
+    scheduler.Record([layout, stage_flags, push_data](vk::CommandBuffer cmdbuf) {
+        cmdbuf.pushConstants(layout, stage_flags, 0u, sizeof(push_data), &push_data);
+    });
 
     // Bind descriptor set.
     if (set_writes.empty()) {
@@ -44,16 +91,22 @@ void Pipeline::BindResources(DescriptorWrites& set_writes, const BufferBarriers&
     }
 
     if (uses_push_descriptors) {
-        cmdbuf.pushDescriptorSetKHR(bind_point, *pipeline_layout, 0, set_writes);
+        scheduler.Record([writes = PushDescriptorWrites{set_writes}, bind_point,
+                          layout](vk::CommandBuffer cmdbuf) mutable {
+            writes.Push(cmdbuf, bind_point, layout);
+        });
         return;
     }
 
+    // Descriptor set updates are not recorded in the command buffer, only the bind is deferred.
     const auto desc_set = desc_heap.Commit(*desc_layout);
     for (auto& set_write : set_writes) {
         set_write.dstSet = desc_set;
     }
     instance.GetDevice().updateDescriptorSets(set_writes, {});
-    cmdbuf.bindDescriptorSets(bind_point, *pipeline_layout, 0, desc_set, {});
+    scheduler.Record([bind_point, layout, desc_set](vk::CommandBuffer cmdbuf) {
+        cmdbuf.bindDescriptorSets(bind_point, layout, 0, desc_set, {});
+    });
 }
 
 std::string Pipeline::GetDebugString() const {
@@ -1,6 +1,12 @@
 // SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
 #include "common/config.h"
 #include "common/serdes.h"
 #include "shader_recompiler/frontend/fetch_shader.h"
@@ -162,9 +168,13 @@ bool PipelineCache::LoadComputePipeline(Serialization::Archive& ar) {
     const auto [it, is_new] = compute_pipelines.try_emplace(compute_key);
     ASSERT(is_new);
 
-    it.value() =
-        std::make_unique<ComputePipeline>(instance, scheduler, desc_heap, profile, *pipeline_cache,
-                                          compute_key, *infos[0], modules[0], sdata, true);
+    preload_jobs.emplace_back(
+        compute_key, [this, key = compute_key, info = infos[0], module = modules[0],
+                      sdata]() mutable -> std::unique_ptr<Pipeline> {
+            return std::make_unique<ComputePipeline>(instance, scheduler, desc_heap, profile,
+                                                     *pipeline_cache, key, *info, module, sdata,
+                                                     true);
+        });
 
     infos.fill(nullptr);
     modules.fill(nullptr);
@@ -237,9 +247,14 @@ bool PipelineCache::LoadGraphicsPipeline(Serialization::Archive& ar) {
     const auto [it, is_new] = graphics_pipelines.try_emplace(graphics_key);
     ASSERT(is_new);
 
-    it.value() = std::make_unique<GraphicsPipeline>(
-        instance, scheduler, desc_heap, profile, graphics_key, *pipeline_cache, infos,
-        runtime_infos, fetch_shader, modules, sdata, true);
+    preload_jobs.emplace_back(
+        graphics_key, [this, key = graphics_key, infos = infos, runtime_infos = runtime_infos,
+                       fetch_shader = fetch_shader, modules = modules,
+                       sdata]() mutable -> std::unique_ptr<Pipeline> {
+            return std::make_unique<GraphicsPipeline>(instance, scheduler, desc_heap, profile, key,
+                                                      *pipeline_cache, infos, runtime_infos,
+                                                      fetch_shader, modules, sdata, true);
+        });
 
     infos.fill(nullptr);
     modules.fill(nullptr);
@@ -275,7 +290,7 @@ bool PipelineCache::LoadPipelineStage(Serialization::Archive& ar, size_t stage)
         module = CompileSPV(spv, instance.GetDevice());
         it_pgm.value() = std::move(program);
     } else {
-        const auto& it = std::ranges::find(it_pgm.value()->modules, spec, &Program::Module::spec);
+        const auto& it = it_pgm.value()->FindPermut(spec);
         if (it != it_pgm.value()->modules.end()) {
             // If the permutation is already preloaded, make sure it has the same permutation index
             const auto idx = std::distance(it_pgm.value()->modules.begin(), it);
@@ -350,6 +365,8 @@ void PipelineCache::WarmUp() {
             }
         });
 
+    CreatePreloadedPipelines();
+
     LOG_INFO(Render, "Preloaded {} pipelines", num_pipelines);
     if (num_total_pipelines > num_pipelines) {
         LOG_WARNING(Render, "{} stale pipelines were found. Consider re-generating the cache",
@@ -359,6 +376,70 @@ void PipelineCache::WarmUp() {
     Storage::DataBase::Instance().FinishPreload();
 }
 
+void PipelineCache::CreatePreloadedPipelines() {
+    const size_t num_jobs = preload_jobs.size();
+    if (num_jobs == 0) {
+        return;
+    }
+
+    // Pipeline objects are independent of each other and the driver synchronizes accesses to the
+    // shared pipeline cache, so creation can be spread across all host cores.
+    std::vector<std::unique_ptr<Pipeline>> pipelines(num_jobs);
+    std::atomic<size_t> next_job{};
+    std::atomic<size_t> num_done{};
+    std::mutex progress_mutex;
+    std::condition_variable progress_cv;
+
+    const auto worker = [&] {
+        for (size_t i = next_job++; i < num_jobs; i = next_job++) {
+            pipelines[i] = preload_jobs[i].create();
+            if (++num_done == num_jobs) {
+                std::scoped_lock lk{progress_mutex};
+                progress_cv.notify_one();
+            }
+        }
+    };
+
+    const size_t num_workers =
+        std::min<size_t>(std::max(std::thread::hardware_concurrency(), 1u), num_jobs);
+    LOG_INFO(Render, "Creating {} pipelines using {} threads", num_jobs, num_workers);
+
+    const auto start_time = std::chrono::steady_clock::now();
+    {
+        std::vector<std::jthread> workers;
+        workers.reserve(num_workers);
+        for (size_t i = 0; i < num_workers; ++i) {
+            workers.emplace_back(worker);
+        }
+
+        std::unique_lock lk{progress_mutex};
+        while (!progress_cv.wait_for(lk, std::chrono::seconds{1},
+                                     [&] { return num_done == num_jobs; })) {
+            const size_t done = num_done;
+            const auto elapsed = std::chrono::duration<double>(
+                std::chrono::steady_clock::now() - start_time);
+            const double eta = done ? elapsed.count() * (num_jobs - done) / done : 0.0;
+            LOG_INFO(Render, "Pipeline warm-up: {}/{} ({}%), ETA {:.1f}s", done, num_jobs,
+                     done * 100 / num_jobs, eta);
+        }
+    }
+
+    for (size_t i = 0; i < num_jobs; ++i) {
+        if (const auto* key = std::get_if<GraphicsPipelineKey>(&preload_jobs[i].key)) {
+            graphics_pipelines[*key].reset(static_cast<GraphicsPipeline*>(pipelines[i].release()));
+        } else {
+            const auto& compute_key = std::get<ComputePipelineKey>(preload_jobs[i].key);
+            compute_pipelines[compute_key].reset(
+                static_cast<ComputePipeline*>(pipelines[i].release()));
+        }
+    }
+    preload_jobs.clear();
+
+    const auto elapsed =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time);
+    LOG_INFO(Render, "Pipeline warm-up took {:.2f}s", elapsed.count());
+}
+
 void PipelineCache::Sync() {
     Storage::DataBase::Instance().Close();
 }
@@ -474,6 +555,19 @@ bool StageSpecialization::Deserialize(Serialization::Archive& ar) {
     spec.Read(fmasks);
     spec.Read(samplers);
 
+    // Accumulate the hash in the same order as the resources are collected on creation.
+    hash = 0;
+    for (const auto& attrib : vs_attribs) {
+        HashSpec(attrib);
+    }
+    for (const auto& fmask : fmasks) {
+        HashSpec(fmask);
+    }
+    for (const auto& sampler : samplers) {
+        HashSpec(sampler);
+    }
+    HashFixedState();
+
     return true;
 }
 
@@ -12,14 +12,19 @@ namespace Vulkan {
 
 std::mutex Scheduler::submit_mutex;
 
-Scheduler::Scheduler(const Instance& instance)
-    : instance{instance}, master_semaphore{instance}, command_pool{instance, &master_semaphore} {
+Scheduler::Scheduler(const Instance& instance, bool use_worker_)
+    : instance{instance}, master_semaphore{instance}, command_pool{instance, &master_semaphore},
+      use_worker{use_worker_} {
 #if TRACY_GPU_ENABLED
     profiler_scope = reinterpret_cast<tracy::VkCtxScope*>(std::malloc(sizeof(tracy::VkCtxScope)));
 #endif
     AllocateWorkerCommandBuffers();
     priority_pending_ops_thread =
         std::jthread(std::bind_front(&Scheduler::PriorityPendingOpsThread, this));
+    if (use_worker) {
+        AcquireNewChunk();
+        worker_thread = std::jthread(std::bind_front(&Scheduler::WorkerThread, this));
+    }
 }
 
 Scheduler::~Scheduler() {
@@ -36,22 +41,22 @@ void Scheduler::BeginRendering(const RenderState& new_state) {
     is_rendering = true;
     render_state = new_state;
 
-    const vk::RenderingInfo rendering_info = {
-        .renderArea =
-            {
-                .offset = {0, 0},
-                .extent = {render_state.width, render_state.height},
-            },
-        .layerCount = render_state.num_layers,
-        .colorAttachmentCount = render_state.num_color_attachments,
-        .pColorAttachments = render_state.num_color_attachments > 0
-                                 ? render_state.color_attachments.data()
-                                 : nullptr,
-        .pDepthAttachment = render_state.has_depth ? &render_state.depth_attachment : nullptr,
-        .pStencilAttachment = render_state.has_stencil ? &render_state.stencil_attachment : nullptr,
-    };
-
-    current_cmdbuf.beginRendering(rendering_info);
+    Record([state = render_state](vk::CommandBuffer cmdbuf) {
+        const vk::RenderingInfo rendering_info = {
+            .renderArea =
+                {
+                    .offset = {0, 0},
+                    .extent = {state.width, state.height},
+                },
+            .layerCount = state.num_layers,
+            .colorAttachmentCount = state.num_color_attachments,
+            .pColorAttachments =
+                state.num_color_attachments > 0 ? state.color_attachments.data() : nullptr,
+            .pDepthAttachment = state.has_depth ? &state.depth_attachment : nullptr,
+            .pStencilAttachment = state.has_stencil ? &state.stencil_attachment : nullptr,
+        };
+        cmdbuf.beginRendering(rendering_info);
+    });
 }
 
 void Scheduler::EndRendering() {
@@ -59,7 +64,38 @@ void Scheduler::EndRendering() {
         return;
     }
     is_rendering = false;
-    current_cmdbuf.endRendering();
+    Record([](vk::CommandBuffer cmdbuf) { cmdbuf.endRendering(); });
+}
+
+void Scheduler::DispatchWork() {
+    if (!use_worker || chunk->Empty()) {
+        return;
+    }
+    {
+        std::scoped_lock lk{work_mutex};
+        work_queue.push(std::move(chunk));
+    }
+    work_cv.notify_one();
+    AcquireNewChunk();
+}
+
+void Scheduler::WaitWorker() {
+    if (!use_worker) {
+        return;
+    }
+    DispatchWork();
+    std::unique_lock lk{work_mutex};
+    idle_cv.wait(lk, [this] { return work_queue.empty() && !worker_busy; });
+}
+
+void Scheduler::AcquireNewChunk() {
+    std::scoped_lock lk{reserve_mutex};
+    if (chunk_reserve.empty()) {
+        chunk = std::make_unique<CommandChunk>();
+        return;
+    }
+    chunk = std::move(chunk_reserve.back());
+    chunk_reserve.pop_back();
 }
 
 void Scheduler::Flush(SubmitInfo& info) {
@@ -119,6 +155,10 @@ void Scheduler::AllocateWorkerCommandBuffers() {
 }
 
 void Scheduler::SubmitExecution(SubmitInfo& info) {
+    // The command buffer must contain all recorded commands before it is ended.
+    EndRendering();
+    WaitWorker();
+
     std::scoped_lock lk{submit_mutex};
     const u64 signal_value = master_semaphore.NextTick();
 
@@ -130,7 +170,6 @@ void Scheduler::SubmitExecution(SubmitInfo& info) {
     }
 #endif
 
-    EndRendering();
     Check(current_cmdbuf.end());
 
     const vk::Semaphore timeline = master_semaphore.Handle();
@@ -196,159 +235,224 @@ void Scheduler::PriorityPendingOpsThread(std::stop_token stoken) {
     }
 }
 
-void DynamicState::Commit(const Instance& instance, const vk::CommandBuffer& cmdbuf) {
-    if (dirty_state.viewports) {
-        dirty_state.viewports = false;
+void Scheduler::WorkerThread(std::stop_token stoken) {
+    Common::SetCurrentThreadName("shadPS4:GpuSchedWorker");
+
+    while (!stoken.stop_requested()) {
+        std::unique_ptr<CommandChunk> work;
+        {
+            std::unique_lock lk{work_mutex};
+            work_cv.wait(lk, stoken, [this] { return !work_queue.empty(); });
+            if (stoken.stop_requested()) {
+                break;
+            }
+            work = std::move(work_queue.front());
+            work_queue.pop();
+            worker_busy = true;
+        }
+
+        // The command buffer is only replaced after the worker has gone idle, see WaitWorker.
+        work->ExecuteAll(current_cmdbuf);
+        {
+            std::scoped_lock lk{reserve_mutex};
+            chunk_reserve.emplace_back(std::move(work));
+        }
+        {
+            std::scoped_lock lk{work_mutex};
+            worker_busy = false;
+        }
+        idle_cv.notify_all();
+    }
+}
+
+Scheduler::CommandChunk::~CommandChunk() {
+    for (Command* command = first; command != nullptr;) {
+        Command* const next = command->GetNext();
+        command->~Command();
+        command = next;
+    }
+}
+
+void Scheduler::CommandChunk::ExecuteAll(vk::CommandBuffer cmdbuf) {
+    for (Command* command = first; command != nullptr;) {
+        Command* const next = command->GetNext();
+        command->Execute(cmdbuf);
+        command->~Command();
+        command = next;
+    }
+    first = nullptr;
+    last = nullptr;
+    command_offset = 0;
+}
+
+void DynamicState::Commit(const Instance& instance, Scheduler& scheduler) {
+    const DirtyState dirty = TakeDirtyState(instance);
+    scheduler.Record([&instance, state = *this, dirty](vk::CommandBuffer cmdbuf) {
+        state.Apply(instance, dirty, cmdbuf);
+    });
+}
+
+DynamicState::DirtyState DynamicState::TakeDirtyState(const Instance& instance) {
+    DirtyState taken = dirty_state;
+    dirty_state = {};
+    // State that is ignored while its test is disabled stays dirty until the test is enabled.
+    if (!depth_test_enabled) {
+        dirty_state.depth_compare_op = taken.depth_compare_op;
+        taken.depth_compare_op = false;
+    }
+    if (!depth_bounds_test_enabled) {
+        dirty_state.depth_bounds = taken.depth_bounds;
+        taken.depth_bounds = false;
+    }
+    if (!depth_bias_enabled) {
+        dirty_state.depth_bias = taken.depth_bias;
+        taken.depth_bias = false;
+    }
+    if (!stencil_test_enabled) {
+        dirty_state.stencil_front_ops = taken.stencil_front_ops;
+        dirty_state.stencil_front_reference = taken.stencil_front_reference;
+        dirty_state.stencil_front_write_mask = taken.stencil_front_write_mask;
+        dirty_state.stencil_front_compare_mask = taken.stencil_front_compare_mask;
+        dirty_state.stencil_back_ops = taken.stencil_back_ops;
+        dirty_state.stencil_back_reference = taken.stencil_back_reference;
+        dirty_state.stencil_back_write_mask = taken.stencil_back_write_mask;
+        dirty_state.stencil_back_compare_mask = taken.stencil_back_compare_mask;
+        taken.stencil_front_ops = false;
+        taken.stencil_front_reference = false;
+        taken.stencil_front_write_mask = false;
+        taken.stencil_front_compare_mask = false;
+        taken.stencil_back_ops = false;
+        taken.stencil_back_reference = false;
+        taken.stencil_back_write_mask = false;
+        taken.stencil_back_compare_mask = false;
+    }
+    if (!instance.IsAttachmentFeedbackLoopLayoutSupported()) {
+        dirty_state.feedback_loop_enabled = taken.feedback_loop_enabled;
+        taken.feedback_loop_enabled = false;
+    }
+    return taken;
+}
+
+void DynamicState::Apply(const Instance& instance, const DirtyState& dirty,
+                         const vk::CommandBuffer& cmdbuf) const {
+    if (dirty.viewports) {
         cmdbuf.setViewportWithCount(viewports);
     }
-    if (dirty_state.scissors) {
-        dirty_state.scissors = false;
+    if (dirty.scissors) {
         cmdbuf.setScissorWithCount(scissors);
     }
-    if (dirty_state.depth_test_enabled) {
-        dirty_state.depth_test_enabled = false;
+    if (dirty.depth_test_enabled) {
         cmdbuf.setDepthTestEnable(depth_test_enabled);
     }
-    if (dirty_state.depth_write_enabled) {
-        dirty_state.depth_write_enabled = false;
+    if (dirty.depth_write_enabled) {
         // Note that this must be set in a command buffer even if depth test is disabled.
         cmdbuf.setDepthWriteEnable(depth_write_enabled);
     }
-    if (depth_test_enabled && dirty_state.depth_compare_op) {
-        dirty_state.depth_compare_op = false;
+    if (depth_test_enabled && dirty.depth_compare_op) {
         cmdbuf.setDepthCompareOp(depth_compare_op);
     }
-    if (dirty_state.depth_bounds_test_enabled) {
-        dirty_state.depth_bounds_test_enabled = false;
+    if (dirty.depth_bounds_test_enabled) {
         if (instance.IsDepthBoundsSupported()) {
             cmdbuf.setDepthBoundsTestEnable(depth_bounds_test_enabled);
         }
     }
-    if (depth_bounds_test_enabled && dirty_state.depth_bounds) {
-        dirty_state.depth_bounds = false;
+    if (depth_bounds_test_enabled && dirty.depth_bounds) {
         if (instance.IsDepthBoundsSupported()) {
             cmdbuf.setDepthBounds(depth_bounds_min, depth_bounds_max);
         }
     }
-    if (dirty_state.depth_bias_enabled) {
-        dirty_state.depth_bias_enabled = false;
+    if (dirty.depth_bias_enabled) {
         cmdbuf.setDepthBiasEnable(depth_bias_enabled);
     }
-    if (depth_bias_enabled && dirty_state.depth_bias) {
-        dirty_state.depth_bias = false;
+    if (depth_bias_enabled && dirty.depth_bias) {
         cmdbuf.setDepthBias(depth_bias_constant, depth_bias_clamp, depth_bias_slope);
     }
-    if (dirty_state.stencil_test_enabled) {
-        dirty_state.stencil_test_enabled = false;
+    if (dirty.stencil_test_enabled) {
         cmdbuf.setStencilTestEnable(stencil_test_enabled);
     }
     if (stencil_test_enabled) {
-        if (dirty_state.stencil_front_ops && dirty_state.stencil_back_ops &&
+        if (dirty.stencil_front_ops && dirty.stencil_back_ops &&
             stencil_front_ops == stencil_back_ops) {
-            dirty_state.stencil_front_ops = false;
-            dirty_state.stencil_back_ops = false;
             cmdbuf.setStencilOp(vk::StencilFaceFlagBits::eFrontAndBack, stencil_front_ops.fail_op,
                                 stencil_front_ops.pass_op, stencil_front_ops.depth_fail_op,
                                 stencil_front_ops.compare_op);
         } else {
-            if (dirty_state.stencil_front_ops) {
-                dirty_state.stencil_front_ops = false;
+            if (dirty.stencil_front_ops) {
                 cmdbuf.setStencilOp(vk::StencilFaceFlagBits::eFront, stencil_front_ops.fail_op,
                                     stencil_front_ops.pass_op, stencil_front_ops.depth_fail_op,
                                     stencil_front_ops.compare_op);
             }
-            if (dirty_state.stencil_back_ops) {
-                dirty_state.stencil_back_ops = false;
+            if (dirty.stencil_back_ops) {
                 cmdbuf.setStencilOp(vk::StencilFaceFlagBits::eBack, stencil_back_ops.fail_op,
                                     stencil_back_ops.pass_op, stencil_back_ops.depth_fail_op,
                                     stencil_back_ops.compare_op);
             }
         }
-        if (dirty_state.stencil_front_reference && dirty_state.stencil_back_reference &&
+        if (dirty.stencil_front_reference && dirty.stencil_back_reference &&
             stencil_front_reference == stencil_back_reference) {
-            dirty_state.stencil_front_reference = false;
-            dirty_state.stencil_back_reference = false;
             cmdbuf.setStencilReference(vk::StencilFaceFlagBits::eFrontAndBack,
                                        stencil_front_reference);
         } else {
-            if (dirty_state.stencil_front_reference) {
-                dirty_state.stencil_front_reference = false;
+            if (dirty.stencil_front_reference) {
                 cmdbuf.setStencilReference(vk::StencilFaceFlagBits::eFront,
                                            stencil_front_reference);
             }
-            if (dirty_state.stencil_back_reference) {
-                dirty_state.stencil_back_reference = false;
+            if (dirty.stencil_back_reference) {
                 cmdbuf.setStencilReference(vk::StencilFaceFlagBits::eBack, stencil_back_reference);
             }
         }
-        if (dirty_state.stencil_front_write_mask && dirty_state.stencil_back_write_mask &&
+        if (dirty.stencil_front_write_mask && dirty.stencil_back_write_mask &&
             stencil_front_write_mask == stencil_back_write_mask) {
-            dirty_state.stencil_front_write_mask = false;
-            dirty_state.stencil_back_write_mask = false;
             cmdbuf.setStencilWriteMask(vk::StencilFaceFlagBits::eFrontAndBack,
                                        stencil_front_write_mask);
         } else {
-            if (dirty_state.stencil_front_write_mask) {
-                dirty_state.stencil_front_write_mask = false;
+            if (dirty.stencil_front_write_mask) {
                 cmdbuf.setStencilWriteMask(vk::StencilFaceFlagBits::eFront,
                                            stencil_front_write_mask);
             }
-            if (dirty_state.stencil_back_write_mask) {
-                dirty_state.stencil_back_write_mask = false;
+            if (dirty.stencil_back_write_mask) {
                 cmdbuf.setStencilWriteMask(vk::StencilFaceFlagBits::eBack, stencil_back_write_mask);
             }
         }
-        if (dirty_state.stencil_front_compare_mask && dirty_state.stencil_back_compare_mask &&
+        if (dirty.stencil_front_compare_mask && dirty.stencil_back_compare_mask &&
             stencil_front_compare_mask == stencil_back_compare_mask) {
-            dirty_state.stencil_front_compare_mask = false;
-            dirty_state.stencil_back_compare_mask = false;
             cmdbuf.setStencilCompareMask(vk::StencilFaceFlagBits::eFrontAndBack,
                                          stencil_front_compare_mask);
         } else {
-            if (dirty_state.stencil_front_compare_mask) {
-                dirty_state.stencil_front_compare_mask = false;
+            if (dirty.stencil_front_compare_mask) {
                 cmdbuf.setStencilCompareMask(vk::StencilFaceFlagBits::eFront,
                                              stencil_front_compare_mask);
             }
-            if (dirty_state.stencil_back_compare_mask) {
-                dirty_state.stencil_back_compare_mask = false;
+            if (dirty.stencil_back_compare_mask) {
                 cmdbuf.setStencilCompareMask(vk::StencilFaceFlagBits::eBack,
                                              stencil_back_compare_mask);
             }
         }
     }
-    if (dirty_state.primitive_restart_enable) {
-        dirty_state.primitive_restart_enable = false;
+    if (dirty.primitive_restart_enable) {
         cmdbuf.setPrimitiveRestartEnable(primitive_restart_enable);
     }
-    if (dirty_state.rasterizer_discard_enable) {
-        dirty_state.rasterizer_discard_enable = false;
+    if (dirty.rasterizer_discard_enable) {
         cmdbuf.setRasterizerDiscardEnable(rasterizer_discard_enable);
     }
-    if (dirty_state.cull_mode) {
-        dirty_state.cull_mode = false;
+    if (dirty.cull_mode) {
         cmdbuf.setCullMode(cull_mode);
     }
-    if (dirty_state.front_face) {
-        dirty_state.front_face = false;
+    if (dirty.front_face) {
         cmdbuf.setFrontFace(front_face);
     }
-    if (dirty_state.blend_constants) {
-        dirty_state.blend_constants = false;
+    if (dirty.blend_constants) {
         cmdbuf.setBlendConstants(blend_constants.data());
     }
-    if (dirty_state.color_write_masks) {
-        dirty_state.color_write_masks = false;
+    if (dirty.color_write_masks) {
         if (instance.IsDynamicColorWriteMaskSupported()) {
             cmdbuf.setColorWriteMaskEXT(0, color_write_masks);
         }
     }
-    if (dirty_state.line_width) {
-        dirty_state.line_width = false;
+    if (dirty.line_width) {
         cmdbuf.setLineWidth(line_width);
     }
-    if (dirty_state.feedback_loop_enabled && instance.IsAttachmentFeedbackLoopLayoutSupported()) {
-        dirty_state.feedback_loop_enabled = false;
+    if (dirty.feedback_loop_enabled && instance.IsAttachmentFeedbackLoopLayoutSupported()) {
         cmdbuf.setAttachmentFeedbackLoopEnableEXT(feedback_loop_enabled
                                                       ? vk::ImageAspectFlagBits::eColor
                                                       : vk::ImageAspectFlagBits::eNone);
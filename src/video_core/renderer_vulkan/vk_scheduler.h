@@ -4,10 +4,15 @@
 #pragma once
 
 #include <condition_variable>
+#include <cstddef>
+#include <memory>
 #include <mutex>
 #include <thread>
 #include <queue>
+#include <vector>
 
+#include "common/alignment.h"
+#include "common/assert.h"
 #include "common/unique_function.h"
 #include "video_core/amdgpu/regs_color.h"
 #include "video_core/amdgpu/regs_primitive.h"
@@ -21,6 +26,7 @@ class VkCtxScope;
 namespace Vulkan {
 
 class Instance;
+class Scheduler;
 
 struct RenderState {
     std::array<vk::RenderingAttachmentInfo, 8> color_attachments;
@@ -85,7 +91,7 @@ struct StencilOps {
     }
 };
 struct DynamicState {
-    struct {
+    struct DirtyState {
         bool viewports : 1;
         bool scissors : 1;
 
@@ -157,7 +163,20 @@ struct DynamicState {
     bool feedback_loop_enabled{};
 
     /// Commits the dynamic state to the provided command buffer.
-    void Commit(const Instance& instance, const vk::CommandBuffer& cmdbuf);
+    void Commit(const Instance& instance, const vk::CommandBuffer& cmdbuf) {
+        Apply(instance, TakeDirtyState(instance), cmdbuf);
+    }
+
+    /// Records a snapshot of the dirty dynamic state into the scheduler.
+    void Commit(const Instance& instance, Scheduler& scheduler);
+
+    /// Clears and returns the dirty state that can be applied with the current values.
+    /// State that only matters once its test is enabled stays dirty until then.
+    DirtyState TakeDirtyState(const Instance& instance);
+
+    /// Sets the given dirty state on the command buffer.
+    void Apply(const Instance& instance, const DirtyState& dirty,
+               const vk::CommandBuffer& cmdbuf) const;
 
     /// Invalidates all dynamic state to be flushed into the next command buffer.
     void Invalidate() {
@@ -341,7 +360,9 @@ struct DynamicState {
 
 class Scheduler {
 public:
-    explicit Scheduler(const Instance& instance);
+    /// When use_worker is set, recorded commands are replayed by a worker thread. Otherwise they
+    /// are written to the command buffer right away.
+    explicit Scheduler(const Instance& instance, bool use_worker = false);
     ~Scheduler();
 
     /// Sends the current execution context to the GPU
@@ -377,11 +398,35 @@ public:
         return dynamic_state;
     }
 
-    /// Returns the current command buffer.
-    vk::CommandBuffer CommandBuffer() const {
+    /// Returns the current command buffer. Waits for the worker to replay the recorded commands
+    /// first, so commands written to it directly are ordered after them. Commands recorded after
+    /// this call are replayed after the direct ones, so per draw work should use Record instead.
+    vk::CommandBuffer CommandBuffer() {
+        WaitWorker();
         return current_cmdbuf;
     }
 
+    /// Records a command that the worker thread replays into the current command buffer.
+    template <typename T>
+    void Record(T&& command) {
+        if (!use_worker) {
+            command(current_cmdbuf);
+            return;
+        }
+        if (chunk->Record(command)) {
+            return;
+        }
+        DispatchWork();
+        const bool recorded = chunk->Record(command);
+        ASSERT(recorded);
+    }
+
+    /// Sends the recorded commands to the worker thread.
+    void DispatchWork();
+
+    /// Waits for the worker thread to replay all recorded commands.
+    void WaitWorker();
+
     /// Returns the current command buffer tick.
     [[nodiscard]] u64 CurrentTick() const noexcept {
         return master_semaphore.CurrentTick();
@@ -420,12 +465,93 @@ public:
     static std::mutex submit_mutex;
 
 private:
+    class Command {
+    public:
+        virtual ~Command() = default;
+
+        virtual void Execute(vk::CommandBuffer cmdbuf) = 0;
+
+        Command* GetNext() const {
+            return next;
+        }
+
+        void SetNext(Command* next_) {
+            next = next_;
+        }
+
+    private:
+        Command* next = nullptr;
+    };
+
+    template <typename T>
+    class TypedCommand final : public Command {
+    public:
+        explicit TypedCommand(T&& command_) : command{std::move(command_)} {}
+        ~TypedCommand() override = default;
+
+        TypedCommand(TypedCommand&&) = delete;
+        TypedCommand& operator=(TypedCommand&&) = delete;
+
+        void Execute(vk::CommandBuffer cmdbuf) override {
+            command(cmdbuf);
+        }
+
+    private:
+        T command;
+    };
+
+    /// Fixed size block of recorded commands, stored inline as a linked list.
+    class CommandChunk final {
+    public:
+        ~CommandChunk();
+
+        /// Moves the command into the chunk, returns false if there is no space left for it.
+        template <typename T>
+        bool Record(T& command) {
+            using FuncType = TypedCommand<std::decay_t<T>>;
+            static_assert(sizeof(FuncType) < ChunkSize, "Command is too large");
+
+            const size_t offset = Common::AlignUp(command_offset, alignof(FuncType));
+            if (offset + sizeof(FuncType) > ChunkSize) {
+                return false;
+            }
+            Command* const current_last = last;
+            last = new (data.data() + offset) FuncType(std::move(command));
+            if (current_last) {
+                current_last->SetNext(last);
+            } else {
+                first = last;
+            }
+            command_offset = offset + sizeof(FuncType);
+            return true;
+        }
+
+        /// Replays the commands into the command buffer and resets the chunk.
+        void ExecuteAll(vk::CommandBuffer cmdbuf);
+
+        [[nodiscard]] bool Empty() const {
+            return first == nullptr;
+        }
+
+    private:
+        static constexpr size_t ChunkSize = 0x10000;
+
+        Command* first{};
+        Command* last{};
+        size_t command_offset{};
+        alignas(std::max_align_t) std::array<u8, ChunkSize> data{};
+    };
+
     void AllocateWorkerCommandBuffers();
 
     void SubmitExecution(SubmitInfo& info);
 
     void PriorityPendingOpsThread(std::stop_token stoken);
 
+    void AcquireNewChunk();
+
+    void WorkerThread(std::stop_token stoken);
+
 private:
     const Instance& instance;
     MasterSemaphore master_semaphore;
@@ -445,6 +571,16 @@ private:
     RenderState render_state;
     bool is_rendering = false;
     tracy::VkCtxScope* profiler_scope{};
+    std::unique_ptr<CommandChunk> chunk;
+    std::vector<std::unique_ptr<CommandChunk>> chunk_reserve;
+    std::mutex reserve_mutex;
+    std::queue<std::unique_ptr<CommandChunk>> work_queue;
+    std::mutex work_mutex;
+    std::condition_variable_any work_cv;
+    std::condition_variable idle_cv;
+    bool worker_busy{};
+    bool use_worker{};
+    std::jthread worker_thread;
 };
 
 } // namespace Vulkan
@@ -0,0 +1,415 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+
+#include "common/assert.h"
+#include "common/logging/log.h"
+#include "video_core/amdgpu/tiling.h"
+#include "video_core/texture_cache/cpu_tiler.h"
+#include "video_core/texture_cache/image_info.h"
+
+namespace VideoCore {
+
+namespace {
+
+constexpr u32 MicroTileWidth = 8;
+constexpr u32 MicroTileHeight = 8;
+constexpr u32 NumPipeInterleaveBits = 8;
+
+constexpr u32 Bit(u32 value, u32 bit) {
+    return (value >> bit) & 1U;
+}
+
+u32 ComputePixelIndexWithinMicroTile(AmdGpu::MicroTileMode micro_tile_mode, u32 num_bits,
+                                     u32 thickness, u32 x, u32 y, u32 z) {
+    const u32 x0 = Bit(x, 0);
+    const u32 x1 = Bit(x, 1);
+    const u32 x2 = Bit(x, 2);
+    const u32 y0 = Bit(y, 0);
+    const u32 y1 = Bit(y, 1);
+    const u32 y2 = Bit(y, 2);
+    const u32 z0 = Bit(z, 0);
+    const u32 z1 = Bit(z, 1);
+    const u32 z2 = Bit(z, 2);
+
+    std::array<u32, 9> p{};
+    switch (micro_tile_mode) {
+    case AmdGpu::MicroTileMode::Display:
+        switch (num_bits) {
+        case 8:
+            p = {x0, x1, x2, y1, y0, y2};
+            break;
+        case 16:
+            p = {x0, x1, x2, y0, y1, y2};
+            break;
+        case 32:
+            p = {x0, x1, y0, x2, y1, y2};
+            break;
+        case 64:
+            p = {x0, y0, x1, x2, y1, y2};
+            break;
+        case 128:
+            p = {y0, x0, x1, x2, y1, y2};
+            break;
+        default:
+            break;
+        }
+        break;
+    case AmdGpu::MicroTileMode::Thin:
+    case AmdGpu::MicroTileMode::Depth:
+        p = {x0, y0, x1, y1, x2, y2};
+        break;
+    default:
+        if (num_bits == 8 || num_bits == 16) {
+            p = {x0, y0, x1, y1, z0, z1};
+        } else if (num_bits == 32) {
+            p = {x0, y0, x1, z0, y1, z1};
+        } else {
+            p = {x0, y0, z0, x1, y1, z1};
+        }
+        p[6] = x2;
+        p[7] = y2;
+        p[8] = thickness == 8 ? z2 : 0;
+        break;
+    }
+
+    u32 pixel_number = 0;
+    for (u32 i = 0; i < p.size(); ++i) {
+        pixel_number |= p[i] << i;
+    }
+    return pixel_number;
+}
+
+/// Computes byte offsets of texels in the tiled representation of an image.
+class SurfaceAddress {
+public:
+    explicit SurfaceAddress(const ImageInfo& info)
+        : array_mode{info.array_mode}, bank_swizzle{info.bank_swizzle},
+          thickness{AmdGpu::GetMicroTileThickness(info.array_mode)} {
+        const auto micro_tile_mode = AmdGpu::GetMicroTileMode(info.tile_mode);
+        const u32 bits_per_element = micro_tile_mode == AmdGpu::MicroTileMode::Depth
+                                         ? info.num_bits * info.num_samples
+                                         : info.num_bits;
+        for (u32 z = 0; z < 8; ++z) {
+            for (u32 y = 0; y < MicroTileHeight; ++y) {
+                for (u32 x = 0; x < MicroTileWidth; ++x) {
+                    const u32 pixel_index = ComputePixelIndexWithinMicroTile(
+                        micro_tile_mode, info.num_bits, thickness, x, y, z);
+                    element_offsets[(z << 6) | (y << 3) | x] = pixel_index * bits_per_element / 8;
+                }
+            }
+        }
+
+        slice_bits = thickness * info.num_bits * info.num_samples;
+        micro_tile_bytes = MicroTileWidth * MicroTileHeight * slice_bits / 8;
+        is_macro_tiled = AmdGpu::IsMacroTiled(array_mode);
+        if (!is_macro_tiled) {
+            return;
+        }
+
+        const auto macro_tile_mode =
+            AmdGpu::CalculateMacrotileMode(info.tile_mode, info.num_bits, info.num_samples);
+        pipe_config = AmdGpu::GetPipeConfig(info.tile_mode);
+        num_pipes = pipe_config == AmdGpu::PipeConfig::P2 ? 2 : 8;
+        num_pipe_bits = std::bit_width(num_pipes) - 1;
+        bank_width = AmdGpu::GetBankWidth(macro_tile_mode);
+        bank_height = AmdGpu::GetBankHeight(macro_tile_mode);
+        num_banks = AmdGpu::GetNumBanks(macro_tile_mode);
+        num_bank_bits = std::bit_width(num_banks) - 1;
+        tile_split_bytes = AmdGpu::CalculateTileSplit(info.tile_mode, info.array_mode,
+                                                      micro_tile_mode, info.num_bits);
+        if (micro_tile_bytes > tile_split_bytes && thickness == 1) {
+            slices_per_tile = micro_tile_bytes / tile_split_bytes;
+            micro_tile_bytes = tile_split_bytes;
+        } else {
+            tile_split_bytes = 0;
+        }
+
+        const u32 macro_tile_aspect = AmdGpu::GetMacrotileAspect(macro_tile_mode);
+        macro_tile_pitch = (MicroTileWidth * bank_width * num_pipes) * macro_tile_aspect;
+        macro_tile_height = (MicroTileHeight * bank_height * num_banks) / macro_tile_aspect;
+        macro_tile_bytes = micro_tile_bytes * (macro_tile_pitch / MicroTileWidth) *
+                           (macro_tile_height / MicroTileHeight) / (num_pipes * num_banks);
+
+        using enum AmdGpu::ArrayMode;
+        const bool is_2d = array_mode == Array2DTiledThin1 || array_mode == Array2DTiledThick ||
+                           array_mode == Array2DTiledXThick;
+        is_3d = array_mode == Array3DTiledThin1 || array_mode == Array3DTiledThick ||
+                array_mode == Array3DTiledXThick;
+        slice_rotation_scale = is_2d   ? num_banks / 2 - 1
+                               : is_3d ? std::max(1U, num_pipes / 2 - 1)
+                                       : 0;
+        has_tile_split_rotation = array_mode == Array2DTiledThin1 ||
+                                  array_mode == Array3DTiledThin1 ||
+                                  array_mode == ArrayPrt2DTiledThin1 ||
+                                  array_mode == ArrayPrt3DTiledThin1;
+        is_prt = AmdGpu::IsPrt(array_mode);
+    }
+
+    [[nodiscard]] u32 Compute(u32 x, u32 y, u32 slice, u32 pitch, u32 height) const {
+        return is_macro_tiled ? ComputeMacroTiled(x, y, slice, pitch, height)
+                              : ComputeMicroTiled(x, y, slice, pitch, height);
+    }
+
+private:
+    [[nodiscard]] u32 ElementOffset(u32 x, u32 y, u32 z) const {
+        return element_offsets[((z & 7) << 6) | ((y & 7) << 3) | (x & 7)];
+    }
+
+    [[nodiscard]] u32 ComputeMicroTiled(u32 x, u32 y, u32 slice, u32 pitch, u32 height) const {
+        const u32 slice_bytes = (pitch * height * slice_bits + 7) / 8;
+        const u32 micro_tiles_per_row = pitch / MicroTileWidth;
+        const u32 slice_offset = (slice / thickness) * slice_bytes;
+        const u32 micro_tile_offset =
+            ((y / MicroTileHeight) * micro_tiles_per_row + x / MicroTileWidth) * micro_tile_bytes;
+        return slice_offset + micro_tile_offset + ElementOffset(x, y, slice);
+    }
+
+    [[nodiscard]] u32 ComputePipe(u32 x, u32 y, u32 slice) const {
+        const u32 tx = x / MicroTileWidth;
+        const u32 ty = y / MicroTileHeight;
+        const u32 x3 = Bit(tx, 0);
+        const u32 x4 = Bit(tx, 1);
+        const u32 x5 = Bit(tx, 2);
+        const u32 y3 = Bit(ty, 0);
+        const u32 y4 = Bit(ty, 1);
+        const u32 y5 = Bit(ty, 2);
+
+        u32 pipe = 0;
+        switch (pipe_config) {
+        case AmdGpu::PipeConfig::P2:
+            pipe = x3 ^ y3;
+            break;
+        case AmdGpu::PipeConfig::P8_32x32_8x16:
+            pipe = (x4 ^ y3 ^ x5) | ((x3 ^ y4) << 1) | ((x5 ^ y5) << 2);
+            break;
+        case AmdGpu::PipeConfig::P8_32x32_16x16:
+            pipe = (x3 ^ y3 ^ x4) | ((x4 ^ y4) << 1) | ((x5 ^ y5) << 2);
+            break;
+        default:
+            break;
+        }
+
+        u32 pipe_swizzle = 0;
+        if (is_3d) {
+            pipe_swizzle = std::max(1U, num_pipes / 2 - 1) * (slice / thickness);
+        }
+        return pipe ^ (pipe_swizzle & (num_pipes - 1));
+    }
+
+    [[nodiscard]] u32 ComputeBank(u32 x, u32 y, u32 slice, u32 tile_split_slice) const {
+        const u32 tx = x / MicroTileWidth / (bank_width * num_pipes);
+        const u32 ty = y / MicroTileHeight / bank_height;
+        const u32 x3 = Bit(tx, 0);
+        const u32 x4 = Bit(tx, 1);
+        const u32 x5 = Bit(tx, 2);
+        const u32 x6 = Bit(tx, 3);
+        const u32 y3 = Bit(ty, 0);
+        const u32 y4 = Bit(ty, 1);
+        const u32 y5 = Bit(ty, 2);
+        const u32 y6 = Bit(ty, 3);
+
+        u32 bank = 0;
+        switch (num_banks) {
+        case 16:
+            bank = (x3 ^ y6) | ((x4 ^ y5 ^ y6) << 1) | ((x5 ^ y4) << 2) | ((x6 ^ y3) << 3);
+            break;
+        case 8:
+            bank = (x3 ^ y5) | ((x4 ^ y4 ^ y5) << 1) | ((x5 ^ y3) << 2);
+            break;
+        case 4:
+            bank = (x3 ^ y4) | ((x4 ^ y3) << 1);
+            break;
+        case 2:
+            bank = x3 ^ y3;
+            break;
+        default:
+            break;
+        }
+
+        u32 slice_rotation = slice_rotation_scale * (slice / thickness);
+        if (is_3d) {
+            slice_rotation /= num_pipes;
+        }
+        const u32 tile_split_rotation =
+            has_tile_split_rotation ? (num_banks / 2 + 1) * tile_split_slice : 0;
+
+        bank ^= bank_swizzle + slice_rotation;
+        bank ^= tile_split_rotation;
+        return bank & (num_banks - 1);
+    }
+
+    [[nodiscard]] u32 ComputeMacroTiled(u32 x, u32 y, u32 slice, u32 pitch, u32 height) const {
+        u32 element_offset = ElementOffset(x, y, slice);
+        u32 tile_split_slice = 0;
+        if (tile_split_bytes != 0) {
+            tile_split_slice = element_offset / tile_split_bytes;
+            element_offset %= tile_split_bytes;
+        }
+
+        const u32 macro_tiles_per_row = pitch / macro_tile_pitch;
+        const u32 macro_tile_index_x = x / macro_tile_pitch;
+        const u32 macro_tile_index_y = y / macro_tile_height;
+        const u32 macro_tile_offset =
+            (macro_tile_index_y * macro_tiles_per_row + macro_tile_index_x) * macro_tile_bytes;
+        const u32 macro_tiles_per_slice = macro_tiles_per_row * (height / macro_tile_height);
+
+        const u32 slice_bytes = macro_tiles_per_slice * macro_tile_bytes;
+        const u32 slice_offset =
+            slice_bytes * (tile_split_slice + slices_per_tile * (slice / thickness));
+
+        const u32 tile_row_index = (y / MicroTileHeight) % bank_height;
+        const u32 tile_column_index = ((x / MicroTileWidth) / num_pipes) % bank_width;
+        const u32 tile_index = tile_row_index * bank_width + tile_column_index;
+        const u32 tile_offset = tile_index * micro_tile_bytes;
+
+        const u32 total_offset = slice_offset + macro_tile_offset + element_offset + tile_offset;
+
+        if (is_prt) {
+            x %= macro_tile_pitch;
+            y %= macro_tile_height;
+        }
+
+        const u32 pipe = ComputePipe(x, y, slice);
+        const u32 bank = ComputeBank(x, y, slice, tile_split_slice);
+
+        const u32 pipe_interleave_mask = (1U << NumPipeInterleaveBits) - 1;
+        const u32 offset = total_offset >> NumPipeInterleaveBits;
+        return (total_offset & pipe_interleave_mask) | (pipe << NumPipeInterleaveBits) |
+               (bank << (NumPipeInterleaveBits + num_pipe_bits)) |
+               (offset << (NumPipeInterleaveBits + num_pipe_bits + num_bank_bits));
+    }
+
+private:
+    std::array<u32, 8 * MicroTileWidth * MicroTileHeight> element_offsets{};
+    AmdGpu::ArrayMode array_mode;
+    AmdGpu::PipeConfig pipe_config{};
+    u32 bank_swizzle;
+    u32 thickness;
+    u32 slice_bits{};
+    u32 micro_tile_bytes{};
+    u32 num_pipes{};
+    u32 num_pipe_bits{};
+    u32 bank_width{};
+    u32 bank_height{};
+    u32 num_banks{};
+    u32 num_bank_bits{};
+    u32 tile_split_bytes{};
+    u32 slices_per_tile{1};
+    u32 macro_tile_pitch{};
+    u32 macro_tile_height{};
+    u32 macro_tile_bytes{};
+    u32 slice_rotation_scale{};
+    bool is_macro_tiled{};
+    bool is_3d{};
+    bool is_prt{};
+    bool has_tile_split_rotation{};
+};
+
+/// Calls func with the linear and tiled byte offsets of every texel of the image.
+template <typename Func>
+void ForEachTexel(const ImageInfo& info, size_t tiled_size, size_t linear_size, Func&& func) {
+    const SurfaceAddress address{info};
+    const u32 bytes_per_pixel = info.num_bits / 8;
+    u32 linear_offset = 0;
+    for (u32 m = 0; m < info.resources.levels; ++m) {
+        auto [mip_size, mip_pitch, mip_height, mip_offset] = info.mips_layout[m];
+        if (info.props.is_block) {
+            mip_pitch = std::max((mip_pitch + 3) / 4, 1U);
+            mip_height = std::max((mip_height + 3) / 4, 1U);
+        }
+        const u32 num_texels = mip_size / bytes_per_pixel;
+        if (linear_offset + num_texels * bytes_per_pixel > linear_size) {
+            LOG_ERROR(Render, "Linear buffer of size {:#x} is too small for mip {}", linear_size,
+                      m);
+            return;
+        }
+        if (mip_pitch == 0 || mip_height == 0) {
+            linear_offset += num_texels * bytes_per_pixel;
+            continue;
+        }
+
+        u32 x = 0;
+        u32 y = 0;
+        u32 slice = 0;
+        for (u32 texel = 0; texel < num_texels; ++texel) {
+            const u32 offset = mip_offset + address.Compute(x, y, slice, mip_pitch, mip_height);
+            const u32 tiled_offset = offset / bytes_per_pixel * bytes_per_pixel;
+            if (tiled_offset + bytes_per_pixel <= tiled_size) {
+                func(linear_offset, tiled_offset);
+            }
+            linear_offset += bytes_per_pixel;
+            if (++x == mip_pitch) {
+                x = 0;
+                if (++y == mip_height) {
+                    y = 0;
+                    ++slice;
+                }
+            }
+        }
+    }
+}
+
+template <u32 BytesPerPixel>
+void CopyTexels(const ImageInfo& info, std::span<const u8> src, std::span<u8> dst, bool is_tiler) {
+    if (is_tiler) {
+        ForEachTexel(info, dst.size(), src.size(), [&](u32 linear_offset, u32 tiled_offset) {
+            std::memcpy(dst.data() + tiled_offset, src.data() + linear_offset, BytesPerPixel);
+        });
+    } else {
+        ForEachTexel(info, src.size(), dst.size(), [&](u32 linear_offset, u32 tiled_offset) {
+            std::memcpy(dst.data() + linear_offset, src.data() + tiled_offset, BytesPerPixel);
+        });
+    }
+}
+
+void ConvertImage(const ImageInfo& info, std::span<const u8> src, std::span<u8> dst,
+                  bool is_tiler) {
+    ASSERT_MSG(CanTileOnCpu(info), "Unsupported image layout for CPU tiling");
+    switch (info.num_bits) {
+    case 8:
+        return CopyTexels<1>(info, src, dst, is_tiler);
+    case 16:
+        return CopyTexels<2>(info, src, dst, is_tiler);
+    case 32:
+        return CopyTexels<4>(info, src, dst, is_tiler);
+    case 64:
+        return CopyTexels<8>(info, src, dst, is_tiler);
+    case 128:
+        return CopyTexels<16>(info, src, dst, is_tiler);
+    default:
+        UNREACHABLE();
+    }
+}
+
+} // Anonymous namespace
+
+bool CanTileOnCpu(const ImageInfo& info) {
+    if (!info.props.is_tiled || info.resources.levels > info.mips_layout.size()) {
+        return false;
+    }
+    switch (info.num_bits) {
+    case 8:
+    case 16:
+    case 32:
+    case 64:
+    case 128:
+        return true;
+    default:
+        return false;
+    }
+}
+
+void DetileImageCpu(const ImageInfo& info, std::span<const u8> tiled, std::span<u8> linear) {
+    ConvertImage(info, tiled, linear, false);
+}
+
+void TileImageCpu(const ImageInfo& info, std::span<const u8> linear, std::span<u8> tiled) {
+    ConvertImage(info, linear, tiled, true);
+}
+
+} // namespace VideoCore
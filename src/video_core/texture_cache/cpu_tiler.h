@@ -0,0 +1,31 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <span>
+
+#include "common/types.h"
+
+namespace VideoCore {
+
+struct ImageInfo;
+
+/**
+ * Host side implementation of the address math in host_shaders/tiling.comp.
+ * The linear representation matches the output of TileManager::DetileImage, mips are packed
+ * back to back with the pitch and height of the guest layout. It is meant for small images,
+ * where recording a compute dispatch costs more than the conversion itself, and for validating
+ * the tiling shader without a GPU.
+ */
+
+/// Returns true if the surface layout of the image can be converted on the CPU.
+[[nodiscard]] bool CanTileOnCpu(const ImageInfo& info);
+
+/// Converts the tiled guest representation of the image into its linear representation.
+void DetileImageCpu(const ImageInfo& info, std::span<const u8> tiled, std::span<u8> linear);
+
+/// Converts the linear representation of the image into its tiled guest representation.
+void TileImageCpu(const ImageInfo& info, std::span<const u8> linear, std::span<u8> tiled);
+
+} // namespace VideoCore
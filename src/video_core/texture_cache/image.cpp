@@ -15,6 +15,9 @@ namespace VideoCore {
 
 using namespace Vulkan;
 
+/// Copy regions recorded for the scheduler worker, which may replay them after the caller returns.
+using CopyList = boost::container::small_vector<vk::BufferImageCopy, 8>;
+
 static vk::ImageUsageFlags ImageUsageFlags(const Vulkan::Instance* instance,
                                            const ImageInfo& info) {
     vk::ImageUsageFlags usage = vk::ImageUsageFlagBits::eTransferSrc |
@@ -111,7 +114,6 @@ Image::Image(const Vulkan::Instance& instance_, Vulkan::Scheduler& scheduler_,
     if (info.pixel_format == vk::Format::eUndefined) {
         return;
     }
-    mip_hashes.resize(info.resources.levels);
     // Here we force `eExtendedUsage` as don't know all image usage cases beforehand. In normal case
     // the texture cache should re-create the resource with the usage requested
     vk::ImageCreateFlags flags{vk::ImageCreateFlagBits::eMutableFormat |
@@ -314,14 +316,20 @@ void Image::Transit(vk::ImageLayout dst_layout, vk::AccessFlags2 dst_mask,
         return;
     }
 
-    if (!cmdbuf) {
+    if (cmdbuf) {
         // When using external cmdbuf you are responsible for ending rp.
-        scheduler->EndRendering();
-        cmdbuf = scheduler->CommandBuffer();
+        cmdbuf.pipelineBarrier2(vk::DependencyInfo{
+            .imageMemoryBarrierCount = static_cast<u32>(barriers.size()),
+            .pImageMemoryBarriers = barriers.data(),
+        });
+        return;
     }
-    cmdbuf.pipelineBarrier2(vk::DependencyInfo{
-        .imageMemoryBarrierCount = static_cast<u32>(barriers.size()),
-        .pImageMemoryBarriers = barriers.data(),
+    scheduler->EndRendering();
+    scheduler->Record([barriers](vk::CommandBuffer cmdbuf) {
+        cmdbuf.pipelineBarrier2(vk::DependencyInfo{
+            .imageMemoryBarrierCount = static_cast<u32>(barriers.size()),
+            .pImageMemoryBarriers = barriers.data(),
+        });
     });
 }
 
@@ -351,20 +359,22 @@ void Image::Upload(std::span<const vk::BufferImageCopy> upload_copies, vk::Buffe
     const auto image_barriers =
         GetBarriers(vk::ImageLayout::eTransferDstOptimal, vk::AccessFlagBits2::eTransferWrite,
                     vk::PipelineStageFlagBits2::eCopy, {});
-    const auto cmdbuf = scheduler->CommandBuffer();
-    cmdbuf.pipelineBarrier2(vk::DependencyInfo{
-        .dependencyFlags = vk::DependencyFlagBits::eByRegion,
-        .bufferMemoryBarrierCount = 1,
-        .pBufferMemoryBarriers = &pre_barrier,
-        .imageMemoryBarrierCount = static_cast<u32>(image_barriers.size()),
-        .pImageMemoryBarriers = image_barriers.data(),
-    });
-    cmdbuf.copyBufferToImage(buffer, GetImage(), vk::ImageLayout::eTransferDstOptimal,
-                             upload_copies);
-    cmdbuf.pipelineBarrier2(vk::DependencyInfo{
-        .dependencyFlags = vk::DependencyFlagBits::eByRegion,
-        .bufferMemoryBarrierCount = 1,
-        .pBufferMemoryBarriers = &post_barrier,
+    scheduler->Record([pre_barrier, post_barrier, image_barriers, buffer, image = GetImage(),
+                       copies = CopyList(upload_copies.begin(), upload_copies.end())](
+                          vk::CommandBuffer cmdbuf) {
+        cmdbuf.pipelineBarrier2(vk::DependencyInfo{
+            .dependencyFlags = vk::DependencyFlagBits::eByRegion,
+            .bufferMemoryBarrierCount = 1,
+            .pBufferMemoryBarriers = &pre_barrier,
+            .imageMemoryBarrierCount = static_cast<u32>(image_barriers.size()),
+            .pImageMemoryBarriers = image_barriers.data(),
+        });
+        cmdbuf.copyBufferToImage(buffer, image, vk::ImageLayout::eTransferDstOptimal, copies);
+        cmdbuf.pipelineBarrier2(vk::DependencyInfo{
+            .dependencyFlags = vk::DependencyFlagBits::eByRegion,
+            .bufferMemoryBarrierCount = 1,
+            .pBufferMemoryBarriers = &post_barrier,
+        });
     });
     flags &= ~ImageFlagBits::Dirty;
 }
@@ -395,20 +405,22 @@ void Image::Download(std::span<const vk::BufferImageCopy> download_copies, vk::B
     const auto image_barriers =
         GetBarriers(vk::ImageLayout::eTransferSrcOptimal, vk::AccessFlagBits2::eTransferRead,
                     vk::PipelineStageFlagBits2::eCopy, {});
-    auto cmdbuf = scheduler->CommandBuffer();
-    cmdbuf.pipelineBarrier2(vk::DependencyInfo{
-        .dependencyFlags = vk::DependencyFlagBits::eByRegion,
-        .bufferMemoryBarrierCount = 1,
-        .pBufferMemoryBarriers = &pre_barrier,
-        .imageMemoryBarrierCount = static_cast<u32>(image_barriers.size()),
-        .pImageMemoryBarriers = image_barriers.data(),
-    });
-    cmdbuf.copyImageToBuffer(GetImage(), vk::ImageLayout::eTransferSrcOptimal, buffer,
-                             download_copies);
-    cmdbuf.pipelineBarrier2(vk::DependencyInfo{
-        .dependencyFlags = vk::DependencyFlagBits::eByRegion,
-        .bufferMemoryBarrierCount = 1,
-        .pBufferMemoryBarriers = &post_barrier,
+    scheduler->Record([pre_barrier, post_barrier, image_barriers, buffer, image = GetImage(),
+                       copies = CopyList(download_copies.begin(), download_copies.end())](
+                          vk::CommandBuffer cmdbuf) {
+        cmdbuf.pipelineBarrier2(vk::DependencyInfo{
+            .dependencyFlags = vk::DependencyFlagBits::eByRegion,
+            .bufferMemoryBarrierCount = 1,
+            .pBufferMemoryBarriers = &pre_barrier,
+            .imageMemoryBarrierCount = static_cast<u32>(image_barriers.size()),
+            .pImageMemoryBarriers = image_barriers.data(),
+        });
+        cmdbuf.copyImageToBuffer(image, vk::ImageLayout::eTransferSrcOptimal, buffer, copies);
+        cmdbuf.pipelineBarrier2(vk::DependencyInfo{
+            .dependencyFlags = vk::DependencyFlagBits::eByRegion,
+            .bufferMemoryBarrierCount = 1,
+            .pBufferMemoryBarriers = &post_barrier,
+        });
     });
 }
 
@@ -500,9 +512,11 @@ void Image::CopyImage(Image& src_image) {
     src_image.Transit(vk::ImageLayout::eTransferSrcOptimal, vk::AccessFlagBits2::eTransferRead, {});
     Transit(vk::ImageLayout::eTransferDstOptimal, vk::AccessFlagBits2::eTransferWrite, {});
 
-    auto cmdbuf = scheduler->CommandBuffer();
-    cmdbuf.copyImage(src_image.GetImage(), src_image.backing->state.layout, GetImage(),
-                     backing->state.layout, image_copies);
+    scheduler->Record([src = src_image.GetImage(), src_layout = src_image.backing->state.layout,
+                       dst = GetImage(), dst_layout = backing->state.layout,
+                       image_copies](vk::CommandBuffer cmdbuf) {
+        cmdbuf.copyImage(src, src_layout, dst, dst_layout, image_copies);
+    });
 
     Transit(vk::ImageLayout::eGeneral,
             vk::AccessFlagBits2::eShaderRead | vk::AccessFlagBits2::eTransferRead, {});
@@ -562,28 +576,31 @@ void Image::CopyImageWithBuffer(Image& src_image, vk::Buffer buffer, u64 offset)
     src_image.Transit(vk::ImageLayout::eTransferSrcOptimal, vk::AccessFlagBits2::eTransferRead, {});
     Transit(vk::ImageLayout::eTransferDstOptimal, vk::AccessFlagBits2::eTransferWrite, {});
 
-    auto cmdbuf = scheduler->CommandBuffer();
-    cmdbuf.pipelineBarrier2(vk::DependencyInfo{
-        .dependencyFlags = vk::DependencyFlagBits::eByRegion,
-        .bufferMemoryBarrierCount = 1,
-        .pBufferMemoryBarriers = &pre_copy_barrier,
-    });
+    auto dst_copies = buffer_copies;
+    for (auto& copy : dst_copies) {
+        copy.imageSubresource.aspectMask = aspect_mask & ~vk::ImageAspectFlagBits::eStencil;
+    }
 
-    cmdbuf.copyImageToBuffer(src_image.GetImage(), vk::ImageLayout::eTransferSrcOptimal, buffer,
-                             buffer_copies);
+    scheduler->Record([pre_copy_barrier, post_copy_barrier, buffer, src = src_image.GetImage(),
+                       dst = GetImage(), buffer_copies,
+                       dst_copies](vk::CommandBuffer cmdbuf) {
+        cmdbuf.pipelineBarrier2(vk::DependencyInfo{
+            .dependencyFlags = vk::DependencyFlagBits::eByRegion,
+            .bufferMemoryBarrierCount = 1,
+            .pBufferMemoryBarriers = &pre_copy_barrier,
+        });
 
-    cmdbuf.pipelineBarrier2(vk::DependencyInfo{
-        .dependencyFlags = vk::DependencyFlagBits::eByRegion,
-        .bufferMemoryBarrierCount = 1,
-        .pBufferMemoryBarriers = &post_copy_barrier,
-    });
+        cmdbuf.copyImageToBuffer(src, vk::ImageLayout::eTransferSrcOptimal, buffer,
+                                 buffer_copies);
 
-    for (auto& copy : buffer_copies) {
-        copy.imageSubresource.aspectMask = aspect_mask & ~vk::ImageAspectFlagBits::eStencil;
-    }
+        cmdbuf.pipelineBarrier2(vk::DependencyInfo{
+            .dependencyFlags = vk::DependencyFlagBits::eByRegion,
+            .bufferMemoryBarrierCount = 1,
+            .pBufferMemoryBarriers = &post_copy_barrier,
+        });
 
-    cmdbuf.copyBufferToImage(buffer, GetImage(), vk::ImageLayout::eTransferDstOptimal,
-                             buffer_copies);
+        cmdbuf.copyBufferToImage(buffer, dst, vk::ImageLayout::eTransferDstOptimal, dst_copies);
+    });
 }
 
 void Image::CopyMip(Image& src_image, u32 mip, u32 slice) {
@@ -620,9 +637,11 @@ void Image::CopyMip(Image& src_image, u32 mip, u32 slice) {
     Transit(vk::ImageLayout::eTransferDstOptimal, vk::AccessFlagBits2::eTransferWrite, {});
     src_image.Transit(vk::ImageLayout::eTransferSrcOptimal, vk::AccessFlagBits2::eTransferRead, {});
 
-    const auto cmdbuf = scheduler->CommandBuffer();
-    cmdbuf.copyImage(src_image.GetImage(), src_image.backing->state.layout, GetImage(),
-                     backing->state.layout, image_copy);
+    scheduler->Record([src = src_image.GetImage(), src_layout = src_image.backing->state.layout,
+                       dst = GetImage(), dst_layout = backing->state.layout,
+                       image_copy](vk::CommandBuffer cmdbuf) {
+        cmdbuf.copyImage(src, src_layout, dst, dst_layout, image_copy);
+    });
 }
 
 void Image::Resolve(Image& src_image, const VideoCore::SubresourceRange& mrt0_range,
@@ -653,9 +672,11 @@ void Image::Resolve(Image& src_image, const VideoCore::SubresourceRange& mrt0_ra
             .dstOffset = {0, 0, 0},
             .extent = {info.size.width, info.size.height, 1},
         };
-        scheduler->CommandBuffer().copyImage(src_image.GetImage(),
-                                             vk::ImageLayout::eTransferSrcOptimal, GetImage(),
-                                             vk::ImageLayout::eTransferDstOptimal, region);
+        scheduler->Record([src = src_image.GetImage(), dst = GetImage(),
+                           region](vk::CommandBuffer cmdbuf) {
+            cmdbuf.copyImage(src, vk::ImageLayout::eTransferSrcOptimal, dst,
+                             vk::ImageLayout::eTransferDstOptimal, region);
+        });
     } else {
         const vk::ImageResolve region = {
             .srcSubresource{
@@ -674,9 +695,11 @@ void Image::Resolve(Image& src_image, const VideoCore::SubresourceRange& mrt0_ra
             .dstOffset = {0, 0, 0},
             .extent = {info.size.width, info.size.height, 1},
         };
-        scheduler->CommandBuffer().resolveImage(src_image.GetImage(),
-                                                vk::ImageLayout::eTransferSrcOptimal, GetImage(),
-                                                vk::ImageLayout::eTransferDstOptimal, region);
+        scheduler->Record([src = src_image.GetImage(), dst = GetImage(),
+                           region](vk::CommandBuffer cmdbuf) {
+            cmdbuf.resolveImage(src, vk::ImageLayout::eTransferSrcOptimal, dst,
+                                vk::ImageLayout::eTransferDstOptimal, region);
+        });
     }
 
     flags |= VideoCore::ImageFlagBits::GpuModified;
@@ -693,9 +716,10 @@ void Image::Clear(const vk::ClearValue& clear_value, const VideoCore::Subresourc
     };
     scheduler->EndRendering();
     Transit(vk::ImageLayout::eTransferDstOptimal, vk::AccessFlagBits2::eTransferWrite, {});
-    const auto cmdbuf = scheduler->CommandBuffer();
-    cmdbuf.clearColorImage(GetImage(), vk::ImageLayout::eTransferDstOptimal, clear_value.color,
-                           vk_range);
+    scheduler->Record([image = GetImage(), color = clear_value.color,
+                       vk_range](vk::CommandBuffer cmdbuf) {
+        cmdbuf.clearColorImage(image, vk::ImageLayout::eTransferDstOptimal, color, vk_range);
+    });
 }
 
 void Image::SetBackingSamples(u32 num_samples, bool copy_backing) {
@@ -755,10 +779,11 @@ void Image::SetBackingSamples(u32 num_samples, bool copy_backing) {
                 .layerCount = info.resources.layers,
             },
         });
-        const auto cmdbuf = scheduler->CommandBuffer();
-        cmdbuf.pipelineBarrier2(vk::DependencyInfo{
-            .imageMemoryBarrierCount = static_cast<u32>(barriers.size()),
-            .pImageMemoryBarriers = barriers.data(),
+        scheduler->Record([barriers](vk::CommandBuffer cmdbuf) {
+            cmdbuf.pipelineBarrier2(vk::DependencyInfo{
+                .imageMemoryBarrierCount = static_cast<u32>(barriers.size()),
+                .pImageMemoryBarriers = barriers.data(),
+            });
         });
 
         // Copy between ms and non ms backing images
@@ -11,8 +11,8 @@
 
 #include <deque>
 #include <optional>
+#include <vector>
 #include <boost/container/small_vector.hpp>
-#include <boost/container/static_vector.hpp>
 
 namespace Vulkan {
 class Instance;
@@ -166,7 +166,7 @@ public:
     };
     std::deque<BackingImage> backing_images;
     BackingImage* backing{};
-    boost::container::static_vector<u64, 16> mip_hashes{};
+    std::vector<u64> range_hashes;
     u64 lru_id{};
     u64 tick_accessed_last{};
     u64 hash{};
@@ -3,6 +3,7 @@
 
 #include <xxhash.h>
 
+#include "common/alignment.h"
 #include "common/assert.h"
 #include "common/config.h"
 #include "common/debug.h"
@@ -12,6 +13,7 @@
 #include "video_core/page_manager.h"
 #include "video_core/renderer_vulkan/vk_instance.h"
 #include "video_core/renderer_vulkan/vk_scheduler.h"
+#include "video_core/texture_cache/cpu_tiler.h"
 #include "video_core/texture_cache/host_compatibility.h"
 #include "video_core/texture_cache/texture_cache.h"
 #include "video_core/texture_cache/tile_manager.h"
@@ -20,6 +22,8 @@ namespace VideoCore {
 
 static constexpr u64 PageShift = 12;
 static constexpr u64 NumFramesBeforeRemoval = 32;
+static constexpr u32 MaxCpuDetileSize = 16_KB;
+static constexpr u32 UploadRangeSize = 64_KB;
 
 TextureCache::TextureCache(const Vulkan::Instance& instance_, Vulkan::Scheduler& scheduler_,
                            AmdGpu::Liverpool* liverpool_, BufferCache& buffer_cache_,
@@ -95,35 +99,72 @@ void TextureCache::DownloadImageMemory(ImageId image_id) {
     if (False(image.flags & ImageFlagBits::GpuModified)) {
         return;
     }
-    auto& download_buffer = buffer_cache.GetUtilityBuffer(MemoryUsage::Download);
-    const u32 download_size = image.info.pitch * image.info.size.height *
-                              image.info.resources.layers * (image.info.num_bits / 8);
-    ASSERT(download_size <= image.info.guest_size);
-    const auto [download, offset] = download_buffer.Map(download_size);
-    download_buffer.Commit();
-    const vk::BufferImageCopy image_download = {
-        .bufferOffset = offset,
-        .bufferRowLength = image.info.pitch,
-        .bufferImageHeight = image.info.size.height,
-        .imageSubresource =
-            {
-                .aspectMask = image.info.props.is_depth ? vk::ImageAspectFlagBits::eDepth
-                                                        : vk::ImageAspectFlagBits::eColor,
-                .mipLevel = 0,
+    const auto& info = image.info;
+    boost::container::small_vector<vk::BufferImageCopy, 14> buffer_copies;
+    u32 copy_size = 0;
+    for (u32 mip = 0; mip < info.resources.levels; ++mip) {
+        const auto& mip_info = info.mips_layout[mip];
+        buffer_copies.push_back(vk::BufferImageCopy{
+            .bufferOffset = mip_info.offset,
+            .bufferRowLength = mip_info.pitch,
+            .bufferImageHeight = mip_info.height,
+            .imageSubresource{
+                .aspectMask = image.aspect_mask & ~vk::ImageAspectFlagBits::eStencil,
+                .mipLevel = mip,
                 .baseArrayLayer = 0,
-                .layerCount = image.info.resources.layers,
+                .layerCount = info.resources.layers,
             },
-        .imageOffset = {0, 0, 0},
-        .imageExtent = {image.info.size.width, image.info.size.height, 1},
+            .imageOffset = {0, 0, 0},
+            .imageExtent = {std::max(info.size.width >> mip, 1u),
+                            std::max(info.size.height >> mip, 1u),
+                            std::max(info.size.depth >> mip, 1u)},
+        });
+        copy_size += mip_info.size;
+    }
+    // The tiler writes the whole guest surface, linear copies only the mip chain.
+    const u32 download_size = info.props.is_tiled ? info.guest_size : copy_size;
+    ASSERT(download_size <= info.guest_size);
+
+    // Large surfaces would wrap the download stream buffer, read them back through a
+    // temporary host buffer instead.
+    auto& download_buffer = buffer_cache.GetUtilityBuffer(MemoryUsage::Download);
+    std::unique_ptr<Buffer> temp_buffer;
+    vk::Buffer out_buffer = download_buffer.Handle();
+    auto [download, offset] = download_buffer.Map(download_size, instance.StorageMinAlignment());
+    if (download) {
+        download_buffer.Commit();
+    } else {
+        temp_buffer = std::make_unique<Buffer>(instance, scheduler, MemoryUsage::Download, 0,
+                                               vk::BufferUsageFlagBits::eTransferDst |
+                                                   vk::BufferUsageFlagBits::eStorageBuffer,
+                                               download_size);
+        out_buffer = temp_buffer->Handle();
+        download = temp_buffer->mapped_data.data();
+        offset = 0;
+    }
+
+    tile_manager.TileImage(image, buffer_copies, out_buffer, offset, copy_size);
+
+    const vk::BufferMemoryBarrier2 host_barrier = {
+        .srcStageMask = vk::PipelineStageFlagBits2::eAllCommands,
+        .srcAccessMask = vk::AccessFlagBits2::eMemoryWrite,
+        .dstStageMask = vk::PipelineStageFlagBits2::eHost,
+        .dstAccessMask = vk::AccessFlagBits2::eHostRead,
+        .buffer = out_buffer,
+        .offset = offset,
+        .size = download_size,
     };
-    scheduler.EndRendering();
-    const auto cmdbuf = scheduler.CommandBuffer();
-    image.Transit(vk::ImageLayout::eTransferSrcOptimal, vk::AccessFlagBits2::eTransferRead, {});
-    cmdbuf.copyImageToBuffer(image.GetImage(), vk::ImageLayout::eTransferSrcOptimal,
-                             download_buffer.Handle(), image_download);
+    scheduler.Record([host_barrier](vk::CommandBuffer cmdbuf) {
+        cmdbuf.pipelineBarrier2(vk::DependencyInfo{
+            .dependencyFlags = vk::DependencyFlagBits::eByRegion,
+            .bufferMemoryBarrierCount = 1,
+            .pBufferMemoryBarriers = &host_barrier,
+        });
+    });
 
     scheduler.DeferPriorityOperation(
-        [this, device_addr = image.info.guest_address, download, download_size] {
+        [device_addr = info.guest_address, download, download_size,
+         temp_buffer = std::move(temp_buffer)] {
             Core::Memory::Instance()->TryWriteBacking(std::bit_cast<u8*>(device_addr), download,
                                                       download_size);
         });
@@ -637,42 +678,116 @@ void TextureCache::RefreshImage(Image& image) {
 
     const u32 num_layers = image.info.resources.layers;
     const u32 num_mips = image.info.resources.levels;
-    const bool is_gpu_modified = True(image.flags & ImageFlagBits::GpuModified);
     const bool is_gpu_dirty = True(image.flags & ImageFlagBits::GpuDirty);
+    const u8* guest_addr = std::bit_cast<const u8*>(image.info.guest_address);
+
+    // Each mip is split into ranges of guest memory that are compared and uploaded separately,
+    // so a CPU write only re-uploads the layers and rows it touched. Layers of thin images are
+    // contiguous, and so are block rows of linear images and micro tile rows of 1D tiled ones.
+    // Macro tiled layers, thick layouts and volumes are treated as one range per mip.
+    const auto array_mode = image.info.array_mode;
+    const bool split_layers =
+        !image.info.props.is_volume && AmdGpu::GetMicroTileThickness(array_mode) == 1;
+    const u32 row_granularity = array_mode == AmdGpu::ArrayMode::ArrayLinearAligned ? 1
+                                : array_mode == AmdGpu::ArrayMode::Array1DTiledThin1 ? 8
+                                                                                    : 0;
+    const u32 block_shift = image.info.props.is_block ? 2 : 0;
+
+    // When the GPU wrote to the image memory the buffer cache holds the newest data and guest
+    // memory can't be compared against, upload everything and drop the stored hashes.
+    auto& range_hashes = image.range_hashes;
+    if (is_gpu_dirty) {
+        std::ranges::fill(range_hashes, 0);
+    }
 
+    u32 range_index = 0;
     boost::container::small_vector<vk::BufferImageCopy, 14> image_copies;
+    boost::container::small_vector<TileManager::LinearRange, 14> dirty_ranges;
     for (u32 m = 0; m < num_mips; m++) {
         const u32 width = std::max(image.info.size.width >> m, 1u);
         const u32 height = std::max(image.info.size.height >> m, 1u);
         const u32 depth =
             image.info.props.is_volume ? std::max(image.info.size.depth >> m, 1u) : 1u;
         const auto [mip_size, mip_pitch, mip_height, mip_offset] = image.info.mips_layout[m];
+        const u32 extent_width = mip_pitch ? std::min(mip_pitch, width) : width;
+        const u32 extent_height = mip_height ? std::min(mip_height, height) : height;
 
-        // Protect GPU modified resources from accidental CPU reuploads.
-        if (is_gpu_modified && !is_gpu_dirty) {
-            const u8* addr = std::bit_cast<u8*>(image.info.guest_address);
-            const u64 hash = XXH3_64bits(addr + mip_offset, mip_size);
-            if (image.mip_hashes[m] == hash) {
-                continue;
+        const u32 num_slices = split_layers ? num_layers : 1;
+        const u32 slice_size = mip_size / num_slices;
+        u32 num_rows = 1;
+        if (split_layers && row_granularity != 0) {
+            num_rows = std::max(((mip_height ? mip_height : height) + (1u << block_shift) - 1) >>
+                                    block_shift,
+                                1u);
+            if (slice_size % num_rows != 0) {
+                num_rows = 1;
             }
-            image.mip_hashes[m] = hash;
         }
+        const u32 row_size = slice_size / num_rows;
+        const u32 rows_per_range =
+            num_rows == 1 ? 1
+                          : std::max(Common::AlignDown(UploadRangeSize / row_size, row_granularity),
+                                     row_granularity);
+
+        for (u32 slice = 0; slice < num_slices; slice++) {
+            for (u32 row = 0; row < num_rows; row += rows_per_range) {
+                const u32 row_end = std::min(row + rows_per_range, num_rows);
+                const u32 range_offset = mip_offset + slice * slice_size + row * row_size;
+                if (range_index == range_hashes.size()) {
+                    range_hashes.push_back(0);
+                }
+                u64& range_hash = range_hashes[range_index++];
+                const u32 first_y = num_rows == 1 ? 0 : row << block_shift;
+                if (first_y >= extent_height) {
+                    // Padding rows past the end of the image.
+                    continue;
+                }
+                if (!is_gpu_dirty) {
+                    const u64 hash =
+                        XXH3_64bits(guest_addr + range_offset, (row_end - row) * row_size);
+                    if (range_hash == hash) {
+                        continue;
+                    }
+                    range_hash = hash;
+                }
 
-        const u32 extent_width = mip_pitch ? std::min(mip_pitch, width) : width;
-        const u32 extent_height = mip_height ? std::min(mip_height, height) : height;
-        image_copies.push_back({
-            .bufferOffset = mip_offset,
-            .bufferRowLength = mip_pitch,
-            .bufferImageHeight = mip_height,
-            .imageSubresource{
-                .aspectMask = image.aspect_mask & ~vk::ImageAspectFlagBits::eStencil,
-                .mipLevel = m,
-                .baseArrayLayer = 0,
-                .layerCount = num_layers,
-            },
-            .imageOffset = {0, 0, 0},
-            .imageExtent = {extent_width, extent_height, depth},
-        });
+                // Guest ranges have the same offsets in the linear representation.
+                const u32 range_size = (row_end - row) * row_size;
+                if (!dirty_ranges.empty() &&
+                    dirty_ranges.back().first + dirty_ranges.back().second == range_offset) {
+                    dirty_ranges.back().second += range_size;
+                } else {
+                    dirty_ranges.emplace_back(range_offset, range_size);
+                }
+
+                const u32 last_y =
+                    num_rows == 1 ? extent_height : std::min(row_end << block_shift, extent_height);
+                const u32 base_layer = split_layers ? slice : 0;
+                if (!image_copies.empty()) {
+                    // Merge with the previous range if it ends right before this one.
+                    auto& prev = image_copies.back();
+                    if (prev.imageSubresource.mipLevel == m &&
+                        prev.imageSubresource.baseArrayLayer == base_layer &&
+                        u32(prev.imageOffset.y) + prev.imageExtent.height == first_y) {
+                        prev.imageExtent.height += last_y - first_y;
+                        continue;
+                    }
+                }
+                image_copies.push_back({
+                    .bufferOffset = range_offset,
+                    .bufferRowLength = mip_pitch,
+                    .bufferImageHeight = mip_height,
+                    .imageSubresource{
+                        .aspectMask = image.aspect_mask & ~vk::ImageAspectFlagBits::eStencil,
+                        .mipLevel = m,
+                        .baseArrayLayer = base_layer,
+                        .layerCount = split_layers ? 1 : num_layers,
+                    },
+                    .imageOffset = {0, static_cast<s32>(first_y), 0},
+                    .imageExtent = {extent_width, last_y - first_y, depth},
+                });
+            }
+        }
     }
 
     if (image_copies.empty()) {
@@ -682,19 +797,42 @@ void TextureCache::RefreshImage(Image& image) {
 
     scheduler.EndRendering();
 
+    // Small tiled images are detiled on the host, which is cheaper than a compute dispatch.
+    // This requires guest memory to hold the latest contents of the image.
+    const u32 guest_size = image.info.guest_size;
+    if (image.info.props.is_tiled && guest_size <= MaxCpuDetileSize &&
+        CanTileOnCpu(image.info) &&
+        !buffer_cache.IsRegionGpuModified(image.info.guest_address, guest_size)) {
+        auto& staging_buffer = buffer_cache.GetUtilityBuffer(MemoryUsage::Upload);
+        const auto [data, offset] = staging_buffer.Map(guest_size, 16);
+        DetileImageCpu(image.info, {std::bit_cast<const u8*>(image.info.guest_address), guest_size},
+                       {data, guest_size});
+        if (Config::validateCpuDetiler()) {
+            ValidateCpuDetile(image, {data, guest_size});
+        }
+        staging_buffer.Commit();
+        for (auto& copy : image_copies) {
+            copy.bufferOffset += offset;
+        }
+        image.Upload(image_copies, staging_buffer.Handle(), offset);
+        return;
+    }
+
     const auto [in_buffer, in_offset] =
         buffer_cache.ObtainBufferForImage(image.info.guest_address, image.info.guest_size);
     if (auto barrier = in_buffer->GetBarrier(vk::AccessFlagBits2::eTransferRead,
                                              vk::PipelineStageFlagBits2::eTransfer)) {
-        scheduler.CommandBuffer().pipelineBarrier2(vk::DependencyInfo{
-            .dependencyFlags = vk::DependencyFlagBits::eByRegion,
-            .bufferMemoryBarrierCount = 1,
-            .pBufferMemoryBarriers = &barrier.value(),
+        scheduler.Record([barrier = *barrier](vk::CommandBuffer cmdbuf) {
+            cmdbuf.pipelineBarrier2(vk::DependencyInfo{
+                .dependencyFlags = vk::DependencyFlagBits::eByRegion,
+                .bufferMemoryBarrierCount = 1,
+                .pBufferMemoryBarriers = &barrier,
+            });
         });
     }
 
     const auto [buffer, offset] =
-        tile_manager.DetileImage(in_buffer->Handle(), in_offset, image.info);
+        tile_manager.DetileImage(in_buffer->Handle(), in_offset, image.info, dirty_ranges);
     for (auto& copy : image_copies) {
         copy.bufferOffset += offset;
     }
@@ -702,6 +840,75 @@ void TextureCache::RefreshImage(Image& image) {
     image.Upload(image_copies, buffer, offset);
 }
 
+void TextureCache::ValidateCpuDetile(const Image& image, std::span<const u8> cpu_linear) {
+    const auto& info = image.info;
+    // The detiler dispatch only covers whole groups of 64 texels.
+    const u32 bytes_per_texel = info.num_bits / 8;
+    const size_t checked_size =
+        Common::AlignDown(info.guest_size / bytes_per_texel, 64u) * bytes_per_texel;
+    const std::vector<u8> expected(cpu_linear.begin(), cpu_linear.begin() + checked_size);
+
+    const auto [in_buffer, in_offset] =
+        buffer_cache.ObtainBufferForImage(info.guest_address, info.guest_size);
+    if (auto barrier = in_buffer->GetBarrier(vk::AccessFlagBits2::eShaderRead,
+                                             vk::PipelineStageFlagBits2::eComputeShader)) {
+        scheduler.CommandBuffer().pipelineBarrier2(vk::DependencyInfo{
+            .dependencyFlags = vk::DependencyFlagBits::eByRegion,
+            .bufferMemoryBarrierCount = 1,
+            .pBufferMemoryBarriers = &barrier.value(),
+        });
+    }
+    const auto [gpu_linear, gpu_offset] =
+        tile_manager.DetileImage(in_buffer->Handle(), in_offset, info);
+
+    Buffer readback{instance, scheduler, MemoryUsage::Download, 0,
+                    vk::BufferUsageFlagBits::eTransferDst, info.guest_size};
+    const auto cmdbuf = scheduler.CommandBuffer();
+    const vk::MemoryBarrier2 pre_barrier = {
+        .srcStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+        .srcAccessMask = vk::AccessFlagBits2::eShaderWrite,
+        .dstStageMask = vk::PipelineStageFlagBits2::eTransfer,
+        .dstAccessMask = vk::AccessFlagBits2::eTransferRead,
+    };
+    cmdbuf.pipelineBarrier2(vk::DependencyInfo{
+        .memoryBarrierCount = 1,
+        .pMemoryBarriers = &pre_barrier,
+    });
+    cmdbuf.copyBuffer(gpu_linear, readback.Handle(),
+                      vk::BufferCopy{
+                          .srcOffset = gpu_offset,
+                          .dstOffset = 0,
+                          .size = info.guest_size,
+                      });
+    const vk::MemoryBarrier2 host_barrier = {
+        .srcStageMask = vk::PipelineStageFlagBits2::eTransfer,
+        .srcAccessMask = vk::AccessFlagBits2::eTransferWrite,
+        .dstStageMask = vk::PipelineStageFlagBits2::eHost,
+        .dstAccessMask = vk::AccessFlagBits2::eHostRead,
+    };
+    cmdbuf.pipelineBarrier2(vk::DependencyInfo{
+        .memoryBarrierCount = 1,
+        .pMemoryBarriers = &host_barrier,
+    });
+    scheduler.Finish();
+
+    const auto actual = readback.mapped_data.first(checked_size);
+    const auto cpu_it = std::ranges::mismatch(expected, actual).in1;
+    if (cpu_it == expected.end()) {
+        return;
+    }
+    size_t num_bytes = 0;
+    for (size_t i = 0; i < expected.size(); ++i) {
+        num_bytes += expected[i] != actual[i];
+    }
+    LOG_ERROR(Render,
+              "CPU detiler mismatch for image {:#x} ({}x{}, {}, {} bits): {} of {} bytes differ, "
+              "first at {:#x}",
+              info.guest_address, info.size.width, info.size.height,
+              AmdGpu::NameOf(info.tile_mode), info.num_bits, num_bytes, expected.size(),
+              std::distance(expected.begin(), cpu_it));
+}
+
 vk::Sampler TextureCache::GetSampler(const AmdGpu::Sampler& sampler,
                                      AmdGpu::BorderColorBuffer border_color_base) {
     const u64 hash = XXH3_64bits(&sampler, sizeof(sampler));
@@ -881,11 +1088,6 @@ void TextureCache::RunGarbageCollector() {
         --num_deletions;
         auto& image = slot_images[image_id];
         const bool download = image.SafeToDownload();
-        const bool tiled = image.info.IsTiled();
-        if (tiled && download) {
-            // This is a workaround for now. We can't handle non-linear image downloads.
-            return false;
-        }
         if (download && !pressured) {
             return false;
         }
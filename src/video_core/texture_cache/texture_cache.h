@@ -257,6 +257,9 @@ private:
     /// Copies image memory back to CPU.
     void DownloadImageMemory(ImageId image_id);
 
+    /// Detiles the image on the GPU and reports where the CPU detiler output differs from it.
+    void ValidateCpuDetile(const Image& image, std::span<const u8> cpu_linear);
+
     /// Thread function for copying downloaded images out to CPU memory.
     void DownloadedImagesThread(const std::stop_token& token);
 
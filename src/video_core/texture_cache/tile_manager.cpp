@@ -1,6 +1,7 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include "common/div_ceil.h"
 #include "video_core/buffer_cache/buffer.h"
 #include "video_core/renderer_vulkan/vk_instance.h"
 #include "video_core/renderer_vulkan/vk_scheduler.h"
@@ -12,6 +13,7 @@
 
 #include "video_core/host_shaders/tiling_comp.h"
 
+#include <boost/container/small_vector.hpp>
 #include <magic_enum/magic_enum.hpp>
 #include <vk_mem_alloc.h>
 
@@ -24,6 +26,40 @@ struct TilingInfo {
     std::array<ImageInfo::MipInfo, 16> mips;
 };
 
+/// Binds the tiled, linear and parameter buffers of a tiling dispatch.
+static void PushTilingDescriptors(vk::CommandBuffer cmdbuf, vk::PipelineLayout pl_layout,
+                                  const vk::DescriptorBufferInfo& tiled_buffer_info,
+                                  const vk::DescriptorBufferInfo& linear_buffer_info,
+                                  const vk::DescriptorBufferInfo& params_buffer_info) {
+    const std::array<vk::WriteDescriptorSet, 3> set_writes = {{
+        {
+            .dstSet = VK_NULL_HANDLE,
+            .dstBinding = 0,
+            .dstArrayElement = 0,
+            .descriptorCount = 1,
+            .descriptorType = vk::DescriptorType::eStorageBuffer,
+            .pBufferInfo = &tiled_buffer_info,
+        },
+        {
+            .dstSet = VK_NULL_HANDLE,
+            .dstBinding = 1,
+            .dstArrayElement = 0,
+            .descriptorCount = 1,
+            .descriptorType = vk::DescriptorType::eStorageBuffer,
+            .pBufferInfo = &linear_buffer_info,
+        },
+        {
+            .dstSet = VK_NULL_HANDLE,
+            .dstBinding = 2,
+            .dstArrayElement = 0,
+            .descriptorCount = 1,
+            .descriptorType = vk::DescriptorType::eUniformBuffer,
+            .pBufferInfo = &params_buffer_info,
+        },
+    }};
+    cmdbuf.pushDescriptorSetKHR(vk::PipelineBindPoint::eCompute, pl_layout, 0, set_writes);
+}
+
 TileManager::TileManager(const Vulkan::Instance& instance, Vulkan::Scheduler& scheduler,
                          StreamBuffer& stream_buffer_)
     : instance{instance}, scheduler{scheduler}, stream_buffer{stream_buffer_} {
@@ -149,6 +185,7 @@ vk::Pipeline TileManager::GetTilingPipeline(const ImageInfo& info, bool is_tiler
         .pName = "main",
     };
     const vk::ComputePipelineCreateInfo compute_pipeline_ci = {
+        .flags = vk::PipelineCreateFlagBits::eDispatchBase,
         .stage = shader_ci,
         .layout = *pl_layout,
     };
@@ -162,7 +199,8 @@ vk::Pipeline TileManager::GetTilingPipeline(const ImageInfo& info, bool is_tiler
 }
 
 TileManager::Result TileManager::DetileImage(vk::Buffer in_buffer, u32 in_offset,
-                                             const ImageInfo& info) {
+                                             const ImageInfo& info,
+                                             std::span<const LinearRange> ranges) {
     if (!info.props.is_tiled) {
         return {in_buffer, in_offset};
     }
@@ -193,9 +231,6 @@ TileManager::Result TileManager::DetileImage(vk::Buffer in_buffer, u32 in_offset
 
     scheduler.EndRendering();
 
-    const auto cmdbuf = scheduler.CommandBuffer();
-    cmdbuf.bindPipeline(vk::PipelineBindPoint::eCompute, GetTilingPipeline(info, false));
-
     const vk::DescriptorBufferInfo tiled_buffer_info{
         .buffer = in_buffer,
         .offset = in_offset,
@@ -208,36 +243,32 @@ TileManager::Result TileManager::DetileImage(vk::Buffer in_buffer, u32 in_offset
         .range = info.guest_size,
     };
 
-    const std::array<vk::WriteDescriptorSet, 3> set_writes = {{
-        {
-            .dstSet = VK_NULL_HANDLE,
-            .dstBinding = 0,
-            .dstArrayElement = 0,
-            .descriptorCount = 1,
-            .descriptorType = vk::DescriptorType::eStorageBuffer,
-            .pBufferInfo = &tiled_buffer_info,
-        },
-        {
-            .dstSet = VK_NULL_HANDLE,
-            .dstBinding = 1,
-            .dstArrayElement = 0,
-            .descriptorCount = 1,
-            .descriptorType = vk::DescriptorType::eStorageBuffer,
-            .pBufferInfo = &linear_buffer_info,
-        },
-        {
-            .dstSet = VK_NULL_HANDLE,
-            .dstBinding = 2,
-            .dstArrayElement = 0,
-            .descriptorCount = 1,
-            .descriptorType = vk::DescriptorType::eUniformBuffer,
-            .pBufferInfo = &params_buffer_info,
-        },
-    }};
-    cmdbuf.pushDescriptorSetKHR(vk::PipelineBindPoint::eCompute, *pl_layout, 0, set_writes);
+    // Every invocation writes one texel of the linear representation, so a range maps to a
+    // span of workgroups.
+    const u32 dim_x = (info.guest_size / (info.num_bits / 8)) / 64;
+    const u32 group_size = (info.num_bits / 8) * 64;
+    boost::container::small_vector<std::pair<u32, u32>, 8> group_ranges;
+    if (ranges.empty()) {
+        group_ranges.emplace_back(0, dim_x);
+    }
+    for (const auto& [offset, size] : ranges) {
+        const u32 first_group = offset / group_size;
+        const u32 end_group = std::min(Common::DivCeil(offset + size, group_size), dim_x);
+        if (end_group > first_group) {
+            group_ranges.emplace_back(first_group, end_group - first_group);
+        }
+    }
 
-    const auto dim_x = (info.guest_size / (info.num_bits / 8)) / 64;
-    cmdbuf.dispatch(dim_x, 1, 1);
+    scheduler.Record([pipeline = GetTilingPipeline(info, false), pl_layout = *pl_layout,
+                      tiled_buffer_info, linear_buffer_info, params_buffer_info,
+                      group_ranges](vk::CommandBuffer cmdbuf) {
+        cmdbuf.bindPipeline(vk::PipelineBindPoint::eCompute, pipeline);
+        PushTilingDescriptors(cmdbuf, pl_layout, tiled_buffer_info, linear_buffer_info,
+                              params_buffer_info);
+        for (const auto& [first_group, num_groups] : group_ranges) {
+            cmdbuf.dispatchBase(first_group, 0, 0, num_groups, 1, 1);
+        }
+    });
     return {out_buffer, 0};
 }
 
@@ -276,11 +307,8 @@ void TileManager::TileImage(Image& in_image, std::span<vk::BufferImageCopy> buff
         vmaDestroyBuffer(instance.GetAllocator(), temp_buffer, temp_allocation);
     });
 
-    const auto cmdbuf = scheduler.CommandBuffer();
     in_image.Download(buffer_copies, temp_buffer, 0, copy_size);
 
-    cmdbuf.bindPipeline(vk::PipelineBindPoint::eCompute, GetTilingPipeline(info, true));
-
     const vk::DescriptorBufferInfo tiled_buffer_info{
         .buffer = out_buffer,
         .offset = out_offset,
@@ -293,36 +321,15 @@ void TileManager::TileImage(Image& in_image, std::span<vk::BufferImageCopy> buff
         .range = info.guest_size,
     };
 
-    const std::array<vk::WriteDescriptorSet, 3> set_writes = {{
-        {
-            .dstSet = VK_NULL_HANDLE,
-            .dstBinding = 0,
-            .dstArrayElement = 0,
-            .descriptorCount = 1,
-            .descriptorType = vk::DescriptorType::eStorageBuffer,
-            .pBufferInfo = &tiled_buffer_info,
-        },
-        {
-            .dstSet = VK_NULL_HANDLE,
-            .dstBinding = 1,
-            .dstArrayElement = 0,
-            .descriptorCount = 1,
-            .descriptorType = vk::DescriptorType::eStorageBuffer,
-            .pBufferInfo = &linear_buffer_info,
-        },
-        {
-            .dstSet = VK_NULL_HANDLE,
-            .dstBinding = 2,
-            .dstArrayElement = 0,
-            .descriptorCount = 1,
-            .descriptorType = vk::DescriptorType::eUniformBuffer,
-            .pBufferInfo = &params_buffer_info,
-        },
-    }};
-    cmdbuf.pushDescriptorSetKHR(vk::PipelineBindPoint::eCompute, *pl_layout, 0, set_writes);
-
-    const auto dim_x = (info.guest_size / (info.num_bits / 8)) / 64;
-    cmdbuf.dispatch(dim_x, 1, 1);
+    const u32 dim_x = (info.guest_size / (info.num_bits / 8)) / 64;
+    scheduler.Record([pipeline = GetTilingPipeline(info, true), pl_layout = *pl_layout,
+                      tiled_buffer_info, linear_buffer_info, params_buffer_info,
+                      dim_x](vk::CommandBuffer cmdbuf) {
+        cmdbuf.bindPipeline(vk::PipelineBindPoint::eCompute, pipeline);
+        PushTilingDescriptors(cmdbuf, pl_layout, tiled_buffer_info, linear_buffer_info,
+                              params_buffer_info);
+        cmdbuf.dispatch(dim_x, 1, 1);
+    });
 }
 
 } // namespace VideoCore
@@ -19,6 +19,8 @@ class TileManager {
 public:
     using ScratchBuffer = std::pair<vk::Buffer, VmaAllocation>;
     using Result = std::pair<vk::Buffer, u32>;
+    /// Offset and size in bytes of a part of the linear representation of an image.
+    using LinearRange = std::pair<u32, u32>;
 
     explicit TileManager(const Vulkan::Instance& instance, Vulkan::Scheduler& scheduler,
                          StreamBuffer& stream_buffer);
@@ -27,7 +29,10 @@ public:
     void TileImage(Image& in_image, std::span<vk::BufferImageCopy> buffer_copies,
                    vk::Buffer out_buffer, u32 out_offset, u32 copy_size);
 
-    Result DetileImage(vk::Buffer in_buffer, u32 in_offset, const ImageInfo& info);
+    /// Detiles the image into a scratch buffer. When ranges are given, only those parts of the
+    /// linear representation are written.
+    Result DetileImage(vk::Buffer in_buffer, u32 in_offset, const ImageInfo& info,
+                       std::span<const LinearRange> ranges = {});
 
 private:
     vk::Pipeline GetTilingPipeline(const ImageInfo& info, bool is_tiler);